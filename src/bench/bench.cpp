@@ -0,0 +1,283 @@
+/***************************************************************************
+
+    bench/bench.cpp
+
+    Throughput benchmarks for XML parsing and the info DB
+
+***************************************************************************/
+
+#include <QBuffer>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "bench/xmlgenerator.h"
+#include "info.h"
+#include "info_builder.h"
+#include "xmlparser.h"
+
+
+//**************************************************************************
+//  LOCAL TYPES
+//**************************************************************************
+
+namespace
+{
+	// ======================> bench_options
+	struct bench_options
+	{
+		bench::listxml_options		m_listxml;
+		bench::softlist_options		m_softlist;
+		int							m_iterations = 3;
+	};
+};
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  peak_rss_kib - peak resident set size of this
+//	process, in KiB
+//-------------------------------------------------
+
+static unsigned long long peak_rss_kib()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0;
+	return counters.PeakWorkingSetSize / 1024;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	// macOS reports bytes, everybody else KiB
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+#endif
+}
+
+
+//-------------------------------------------------
+//  run_benchmark - runs a benchmark and prints a
+//	CSV row with its results
+//-------------------------------------------------
+
+static bool run_benchmark(const char *name, int iterations, size_t bytes, size_t items, const std::function<bool()> &func)
+{
+	double total_seconds = 0.0;
+	double best_seconds = std::numeric_limits<double>::max();
+	for (int i = 0; i < iterations; i++)
+	{
+		auto start_time = std::chrono::steady_clock::now();
+		bool success = func();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+
+		if (!success)
+		{
+			fprintf(stderr, "%s: benchmark failed\n", name);
+			return false;
+		}
+		total_seconds += elapsed.count();
+		best_seconds = std::min(best_seconds, elapsed.count());
+	}
+
+	printf("%s,%d,%zu,%zu,%.6f,%.6f,%.2f,%.0f,%llu\n",
+		name,
+		iterations,
+		bytes,
+		items,
+		total_seconds / iterations,
+		best_seconds,
+		bytes / best_seconds / (1024.0 * 1024.0),
+		items / best_seconds,
+		peak_rss_kib());
+	fflush(stdout);
+	return true;
+}
+
+
+//-------------------------------------------------
+//  raw_byte_array - wraps bytes in a QByteArray
+//	without copying them
+//-------------------------------------------------
+
+static QByteArray raw_byte_array(const char *data, size_t size)
+{
+	return QByteArray::fromRawData(data, (int)size);
+}
+
+
+//-------------------------------------------------
+//  parse_arguments
+//-------------------------------------------------
+
+static bool parse_arguments(int argc, char *argv[], bench_options &options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const char *arg = argv[i];
+		const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+		int *int_target = nullptr;
+
+		if (!strcmp(arg, "--machines"))
+			int_target = &options.m_listxml.m_machine_count;
+		else if (!strcmp(arg, "--dipvalues"))
+			int_target = &options.m_listxml.m_dipvalues_per_machine;
+		else if (!strcmp(arg, "--software"))
+			int_target = &options.m_softlist.m_software_count;
+		else if (!strcmp(arg, "--iterations"))
+			int_target = &options.m_iterations;
+		else if (!strcmp(arg, "--seed") && value)
+		{
+			std::uint32_t seed = (std::uint32_t)strtoul(value, nullptr, 10);
+			options.m_listxml.m_seed = seed;
+			options.m_softlist.m_seed = seed;
+			i++;
+			continue;
+		}
+		else
+			return false;
+
+		if (!value)
+			return false;
+		*int_target = atoi(value);
+		if (*int_target <= 0)
+			return false;
+		i++;
+	}
+	return true;
+}
+
+
+//-------------------------------------------------
+//  main
+//-------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+	bench_options options;
+	if (!parse_arguments(argc, argv, options))
+	{
+		fprintf(stderr, "Usage: %s [--machines N] [--dipvalues N] [--software N] [--iterations N] [--seed N]\n", argv[0]);
+		fprintf(stderr, "  --machines    machines in the synthetic -listxml output (default %d)\n", bench::listxml_options().m_machine_count);
+		fprintf(stderr, "  --dipvalues   average dipvalues per machine (default %d)\n", bench::listxml_options().m_dipvalues_per_machine);
+		fprintf(stderr, "  --software    entries in the synthetic software list (default %d)\n", bench::softlist_options().m_software_count);
+		fprintf(stderr, "  --iterations  runs of each benchmark (default %d)\n", bench_options().m_iterations);
+		fprintf(stderr, "  --seed        generator seed (default %u)\n", (unsigned)bench::listxml_options().m_seed);
+		return 1;
+	}
+
+	// generate the input; this is deterministic for a given set of options
+	fprintf(stderr, "Generating %d machines and %d software entries...\n", options.m_listxml.m_machine_count, options.m_softlist.m_software_count);
+	const std::string listxml = bench::generate_listxml(options.m_listxml);
+	const std::string softlist = bench::generate_softlist(options.m_softlist);
+
+	// results go to stdout as CSV
+	printf("benchmark,iterations,bytes,items,mean_seconds,best_seconds,mib_per_second,items_per_second,peak_rss_kib\n");
+
+	// raw XmlParser throughput over -listxml output
+	size_t machine_count = 0;
+	bool success = run_benchmark("xmlparser_listxml", options.m_iterations, listxml.size(), options.m_listxml.m_machine_count, [&]()
+	{
+		XmlParser xml;
+		machine_count = 0;
+		xml.OnElementBegin({ "mame", "machine" }, [&](const XmlParser::Attributes &attributes)
+		{
+			bool runnable;
+			if (attributes.Get("runnable", runnable) && !runnable)
+				return XmlParser::element_result::SKIP;
+			machine_count++;
+			return XmlParser::element_result::OK;
+		});
+		xml.OnElementEnd({ "mame", "machine", "description" }, [](QString &&)
+		{
+		});
+
+		QByteArray byte_array = raw_byte_array(listxml.data(), listxml.size());
+		QDataStream input(byte_array);
+		return xml.Parse(input);
+	});
+
+	// raw XmlParser throughput over a software list
+	success = success && run_benchmark("xmlparser_softlist", options.m_iterations, softlist.size(), options.m_softlist.m_software_count, [&]()
+	{
+		XmlParser xml;
+		xml.OnElementBegin({ "softwarelist", "software" }, [](const XmlParser::Attributes &attributes)
+		{
+			QString name;
+			attributes.Get("name", name);
+		});
+		xml.OnElementEnd({ { "softwarelist", "software", "description" },
+						   { "softwarelist", "software", "year" },
+						   { "softwarelist", "software", "publisher" } }, [](QString &&)
+		{
+		});
+
+		QByteArray byte_array = raw_byte_array(softlist.data(), softlist.size());
+		QDataStream input(byte_array);
+		return xml.Parse(input);
+	});
+
+	// building the info DB
+	std::unique_ptr<info::database_builder> builder;
+	success = success && run_benchmark("process_xml", options.m_iterations, listxml.size(), machine_count, [&]()
+	{
+		builder = std::make_unique<info::database_builder>();
+		QByteArray byte_array = raw_byte_array(listxml.data(), listxml.size());
+		QDataStream input(byte_array);
+		QString error_message;
+		return builder->process_xml(input, error_message);
+	});
+	success = success && run_benchmark("process_xml_parallel", options.m_iterations, listxml.size(), machine_count, [&]()
+	{
+		info::database_builder parallel_builder;
+		QString error_message;
+		return parallel_builder.process_xml_parallel(listxml.data(), listxml.size(), error_message);
+	});
+
+	// emitting the info DB; emit it once up front so we know its size
+	QByteArray info_db;
+	auto emit_info = [&builder](QByteArray &byte_array)
+	{
+		byte_array.clear();
+		QBuffer buffer(&byte_array);
+		buffer.open(QIODevice::WriteOnly);
+		QDataStream stream(&buffer);
+		builder->emit_info(stream);
+		return byte_array.size() > 0;
+	};
+	success = success && emit_info(info_db) && run_benchmark("emit_info", options.m_iterations, info_db.size(), machine_count, [&]()
+	{
+		QByteArray byte_array;
+		return emit_info(byte_array);
+	});
+
+	// and loading it
+	success = success && run_benchmark("database_load", options.m_iterations, info_db.size(), machine_count, [&]()
+	{
+		info::database db;
+		QDataStream input(info_db);
+		return db.load(input);
+	});
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,463 @@
+/***************************************************************************
+
+    bench/xmlgenerator.cpp
+
+    Deterministic generator of synthetic -listxml and software list XML
+
+***************************************************************************/
+
+#include <algorithm>
+#include <random>
+#include <cstdarg>
+#include <cstdio>
+
+#include "bench/xmlgenerator.h"
+
+
+//**************************************************************************
+//  LOCAL VARIABLES
+//**************************************************************************
+
+// names are built out of two letter syllables, which makes every index map to a unique name
+static const char *const s_syllables[] =
+{
+	"ka", "ke", "ki", "ko", "ma", "me", "mi", "mo",
+	"pa", "pe", "pi", "po", "ta", "te", "ti", "to",
+	"sa", "se", "si", "so", "na", "ne", "ni", "no",
+	"ra", "re", "ri", "ro", "la", "le", "li", "lo"
+};
+
+static const char *const s_title_words[] =
+{
+	"Space", "Dragon", "Street", "Fighter", "Galaxy", "Ninja", "Turbo", "Thunder",
+	"Super", "Mega", "Blaster", "Quest", "Legend", "Warrior", "Power", "Strike",
+	"Crystal", "Castle", "Racing", "Champion", "Knights", "Shadow", "Force", "Zone"
+};
+
+static const char *const s_variants[] =
+{
+	"World", "US", "Japan", "Europe", "Asia", "rev A", "rev B", "set 1", "set 2", "bootleg", "prototype"
+};
+
+static const char *const s_manufacturers[] =
+{
+	"Capcom", "Konami", "Namco", "Sega", "Taito", "Irem", "Data East", "SNK",
+	"Atari", "Williams", "Nintendo", "Technos Japan", "Jaleco", "Toaplan", "Midway", "Nichibutsu",
+	"Tandy Radio Shack", "Commodore", "Sinclair Research", "bootleg", "<unknown>",
+	"Sega / Nihon Bussan", "Kaneko & Atlus", "T\xC5\x8D" "ei"
+};
+
+static const char *const s_sourcefiles[] =
+{
+	"cps1", "cps2", "system16", "namcos1", "taito_f2", "m72", "dec0", "neogeo",
+	"galaxian", "pacman", "williams", "coco12", "c64", "spectrum", "segas32", "konamigx"
+};
+
+static const char *const s_cpus[] =
+{
+	"Z80", "Motorola MC68000", "MOS Technology 6502", "Intel 8085A", "Hitachi HD6309", "NEC V30", "Hitachi SH-2"
+};
+
+static const char *const s_dipswitch_names[] =
+{
+	"Coinage", "Coin A", "Coin B", "Lives", "Bonus Life", "Difficulty", "Demo Sounds", "Flip Screen",
+	"Cabinet", "Service Mode", "Allow Continue", "Free Play", "Game Time", "Unused", "Language", "Freeze"
+};
+
+static const char *const s_dipvalue_names[] =
+{
+	"Off", "On", "1 Coin/1 Credit", "1 Coin/2 Credits", "2 Coins/1 Credit", "Easy", "Normal", "Hard",
+	"Hardest", "Upright", "Cocktail", "3", "4", "5", "Infinite (Cheat)", "Every 50000"
+};
+
+static const char *const s_device_types[] =
+{
+	"cartridge", "cassette", "floppydisk", "quickload", "printout", "harddisk"
+};
+
+static const char *const s_interfaces[] =
+{
+	"synth_cart", "synth_cass", "floppy_5_25", "floppy_3_5", "synth_hdd"
+};
+
+
+//**************************************************************************
+//  LOCAL TYPES
+//**************************************************************************
+
+namespace
+{
+	// ======================> random_source
+	// std::mt19937's output is fully specified by the standard, unlike the distributions,
+	// so ranges are taken off of the raw output to keep the generated XML identical everywhere
+	class random_source
+	{
+	public:
+		random_source(std::uint32_t seed)
+			: m_engine(seed)
+		{
+		}
+
+		int next(int range)
+		{
+			return (int)(m_engine() % (std::uint32_t)range);
+		}
+
+		bool chance(int one_in)
+		{
+			return next(one_in) == 0;
+		}
+
+		std::uint32_t raw()
+		{
+			return m_engine();
+		}
+
+		template<std::size_t N>
+		const char *pick(const char *const (&table)[N])
+		{
+			return table[next((int)N)];
+		}
+
+	private:
+		std::mt19937	m_engine;
+	};
+
+
+	// ======================> xml_writer
+	class xml_writer
+	{
+	public:
+		xml_writer(std::string &output)
+			: m_output(output)
+		{
+		}
+
+		void append(const char *text)
+		{
+			m_output.append(text);
+		}
+
+		void append(const std::string &text)
+		{
+			m_output.append(text);
+		}
+
+		void append_format(const char *format, ...)
+		{
+			char buffer[512];
+			va_list args;
+			va_start(args, format);
+			int length = vsnprintf(buffer, sizeof(buffer), format, args);
+			va_end(args);
+			m_output.append(buffer, (size_t) std::min(length, (int)sizeof(buffer) - 1));
+		}
+
+		void append_escaped(const char *text)
+		{
+			for (const char *s = text; *s; s++)
+			{
+				switch (*s)
+				{
+				case '<':	m_output.append("&lt;");	break;
+				case '>':	m_output.append("&gt;");	break;
+				case '&':	m_output.append("&amp;");	break;
+				case '\"':	m_output.append("&quot;");	break;
+				default:	m_output.push_back(*s);		break;
+				}
+			}
+		}
+
+	private:
+		std::string &m_output;
+	};
+};
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  make_name
+//-------------------------------------------------
+
+static std::string make_name(int index)
+{
+	const int syllable_count = (int)(sizeof(s_syllables) / sizeof(s_syllables[0]));
+
+	// offset the index so that every name has at least two syllables
+	std::string result;
+	for (int value = index + syllable_count; value > 0; value /= syllable_count)
+		result.insert(0, s_syllables[value % syllable_count]);
+	return result;
+}
+
+
+//-------------------------------------------------
+//  make_title
+//-------------------------------------------------
+
+static std::string make_title(random_source &rand)
+{
+	std::string result = rand.pick(s_title_words);
+	int word_count = 1 + rand.next(3);
+	for (int i = 0; i < word_count; i++)
+	{
+		result += rand.chance(8) ? " & " : " ";
+		result += rand.pick(s_title_words);
+	}
+	if (rand.chance(3))
+	{
+		result += " (";
+		result += rand.pick(s_variants);
+		result += ")";
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  append_roms
+//-------------------------------------------------
+
+static void append_roms(xml_writer &xml, random_source &rand, const std::string &name, int count, const char *indent)
+{
+	for (int i = 0; i < count; i++)
+	{
+		// draw each value separately; the order in which arguments are evaluated is unspecified
+		int size = 1024 << rand.next(8);
+		char suffix = (char)('a' + rand.next(8));
+		std::uint32_t crc = rand.raw();
+		std::uint32_t sha1[5];
+		for (std::uint32_t &word : sha1)
+			word = rand.raw();
+
+		xml.append_format("%s<rom name=\"%s.%d%c\" size=\"%d\" crc=\"%08x\" sha1=\"%08x%08x%08x%08x%08x\" region=\"maincpu\" offset=\"%x\"/>\n",
+			indent, name.c_str(), i + 1, suffix, size, crc,
+			sha1[0], sha1[1], sha1[2], sha1[3], sha1[4], i * size);
+	}
+}
+
+
+//-------------------------------------------------
+//  append_dipswitches
+//-------------------------------------------------
+
+static void append_dipswitches(xml_writer &xml, random_source &rand, int target_dipvalue_count)
+{
+	// vary the number of dipvalues by +/- 50% around the target
+	int remaining = target_dipvalue_count / 2 + rand.next(target_dipvalue_count + 1);
+	int switch_number = 0;
+	while (remaining > 0)
+	{
+		int value_count = std::min(2 + rand.next(7), std::max(remaining, 2));
+		int bit = switch_number % 8;
+		const char *tag = switch_number < 8 ? "DSW1" : "DSW2";
+		xml.append_format("\t\t<dipswitch name=\"%s\" tag=\"%s\" mask=\"%d\">\n", rand.pick(s_dipswitch_names), tag, 1 << bit);
+		xml.append_format("\t\t\t<diplocation name=\"%s\" number=\"%d\"/>\n", tag, bit + 1);
+		for (int i = 0; i < value_count; i++)
+		{
+			xml.append_format("\t\t\t<dipvalue name=\"%s\" value=\"%d\"%s/>\n",
+				rand.pick(s_dipvalue_names), i << bit, i == 0 ? " default=\"yes\"" : "");
+		}
+		xml.append("\t\t</dipswitch>\n");
+
+		remaining -= value_count;
+		switch_number++;
+	}
+}
+
+
+//-------------------------------------------------
+//  append_configurations
+//-------------------------------------------------
+
+static void append_configurations(xml_writer &xml, random_source &rand)
+{
+	xml.append("\t\t<configuration name=\"Controller Port\" tag=\"ctrl_sel\" mask=\"15\">\n");
+	xml.append("\t\t\t<confsetting name=\"Joystick\" value=\"0\" default=\"yes\"/>\n");
+	xml.append("\t\t\t<confsetting name=\"Mouse\" value=\"1\">\n");
+	const char *relation = rand.chance(2) ? "eq" : "ne";
+	int value = rand.next(4) << 4;
+	xml.append_format("\t\t\t\t<condition tag=\"ctrl_sel\" mask=\"240\" relation=\"%s\" value=\"%d\"/>\n", relation, value);
+	xml.append("\t\t\t</confsetting>\n");
+	xml.append("\t\t</configuration>\n");
+}
+
+
+//-------------------------------------------------
+//  append_devices
+//-------------------------------------------------
+
+static void append_devices(xml_writer &xml, random_source &rand)
+{
+	int device_count = 1 + rand.next(4);
+	for (int i = 0; i < device_count; i++)
+	{
+		const char *type = rand.pick(s_device_types);
+		const char *dev_interface = rand.pick(s_interfaces);
+		const char *mandatory = rand.chance(4) ? " mandatory=\"1\"" : "";
+		xml.append_format("\t\t<device type=\"%s\" tag=\"%s%d\" interface=\"%s\"%s>\n",
+			type, type, i, dev_interface, mandatory);
+		xml.append_format("\t\t\t<instance name=\"%s%d\" briefname=\"%.4s%d\"/>\n", type, i, type, i);
+		xml.append("\t\t\t<extension name=\"bin\"/>\n");
+		xml.append("\t\t\t<extension name=\"rom\"/>\n");
+		xml.append("\t\t</device>\n");
+	}
+
+	int software_list_count = 1 + rand.next(3);
+	for (int i = 0; i < software_list_count; i++)
+	{
+		xml.append_format("\t\t<softwarelist name=\"%s\" status=\"%s\"/>\n",
+			s_interfaces[i], i == 0 ? "original" : "compatible");
+	}
+
+	for (int i = 0, kb = 16; i < 4; i++, kb *= 2)
+		xml.append_format("\t\t<ramoption name=\"%dK\"%s>%d</ramoption>\n", kb, i == 1 ? " default=\"yes\"" : "", kb * 1024);
+}
+
+
+//-------------------------------------------------
+//  append_machine
+//-------------------------------------------------
+
+static void append_machine(xml_writer &xml, random_source &rand, int index, int parent_index, int dipvalues_per_machine)
+{
+	std::string name = make_name(index);
+	const char *sourcefile = rand.pick(s_sourcefiles);
+
+	// every so often emit a device, which the info DB builder skips
+	if (rand.chance(25))
+	{
+		xml.append_format("\t<machine name=\"%s\" sourcefile=\"%s.cpp\" isdevice=\"yes\" runnable=\"no\">\n", name.c_str(), sourcefile);
+		xml.append_format("\t\t<description>Device %s</description>\n", name.c_str());
+		xml.append("\t</machine>\n");
+		return;
+	}
+
+	xml.append_format("\t<machine name=\"%s\" sourcefile=\"%s.cpp\"", name.c_str(), sourcefile);
+	if (parent_index >= 0)
+	{
+		std::string parent_name = make_name(parent_index);
+		xml.append_format(" cloneof=\"%s\" romof=\"%s\"", parent_name.c_str(), parent_name.c_str());
+	}
+	xml.append(">\n");
+
+	xml.append("\t\t<description>");
+	xml.append_escaped(make_title(rand).c_str());
+	xml.append("</description>\n");
+	int year = 1975 + rand.next(30);
+	xml.append_format("\t\t<year>%d%s</year>\n", year, rand.chance(20) ? "?" : "");
+	xml.append("\t\t<manufacturer>");
+	xml.append_escaped(rand.pick(s_manufacturers));
+	xml.append("</manufacturer>\n");
+
+	append_roms(xml, rand, name, 2 + rand.next(8), "\t\t");
+	const char *cpu = rand.pick(s_cpus);
+	xml.append_format("\t\t<chip type=\"cpu\" tag=\"maincpu\" name=\"%s\" clock=\"%d\"/>\n", cpu, 1000000 + rand.next(24000000));
+	xml.append("\t\t<chip type=\"audio\" tag=\"speaker\" name=\"Speaker\"/>\n");
+	int rotate = rand.chance(3) ? 270 : 0;
+	int width = 256 + 64 * rand.next(4);
+	int height = 224 + 16 * rand.next(3);
+	xml.append_format("\t\t<display tag=\"screen\" type=\"raster\" rotate=\"%d\" width=\"%d\" height=\"%d\" refresh=\"60.000000\" />\n",
+		rotate, width, height);
+	xml.append("\t\t<sound channels=\"1\"/>\n");
+	xml.append_format("\t\t<input players=\"%d\" coins=\"2\">\n", 1 + rand.next(4));
+	xml.append_format("\t\t\t<control type=\"joy\" player=\"1\" buttons=\"%d\" ways=\"8\"/>\n", 1 + rand.next(6));
+	xml.append("\t\t</input>\n");
+
+	append_dipswitches(xml, rand, dipvalues_per_machine);
+	if (rand.chance(10))
+		append_configurations(xml, rand);
+
+	xml.append_format("\t\t<driver status=\"%s\" emulation=\"good\" savestate=\"supported\"/>\n", rand.chance(5) ? "imperfect" : "good");
+
+	// a minority of machines are computers with media devices and software lists
+	if (rand.chance(8))
+		append_devices(xml, rand);
+
+	xml.append("\t</machine>\n");
+}
+
+
+//-------------------------------------------------
+//  generate_listxml
+//-------------------------------------------------
+
+std::string bench::generate_listxml(const listxml_options &options)
+{
+	random_source rand(options.m_seed);
+	std::string result;
+	xml_writer xml(result);
+
+	xml.append("<?xml version=\"1.0\"?>\n");
+	xml.append("<mame build=\"0.226 (synthetic)\" debug=\"no\" mameconfig=\"10\">\n");
+
+	int parent_index = -1;
+	for (int index = 0; index < options.m_machine_count; index++)
+	{
+		// roughly a third of the machines are clones of the most recent parent
+		bool is_clone = parent_index >= 0 && rand.next(3) == 0;
+		append_machine(xml, rand, index, is_clone ? parent_index : -1, options.m_dipvalues_per_machine);
+		if (!is_clone)
+			parent_index = index;
+	}
+
+	xml.append("</mame>\n");
+	return result;
+}
+
+
+//-------------------------------------------------
+//  generate_softlist
+//-------------------------------------------------
+
+std::string bench::generate_softlist(const softlist_options &options)
+{
+	random_source rand(options.m_seed);
+	std::string result;
+	xml_writer xml(result);
+
+	xml.append("<?xml version=\"1.0\"?>\n");
+	xml.append("<!DOCTYPE softwarelist SYSTEM \"softwarelist.dtd\">\n");
+	xml.append("<softwarelist name=\"synth_cart\" description=\"Synthetic cartridges\">\n");
+
+	int parent_index = -1;
+	for (int index = 0; index < options.m_software_count; index++)
+	{
+		std::string name = make_name(index);
+		bool is_clone = parent_index >= 0 && rand.next(4) == 0;
+
+		xml.append_format("\t<software name=\"%s\"", name.c_str());
+		if (is_clone)
+			xml.append_format(" cloneof=\"%s\"", make_name(parent_index).c_str());
+		xml.append(">\n");
+
+		xml.append("\t\t<description>");
+		xml.append_escaped(make_title(rand).c_str());
+		xml.append("</description>\n");
+		xml.append_format("\t\t<year>%d</year>\n", 1980 + rand.next(15));
+		xml.append("\t\t<publisher>");
+		xml.append_escaped(rand.pick(s_manufacturers));
+		xml.append("</publisher>\n");
+		xml.append_format("\t\t<info name=\"serial\" value=\"26-%04d\" />\n", rand.next(10000));
+
+		int part_count = rand.chance(6) ? 2 : 1;
+		for (int part = 0; part < part_count; part++)
+		{
+			xml.append_format("\t\t<part name=\"cart%d\" interface=\"synth_cart\">\n", part + 1);
+			xml.append_format("\t\t\t<dataarea name=\"rom\" size=\"%d\">\n", 8192 << rand.next(3));
+			append_roms(xml, rand, name, 1 + rand.next(2), "\t\t\t\t");
+			xml.append("\t\t\t</dataarea>\n");
+			xml.append("\t\t</part>\n");
+		}
+		xml.append("\t</software>\n");
+
+		if (!is_clone)
+			parent_index = index;
+	}
+
+	xml.append("</softwarelist>\n");
+	return result;
+}
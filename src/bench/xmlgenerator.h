@@ -0,0 +1,47 @@
+/***************************************************************************
+
+    bench/xmlgenerator.h
+
+    Deterministic generator of synthetic -listxml and software list XML
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef BENCH_XMLGENERATOR_H
+#define BENCH_XMLGENERATOR_H
+
+#include <cstdint>
+#include <string>
+
+
+//**************************************************************************
+//  TYPE DEFINITIONS
+//**************************************************************************
+
+namespace bench
+{
+	// ======================> listxml_options
+	struct listxml_options
+	{
+		int				m_machine_count = 40000;
+		int				m_dipvalues_per_machine = 38;
+		std::uint32_t	m_seed = 1;
+	};
+
+	// ======================> softlist_options
+	struct softlist_options
+	{
+		int				m_software_count = 5000;
+		std::uint32_t	m_seed = 1;
+	};
+
+	// generates output shaped like 'mame -listxml'; the same options always produce the same bytes
+	std::string generate_listxml(const listxml_options &options);
+
+	// generates a software list hash file
+	std::string generate_softlist(const softlist_options &options);
+};
+
+
+#endif // BENCH_XMLGENERATOR_H
@@ -6,8 +6,6 @@
 
 ***************************************************************************/
 
-#include <QSortFilterProxyModel>
-
 #include "dialogs/choosesw.h"
 #include "ui_choosesw.h"
 #include "softwarelistitemmodel.h"
@@ -71,7 +69,7 @@ ChooseSoftlistPartDialog::~ChooseSoftlistPartDialog()
 QString ChooseSoftlistPartDialog::selection() const
 {
 	QModelIndexList selection = m_ui->tableView->selectionModel()->selectedIndexes();
-	QModelIndex actualIndex = dynamic_cast<QSortFilterProxyModel *>(m_ui->tableView->model())->mapToSource(selection[0]);
+	QModelIndex actualIndex = dynamic_cast<SortFilterProxyModel *>(m_ui->tableView->model())->mapToSource(selection[0]);
 	const software_list::software &sw = m_itemModel->getSoftwareByIndex(actualIndex.row());
-	return sw.m_name;
+	return sw.name();
 }
@@ -176,15 +176,15 @@ const QString &ImagesDialog::PrettifyImageFileName(const software_list_collectio
 
     // find the software
     const QString *dev_interface = DeviceInterfaceFromTag(tag);
-    const software_list::software *software = dev_interface
+    std::optional<software_list::software> software = dev_interface
         ? software_col.find_software_by_name(file_name, *dev_interface)
-        : nullptr;
+        : std::nullopt;
 
     // did we find the software?
     if (software)
     {
         // if so, the pretty name is the description
-        result = &software->m_description;
+        result = &software->description();
     }
     else if (!full_path && !file_name.isEmpty())
     {
@@ -298,6 +298,8 @@ QStringList PathsDialog::buildComboBoxStrings()
 	paths[(size_t)Preferences::global_path_type::HASH]				= "Hash Files";
 	paths[(size_t)Preferences::global_path_type::ARTWORK]			= "Artwork Files";
 	paths[(size_t)Preferences::global_path_type::ICONS]				= "Icons";
+	paths[(size_t)Preferences::global_path_type::SNAPSHOTS]			= "Snapshots";
+	paths[(size_t)Preferences::global_path_type::TITLES]			= "Titles";
 	paths[(size_t)Preferences::global_path_type::PLUGINS]			= "Plugins";
 	paths[(size_t)Preferences::global_path_type::PROFILES]			= "Profiles";
 
@@ -326,7 +328,10 @@ Preferences::global_path_type PathsDialog::getCurrentPath() const
 bool PathsDialog::isFilePathType(Preferences::global_path_type type)
 {
 	return type == Preferences::global_path_type::EMU_EXECUTABLE
-		|| type == Preferences::global_path_type::ICONS;
+		|| type == Preferences::global_path_type::HASH
+		|| type == Preferences::global_path_type::ICONS
+		|| type == Preferences::global_path_type::SNAPSHOTS
+		|| type == Preferences::global_path_type::TITLES;
 }
 
 
@@ -343,6 +348,8 @@ bool PathsDialog::isDirPathType(Preferences::global_path_type type)
 		|| type == Preferences::global_path_type::HASH
 		|| type == Preferences::global_path_type::ARTWORK
 		|| type == Preferences::global_path_type::ICONS
+		|| type == Preferences::global_path_type::SNAPSHOTS
+		|| type == Preferences::global_path_type::TITLES
 		|| type == Preferences::global_path_type::PLUGINS
 		|| type == Preferences::global_path_type::PROFILES;
 }
@@ -0,0 +1,387 @@
+/***************************************************************************
+
+	iconcache.cpp
+
+	Persistent cache of scaled icons
+
+***************************************************************************/
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cstring>
+
+#include "iconcache.h"
+
+
+//**************************************************************************
+//  CONSTANTS
+//**************************************************************************
+
+#define LOG_CACHE	0
+
+static const quint32 CACHE_MAGIC = 0x4F434942;		// 'BICO'; also tells us if the byte order is wrong
+static const quint32 CACHE_VERSION = 1;
+
+
+//**************************************************************************
+//  TYPE DEFINITIONS
+//**************************************************************************
+
+// The file is laid out so that it can be used where it is mapped:
+//
+//	Header
+//	sources, serialized with QDataStream
+//	Entry[m_entryCount], sorted by name
+//	names, in UTF-8
+//	pixels, iconBytes() for each entry in turn
+//
+// Integers and pixels are in the native byte order; sections are aligned to four bytes
+
+struct IconCache::Header
+{
+	quint32		m_magic;
+	quint32		m_version;
+	quint32		m_iconWidth;
+	quint32		m_iconHeight;
+	quint32		m_iconFormat;
+	quint32		m_sourcesSize;
+	quint32		m_entryCount;
+	quint32		m_namesSize;
+};
+
+
+struct IconCache::Entry
+{
+	quint32		m_nameOffset;
+	quint32		m_nameLength;
+	quint32		m_sourceIndex;
+};
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  align
+//-------------------------------------------------
+
+static quint64 align(quint64 offset)
+{
+	return (offset + 3) & ~(quint64)3;
+}
+
+
+//-------------------------------------------------
+//  Source::get
+//-------------------------------------------------
+
+IconCache::Source IconCache::Source::get(const QString &path)
+{
+	QFileInfo fi(path);
+	return Source { path, fi.size(), fi.lastModified().toMSecsSinceEpoch() };
+}
+
+
+//-------------------------------------------------
+//  Source::operator==
+//-------------------------------------------------
+
+bool IconCache::Source::operator==(const Source &that) const
+{
+	return m_path == that.m_path
+		&& m_size == that.m_size
+		&& m_mtime == that.m_mtime;
+}
+
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+IconCache::IconCache(int iconSize)
+	: m_iconSize(iconSize)
+	, m_data(nullptr)
+	, m_entries(nullptr)
+	, m_entryCount(0)
+	, m_names(nullptr)
+	, m_pixels(nullptr)
+	, m_validSourceCount(0)
+{
+}
+
+
+//-------------------------------------------------
+//  dtor
+//-------------------------------------------------
+
+IconCache::~IconCache()
+{
+	close();
+}
+
+
+//-------------------------------------------------
+//  open
+//-------------------------------------------------
+
+void IconCache::open(const QString &fileName, std::vector<Source> &&sources)
+{
+	close();
+	m_added.clear();
+	m_fileName = fileName;
+	m_sources = std::move(sources);
+	if (!m_fileName.isEmpty() && !map())
+		close();
+
+	if (LOG_CACHE)
+		qDebug("IconCache::open(): %u entries, %u of %u sources valid", (unsigned)m_entryCount, (unsigned)m_validSourceCount, (unsigned)m_sources.size());
+}
+
+
+//-------------------------------------------------
+//  close
+//-------------------------------------------------
+
+void IconCache::close()
+{
+	if (m_data)
+		m_file.unmap(const_cast<uchar *>(m_data));
+	m_file.close();
+	m_data = nullptr;
+	m_entries = nullptr;
+	m_entryCount = 0;
+	m_names = nullptr;
+	m_pixels = nullptr;
+	m_validSourceCount = 0;
+}
+
+
+//-------------------------------------------------
+//  map
+//-------------------------------------------------
+
+bool IconCache::map()
+{
+	m_file.setFileName(m_fileName);
+	if (!m_file.open(QIODevice::ReadOnly) || m_file.size() < (qint64)sizeof(Header))
+		return false;
+	quint64 fileSize = (quint64)m_file.size();
+	m_data = m_file.map(0, m_file.size());
+	if (!m_data)
+		return false;
+
+	// check the header
+	Header header;
+	memcpy(&header, m_data, sizeof(header));
+	if (header.m_magic != CACHE_MAGIC
+		|| header.m_version != CACHE_VERSION
+		|| header.m_iconWidth != (quint32)m_iconSize
+		|| header.m_iconHeight != (quint32)m_iconSize
+		|| header.m_iconFormat != (quint32)ICON_FORMAT)
+		return false;
+
+	// and that everything fits
+	quint64 sourcesOffset = sizeof(Header);
+	quint64 entriesOffset = align(sourcesOffset + header.m_sourcesSize);
+	quint64 namesOffset = entriesOffset + (quint64)header.m_entryCount * sizeof(Entry);
+	quint64 pixelsOffset = align(namesOffset + header.m_namesSize);
+	if (pixelsOffset + (quint64)header.m_entryCount * iconBytes() > fileSize)
+		return false;
+	m_entries = reinterpret_cast<const Entry *>(m_data + entriesOffset);
+	m_entryCount = header.m_entryCount;
+	m_names = reinterpret_cast<const char *>(m_data + namesOffset);
+	m_pixels = m_data + pixelsOffset;
+	for (quint32 i = 0; i < m_entryCount; i++)
+	{
+		if ((quint64)m_entries[i].m_nameOffset + m_entries[i].m_nameLength > header.m_namesSize)
+			return false;
+	}
+
+	// which sources are still what they were when the icons were cached?
+	QByteArray sourcesBytes = QByteArray::fromRawData(reinterpret_cast<const char *>(m_data + sourcesOffset), (int)header.m_sourcesSize);
+	QDataStream stream(sourcesBytes);
+	stream.setVersion(QDataStream::Qt_5_0);
+	quint32 sourceCount;
+	stream >> sourceCount;
+	for (quint32 i = 0; stream.status() == QDataStream::Ok && i < sourceCount && i < m_sources.size(); i++)
+	{
+		Source source;
+		stream >> source.m_path >> source.m_size >> source.m_mtime;
+		if (stream.status() != QDataStream::Ok || !(source == m_sources[i]))
+			break;
+		m_validSourceCount = i + 1;
+	}
+	return true;
+}
+
+
+//-------------------------------------------------
+//  save
+//-------------------------------------------------
+
+bool IconCache::save()
+{
+	if (m_fileName.isEmpty() || m_added.empty())
+		return true;
+
+	// merge what we had with what we added; both are sorted by name
+	struct Record
+	{
+		std::string_view	m_name;
+		quint32				m_sourceIndex;
+		const uchar *		m_pixels;
+	};
+	std::vector<Record> records;
+	records.reserve(m_entryCount + m_added.size());
+	auto addedIter = m_added.begin();
+	auto addAdded = [&records](const std::pair<const QByteArray, std::pair<std::uint32_t, QByteArray>> &added)
+	{
+		records.push_back(Record { std::string_view(added.first.constData(), added.first.size()), added.second.first, reinterpret_cast<const uchar *>(added.second.second.constData()) });
+	};
+	for (quint32 i = 0; i < m_entryCount; i++)
+	{
+		if (m_entries[i].m_sourceIndex >= m_validSourceCount)
+			continue;
+		std::string_view name = entryName(m_entries[i]);
+		while (addedIter != m_added.end() && std::string_view(addedIter->first.constData(), addedIter->first.size()) < name)
+			addAdded(*addedIter++);
+		if (addedIter == m_added.end() || std::string_view(addedIter->first.constData(), addedIter->first.size()) != name)
+			records.push_back(Record { name, m_entries[i].m_sourceIndex, entryPixels(m_entries[i]) });
+	}
+	while (addedIter != m_added.end())
+		addAdded(*addedIter++);
+
+	// serialize the sources
+	QByteArray sourcesBytes;
+	{
+		QDataStream stream(&sourcesBytes, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_0);
+		stream << (quint32)m_sources.size();
+		for (const Source &source : m_sources)
+			stream << source.m_path << source.m_size << source.m_mtime;
+	}
+
+	// build the entries and the names
+	std::vector<Entry> entries;
+	entries.reserve(records.size());
+	QByteArray names;
+	for (const Record &record : records)
+	{
+		entries.push_back(Entry { (quint32)names.size(), (quint32)record.m_name.size(), record.m_sourceIndex });
+		names.append(record.m_name.data(), (int)record.m_name.size());
+	}
+
+	// and put it all together
+	Header header = { CACHE_MAGIC, CACHE_VERSION, (quint32)m_iconSize, (quint32)m_iconSize, (quint32)ICON_FORMAT, (quint32)sourcesBytes.size(), (quint32)entries.size(), (quint32)names.size() };
+	QByteArray contents;
+	auto pad = [&contents]()
+	{
+		contents.append((int)(align(contents.size()) - contents.size()), '\0');
+	};
+	contents.append(reinterpret_cast<const char *>(&header), sizeof(header));
+	contents.append(sourcesBytes);
+	pad();
+	contents.append(reinterpret_cast<const char *>(entries.data()), (int)(entries.size() * sizeof(Entry)));
+	contents.append(names);
+	pad();
+	for (const Record &record : records)
+		contents.append(reinterpret_cast<const char *>(record.m_pixels), (int)iconBytes());
+
+	// we can only write over the file once it is no longer mapped
+	records.clear();
+	close();
+	m_added.clear();
+	QSaveFile file(m_fileName);
+	bool success = file.open(QIODevice::WriteOnly)
+		&& file.write(contents) == contents.size()
+		&& file.commit();
+
+	if (LOG_CACHE)
+		qDebug("IconCache::save(): %u entries, %s", (unsigned)entries.size(), success ? "succeeded" : "failed");
+
+	// and start using what we wrote
+	if (!map())
+		close();
+	return success;
+}
+
+
+//-------------------------------------------------
+//  find
+//-------------------------------------------------
+
+std::optional<QImage> IconCache::find(const QString &iconName) const
+{
+	QByteArray name = iconName.toUtf8();
+
+	// icons added this session are only in the file once we save, and supersede what is there
+	auto addedIter = m_added.find(name);
+	if (addedIter != m_added.end())
+		return QImage(reinterpret_cast<const uchar *>(addedIter->second.second.constData()), m_iconSize, m_iconSize, m_iconSize * 4, ICON_FORMAT);
+
+	const Entry *entry = findEntry(name);
+	if (!entry || entry->m_sourceIndex >= m_validSourceCount)
+		return { };
+	return QImage(entryPixels(*entry), m_iconSize, m_iconSize, m_iconSize * 4, ICON_FORMAT);
+}
+
+
+//-------------------------------------------------
+//  add
+//-------------------------------------------------
+
+void IconCache::add(const QString &iconName, int sourceIndex, const QImage &image)
+{
+	QImage convertedImage = image.convertToFormat(ICON_FORMAT);
+	if (convertedImage.width() != m_iconSize || convertedImage.height() != m_iconSize)
+		return;
+
+	QByteArray pixels;
+	pixels.reserve((int)iconBytes());
+	for (int y = 0; y < m_iconSize; y++)
+		pixels.append(reinterpret_cast<const char *>(convertedImage.constScanLine(y)), m_iconSize * 4);
+	m_added[iconName.toUtf8()] = std::make_pair((std::uint32_t)sourceIndex, std::move(pixels));
+}
+
+
+//-------------------------------------------------
+//  findEntry
+//-------------------------------------------------
+
+const IconCache::Entry *IconCache::findEntry(const QByteArray &name) const
+{
+	std::string_view target(name.constData(), name.size());
+	const Entry *end = m_entries + m_entryCount;
+	const Entry *iter = std::lower_bound(m_entries, end, target, [this](const Entry &entry, std::string_view target)
+	{
+		return entryName(entry) < target;
+	});
+	return iter != end && entryName(*iter) == target
+		? iter
+		: nullptr;
+}
+
+
+//-------------------------------------------------
+//  entryName
+//-------------------------------------------------
+
+std::string_view IconCache::entryName(const Entry &entry) const
+{
+	return std::string_view(m_names + entry.m_nameOffset, entry.m_nameLength);
+}
+
+
+//-------------------------------------------------
+//  entryPixels
+//-------------------------------------------------
+
+const uchar *IconCache::entryPixels(const Entry &entry) const
+{
+	return m_pixels + (&entry - m_entries) * iconBytes();
+}
@@ -0,0 +1,91 @@
+/***************************************************************************
+
+	iconcache.h
+
+	Persistent cache of scaled icons
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef ICONCACHE_H
+#define ICONCACHE_H
+
+#include <QFile>
+#include <QImage>
+#include <QString>
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+
+// ======================> IconCache
+// icons are stored already scaled and in the format QPixmap wants, in a file that is mapped into
+// memory; after the first run, showing an icon involves no decoding at all
+class IconCache
+{
+public:
+	class test;
+
+	static const QImage::Format ICON_FORMAT = QImage::Format_ARGB32_Premultiplied;
+
+	// the icon paths that the icons came from; when one of these changes, icons from it (and
+	// from those after it, because it may now have an icon that shadows theirs) are invalid
+	struct Source
+	{
+		QString		m_path;
+		qint64		m_size;
+		qint64		m_mtime;
+
+		static Source get(const QString &path);
+		bool operator==(const Source &that) const;
+	};
+
+	// ctor / dtor; icons are square, and iconSize is their width and height in pixels
+	IconCache(int iconSize);
+	IconCache(const IconCache &) = delete;
+	~IconCache();
+
+	// opens the cache file, if present; anything added is written back by save()
+	void open(const QString &fileName, std::vector<Source> &&sources);
+	bool save();
+
+	// looks up an icon, including those added since the file was saved; the image refers to the
+	// mapped file (or to what was added) and should be copied right away
+	std::optional<QImage> find(const QString &iconName) const;
+
+	// records an icon found in sources()[sourceIndex]
+	void add(const QString &iconName, int sourceIndex, const QImage &image);
+
+	// accessors
+	const std::vector<Source> &sources() const { return m_sources; }
+
+private:
+	struct Header;
+	struct Entry;
+
+	int										m_iconSize;
+	QString									m_fileName;
+	std::vector<Source>						m_sources;
+	QFile									m_file;
+	const uchar *							m_data;
+	const Entry *							m_entries;
+	std::uint32_t							m_entryCount;
+	const char *							m_names;
+	const uchar *							m_pixels;
+	std::uint32_t							m_validSourceCount;
+	std::map<QByteArray, std::pair<std::uint32_t, QByteArray>>	m_added;	// keyed by UTF-8 name
+
+	void close();
+	bool map();
+	const Entry *findEntry(const QByteArray &name) const;
+	std::string_view entryName(const Entry &entry) const;
+	const uchar *entryPixels(const Entry &entry) const;
+	size_t iconBytes() const { return (size_t)m_iconSize * m_iconSize * 4; }
+};
+
+
+#endif // ICONCACHE_H
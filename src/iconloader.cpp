@@ -6,213 +6,603 @@
 
 ***************************************************************************/
 
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QImageReader>
+
+#include <algorithm>
+#include <cmath>
+
 #include "iconloader.h"
+#include "imagefinder.h"
 #include "prefs.h"
-#include "quazip/quazip.h"
-#include "quazip/quazipfile.h"
 
 
 //**************************************************************************
 //  CONSTANTS
 //**************************************************************************
 
-#define ICON_SIZE_X 16
-#define ICON_SIZE_Y 16
+#define LOG_PROBES	0
+
+#define MAX_SCALE	4
+
+// requests beyond this are dropped, oldest first; when flick scrolling, rows scroll out of view
+// faster than we can decode their icons and there is no point in working through them
+#define MAX_PENDING_REQUESTS	256
+#define MAX_THREADS				4
 
 
 //**************************************************************************
-//  TYPE DEFINITIONS
+//  IMPLEMENTATION
 //**************************************************************************
 
-// ======================> IconLoader::IconFinder
-class IconLoader::IconFinder
+QEvent::Type IconLoader::s_resultsEventId = (QEvent::Type) QEvent::registerEventType();
+
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+IconLoader::IconLoader(Preferences &prefs)
+	: m_prefs(prefs)
+	, m_budget(DEFAULT_BUDGET)
+	, m_statistics()
+	, m_scale(1)
+	, m_blankIcon(ICON_SIZE, ICON_SIZE)
+	, m_retiredProbeCount(0)
+	, m_lastProbeCount(0)
+	, m_generation(0)
+	, m_resultsEventPosted(false)
+	, m_exiting(false)
 {
-public:
-	IconFinder() = default;
-	IconFinder(const IconFinder &) = delete;
-	IconFinder(IconFinder &&) = delete;
+	m_blankIcon.fill(Qt::transparent);
+	refreshIcons();
+
+	// leave a core for the GUI thread
+	unsigned int threadCount = std::max(std::min(std::thread::hardware_concurrency(), (unsigned int)MAX_THREADS + 1), 2U) - 1;
+	for (unsigned int i = 0; i < threadCount; i++)
+		m_threads.emplace_back([this]() { threadProc(); });
+}
+
+
+//-------------------------------------------------
+//  dtor
+//-------------------------------------------------
 
-	virtual ~IconFinder()
+IconLoader::~IconLoader()
+{
 	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_exiting = true;
 	}
+	m_condition.notify_all();
+	for (std::thread &thread : m_threads)
+		thread.join();
 
-	virtual std::unique_ptr<QIODevice> getIconStream(const QString &filename) = 0;
-};
+	// hang on to whatever we decoded this session
+	for (auto &pair : m_iconCaches)
+		pair.second->save();
+}
 
 
-// ======================> IconLoader::DirectoryIconFinder
-class IconLoader::DirectoryIconFinder : public IconLoader::IconFinder
+//-------------------------------------------------
+//  refreshIcons
+//-------------------------------------------------
+
+void IconLoader::refreshIcons()
 {
-public:
-	DirectoryIconFinder(QString &&path)
-		: m_path(std::move(path))
+	// save whatever we decoded with the old paths
+	for (auto &pair : m_iconCaches)
+		pair.second->save();
+	m_iconCaches.clear();
+
+	// loop through all icon paths
+	auto finders = std::make_shared<FinderList>();
+	m_sources.clear();
+	QStringList paths = m_prefs.GetSplitPaths(Preferences::global_path_type::ICONS);
+	for (QString &path : paths)
 	{
+		// try to create an appropiate path entry, and if successful add it
+		std::unique_ptr<ImageFinder> iconFinder = ImageFinder::create(path);
+		if (iconFinder)
+		{
+			m_sources.push_back(IconCache::Source::get(path));
+			finders->push_back(std::move(iconFinder));
+		}
 	}
 
-	virtual std::unique_ptr<QIODevice> getIconStream(const QString &filename) override
+	// swap in the new finders; icons that are already being decoded will be discarded when
+	// they arrive because the generation changed, and the old finders go away when they are done
+	m_retiredProbeCount = probeCount();
 	{
-		return std::make_unique<QFile>(m_path + "/" + filename);
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_finders = std::move(finders);
+		m_generation++;
+		m_requests.clear();
+		m_prefetchRequests.clear();
+		m_results.clear();
 	}
+	m_iconMap.clear();
+	m_lru.clear();
+	m_statistics.m_residentBytes = 0;
+	m_statistics.m_residentCount = 0;
+}
+
 
-private:
-	QString		m_path;
-};
+//-------------------------------------------------
+//  setDevicePixelRatio
+//-------------------------------------------------
 
-// ======================> IconLoader::DirectoryIconFinder
-class IconLoader::ZipIconFinder : public IconLoader::IconFinder
+bool IconLoader::setDevicePixelRatio(qreal devicePixelRatio)
 {
-public:
-	ZipIconFinder(const QString &path)
-		: m_zip(path)
+	// variants for other ratios stay where they are until they fall out of the LRU
+	int scale = std::max(std::min((int)std::ceil(devicePixelRatio - 0.01), MAX_SCALE), 1);
+	if (scale == m_scale)
+		return false;
+	m_scale = scale;
+	return true;
+}
+
+
+//-------------------------------------------------
+//  getIcon
+//-------------------------------------------------
+
+const QPixmap &IconLoader::getIcon(const info::machine &machine, bool &pending)
+{
+	// clones fall back to the parent's icon, but we only know to do that once we know the
+	// clone does not have its own
+	const Icon *icon = getIconByName(machine.name());
+	if (icon->m_status == IconStatus::Missing && !machine.clone_of().isEmpty())
+		icon = getIconByName(machine.clone_of());
+
+	pending = icon->m_status == IconStatus::Pending;
+	return icon->m_status == IconStatus::Loaded
+		? icon->m_pixmap
+		: m_blankIcon;
+}
+
+
+//-------------------------------------------------
+//  addIconsLoadedCallback
+//-------------------------------------------------
+
+void IconLoader::addIconsLoadedCallback(std::function<void()> &&callback)
+{
+	m_iconsLoadedCallbacks.push_back(std::move(callback));
+}
+
+
+//-------------------------------------------------
+//  setBudget
+//-------------------------------------------------
+
+void IconLoader::setBudget(size_t budget)
+{
+	m_budget = budget;
+	trim();
+}
+
+
+//-------------------------------------------------
+//  event
+//-------------------------------------------------
+
+bool IconLoader::event(QEvent *event)
+{
+	if (event->type() != s_resultsEventId)
+		return QObject::event(event);
+
+	processResults();
+	return true;
+}
+
+
+//-------------------------------------------------
+//  getIconByName
+//-------------------------------------------------
+
+const IconLoader::Icon *IconLoader::getIconByName(const QString &iconName)
+{
+	// have we seen this before?
+	const Icon *icon = findIcon(iconName, m_scale);
+	if (icon)
+		return icon;
+
+	// we have not tried to load this icon; if there is nowhere to look we can answer right away
+	QString key = iconKey(iconName, m_scale);
+	if (m_finders->empty())
+		return &m_iconMap.emplace(std::move(key), Icon { IconStatus::Missing, QPixmap(), { } }).first->second;
+
+	// otherwise queue it up, taking it out of the prefetches if it is there
+	m_statistics.m_misses++;
+	auto iter = m_iconMap.emplace(std::move(key), Icon { IconStatus::Pending, QPixmap(), { } }).first;
+	std::optional<Request> droppedRequest;
 	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		auto prefetchIter = std::find_if(m_prefetchRequests.begin(), m_prefetchRequests.end(), [this, &iconName](const Request &request)
+		{
+			return request.m_iconName == iconName && request.m_scale == m_scale;
+		});
+		if (prefetchIter != m_prefetchRequests.end())
+			m_prefetchRequests.erase(prefetchIter);
+		m_requests.push_back(Request { iconName, QString(), m_scale });
+		if (m_requests.size() > MAX_PENDING_REQUESTS)
+		{
+			droppedRequest = std::move(m_requests.front());
+			m_requests.pop_front();
+		}
 	}
+	m_condition.notify_one();
 
-	bool openZip()
+	// forget about anything we dropped, so that it is requested again if it is still wanted; a
+	// prefetch could have gotten to it in the meantime though
+	if (droppedRequest)
 	{
-		return m_zip.open(QuaZip::Mode::mdUnzip);
+		auto droppedIter = m_iconMap.find(iconKey(droppedRequest->m_iconName, droppedRequest->m_scale));
+		if (droppedIter != m_iconMap.end() && droppedIter->second.m_status == IconStatus::Pending)
+			m_iconMap.erase(droppedIter);
 	}
+	return &iter->second;
+}
 
-	virtual std::unique_ptr<QIODevice> getIconStream(const QString &filename) override
+
+//-------------------------------------------------
+//  findIcon - looks up an icon that was already
+//	requested, or that is in the disk cache
+//-------------------------------------------------
+
+const IconLoader::Icon *IconLoader::findIcon(const QString &iconName, int scale)
+{
+	// look up the result in the icon map
+	QString key = iconKey(iconName, scale);
+	auto iter = m_iconMap.find(key);
+	if (iter != m_iconMap.end())
 	{
-		// find the file
-		if (!m_zip.setCurrentFile(filename))
-			return { };
+		if (iter->second.m_status == IconStatus::Loaded)
+		{
+			m_statistics.m_hits++;
+			m_lru.splice(m_lru.begin(), m_lru, iter->second.m_lruPosition);
+		}
+		return &iter->second;
+	}
 
-		// and return a QuaZipFile
-		return std::make_unique<QuaZipFile>(&m_zip);
+	// if we decoded it on a previous run, this is just a copy
+	std::optional<QImage> cachedImage = iconCache(scale).find(iconName);
+	if (cachedImage)
+	{
+		m_statistics.m_diskHits++;
+		QPixmap pixmap = QPixmap::fromImage(*cachedImage);
+		pixmap.setDevicePixelRatio(scale);
+		return &addLoadedIcon(std::move(key), std::move(pixmap));
 	}
 
-private:
-	QuaZip	m_zip;
-};
+	return nullptr;
+}
 
 
-//**************************************************************************
-//  IMPLEMENTATION
-//**************************************************************************
+//-------------------------------------------------
+//  addLoadedIcon
+//-------------------------------------------------
+
+IconLoader::Icon &IconLoader::addLoadedIcon(QString &&key, QPixmap &&pixmap)
+{
+	// this may be replacing a pending entry
+	Icon &icon = m_iconMap[key];
+	icon.m_status = IconStatus::Loaded;
+	icon.m_pixmap = std::move(pixmap);
+	m_lru.push_front(std::move(key));
+	icon.m_lruPosition = m_lru.begin();
+	m_statistics.m_residentBytes += pixmapBytes(icon.m_pixmap);
+	m_statistics.m_residentCount++;
+
+	// trimming never evicts what we just added, so the reference stays good
+	trim();
+	return icon;
+}
+
 
 //-------------------------------------------------
-//  ctor
+//  trim - evicts least recently used icons until
+//	we are within budget
 //-------------------------------------------------
 
-IconLoader::IconLoader(Preferences &prefs)
-	: m_prefs(prefs)
-	, m_blankIcon(ICON_SIZE_X, ICON_SIZE_Y)
+void IconLoader::trim()
 {
-	refreshIcons();
+	while (m_statistics.m_residentBytes > m_budget && m_lru.size() > 1)
+	{
+		auto iter = m_iconMap.find(m_lru.back());
+		m_statistics.m_residentBytes -= pixmapBytes(iter->second.m_pixmap);
+		m_statistics.m_residentCount--;
+		m_statistics.m_evictions++;
+		m_iconMap.erase(iter);
+		m_lru.pop_back();
+	}
 }
 
 
 //-------------------------------------------------
-//  dtor
+//  iconCache - gets the disk cache for a scale
 //-------------------------------------------------
 
-IconLoader::~IconLoader()
+IconCache &IconLoader::iconCache(int scale)
 {
+	std::unique_ptr<IconCache> &result = m_iconCaches[scale];
+	if (!result)
+	{
+		result = std::make_unique<IconCache>(ICON_SIZE * scale);
+		result->open(Preferences::GetIconCacheFileName(scale), std::vector<IconCache::Source>(m_sources));
+	}
+	return *result;
 }
 
 
 //-------------------------------------------------
-//  refreshIcons
+//  prefetchIcons
 //-------------------------------------------------
 
-void IconLoader::refreshIcons()
+void IconLoader::prefetchIcons(const std::vector<info::machine> &machines)
 {
-	// clear ourselves out
-	m_icon_map.clear();
-	m_finders.clear();
+	if (m_finders->empty())
+		return;
 
-	// loop through all icon paths
-	QStringList paths = m_prefs.GetSplitPaths(Preferences::global_path_type::ICONS);
-	for (QString &path : paths)
+	// work out what we do not already have, in the order specified
+	std::deque<Request> requests;
+	for (const info::machine &machine : machines)
 	{
-		// try to create an appropiate path entry
-		std::unique_ptr<IconFinder> iconFinder;
-		QFileInfo fi(path);
-		if (fi.isDir())
+		QString iconName = machine.name();
+		QString fallbackIconName = machine.clone_of();
+		const Icon *icon = findIcon(iconName, m_scale);
+		if (icon && icon->m_status == IconStatus::Missing && !fallbackIconName.isEmpty())
 		{
-			iconFinder = std::make_unique<DirectoryIconFinder>(std::move(path));
+			iconName = std::move(fallbackIconName);
+			fallbackIconName = QString();
+			icon = findIcon(iconName, m_scale);
 		}
-		else if (fi.isFile())
+		if (!icon)
+			requests.push_back(Request { std::move(iconName), std::move(fallbackIconName), m_scale });
+	}
+
+	// and replace the previous prefetch; what was left of it is for rows that have probably
+	// scrolled out of the way
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_prefetchRequests = std::move(requests);
+	}
+	m_condition.notify_all();
+}
+
+
+//-------------------------------------------------
+//  processResults - called on the GUI thread to
+//	take the icons decoded by the workers
+//-------------------------------------------------
+
+void IconLoader::processResults()
+{
+	std::vector<Result> results;
+	std::uint64_t generation;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		results = std::move(m_results);
+		m_results.clear();
+		m_resultsEventPosted = false;
+		generation = m_generation;
+	}
+
+	bool anyChanged = false;
+	for (Result &result : results)
+	{
+		if (result.m_generation != generation)
+			continue;
+
+		// prefetched icons are not in the map yet; anything that is there and not pending was
+		// resolved some other way in the meantime
+		QString key = iconKey(result.m_iconName, result.m_scale);
+		auto iter = m_iconMap.find(key);
+		bool wasPending = iter != m_iconMap.end() && iter->second.m_status == IconStatus::Pending;
+		if (iter != m_iconMap.end() && !wasPending)
+			continue;
+
+		// note that while decoding can fail, we want to memoize the failure
+		if (result.m_image)
+		{
+			iconCache(result.m_scale).add(result.m_iconName, result.m_finderIndex, *result.m_image);
+			QPixmap pixmap = QPixmap::fromImage(std::move(*result.m_image));
+			pixmap.setDevicePixelRatio(result.m_scale);
+			addLoadedIcon(std::move(key), std::move(pixmap));
+		}
+		else
 		{
-			auto zipIconFinder = std::make_unique<ZipIconFinder>(path);
-			if (zipIconFinder->openZip())
-				iconFinder = std::move(zipIconFinder);
+			m_iconMap[key] = Icon { IconStatus::Missing, QPixmap(), { } };
 		}
 
-		// if successful, add it
-		if (iconFinder)
-			m_finders.push_back(std::move(iconFinder));
+		// nobody is waiting on prefetches
+		anyChanged = anyChanged || wasPending;
 	}
+
+	// one notification per batch; when scrolling quickly, a single batch can have many icons
+	if (anyChanged)
+	{
+		for (const std::function<void()> &callback : m_iconsLoadedCallbacks)
+			callback();
+	}
+
+	if (LOG_PROBES)
+		logProbes();
 }
 
 
 //-------------------------------------------------
-//  getIcon
+//  probeCount - the number of times we went to
+//	the file system looking for icons
 //-------------------------------------------------
 
-const QPixmap &IconLoader::getIcon(const info::machine &machine)
+std::uint64_t IconLoader::probeCount() const
 {
-	const QPixmap *result = getIconByName(machine.name());
-	if (!result && !machine.clone_of().isEmpty())
-		result = getIconByName(machine.clone_of());	
-	return result ? *result : m_blankIcon;
+	// finders that are in the middle of reading have not counted that yet, which is close enough
+	std::uint64_t result = m_retiredProbeCount;
+	if (m_finders)
+	{
+		for (const auto &finder : *m_finders)
+			result += finder->probeCount();
+	}
+	return result;
 }
 
 
 //-------------------------------------------------
-//  getIconByName
+//  logProbes
 //-------------------------------------------------
 
-const QPixmap *IconLoader::getIconByName(const QString &icon_name)
+void IconLoader::logProbes()
 {
-	// look up the result in the icon map
-	auto iter = m_icon_map.find(icon_name);
+	if (!m_probeTimer.isValid())
+	{
+		m_probeTimer.start();
+		m_lastProbeCount = probeCount();
+	}
+	else if (m_probeTimer.elapsed() >= 1000)
+	{
+		std::uint64_t count = probeCount();
+		qDebug("IconLoader: %.1f file system probes/sec (%llu total); %llu hits, %llu disk hits, %llu misses, %llu evictions, %u icons (%u bytes) resident",
+			(count - m_lastProbeCount) * 1000.0 / m_probeTimer.restart(),
+			(unsigned long long)count,
+			(unsigned long long)m_statistics.m_hits,
+			(unsigned long long)m_statistics.m_diskHits,
+			(unsigned long long)m_statistics.m_misses,
+			(unsigned long long)m_statistics.m_evictions,
+			(unsigned)m_statistics.m_residentCount,
+			(unsigned)m_statistics.m_residentBytes);
+		m_lastProbeCount = count;
+	}
+}
+
 
-	// did we come up empty?
-	if (iter == m_icon_map.end())
+//-------------------------------------------------
+//  threadProc
+//-------------------------------------------------
+
+void IconLoader::threadProc()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;)
 	{
-		// we have not tried to load this icon - first determine the real file name
-		QString icon_file_name = icon_name + ".ico";
+		m_condition.wait(lock, [this]() { return m_exiting || !m_requests.empty() || !m_prefetchRequests.empty(); });
+		if (m_exiting)
+			break;
+
+		// icons that are on screen come first, working on the most recent request first since it
+		// is the most likely to still be on screen; after that come prefetches, nearest first
+		Request request;
+		if (!m_requests.empty())
+		{
+			request = std::move(m_requests.back());
+			m_requests.pop_back();
+		}
+		else
+		{
+			request = std::move(m_prefetchRequests.front());
+			m_prefetchRequests.pop_front();
+		}
+		std::uint64_t generation = m_generation;
+		std::shared_ptr<const FinderList> finders = m_finders;
+
+		lock.unlock();
+		int finderIndex;
+		std::optional<QImage> image = loadIcon(*finders, request.m_iconName, request.m_scale, finderIndex);
+		std::optional<Result> fallbackResult;
+		if (!image && !request.m_fallbackIconName.isEmpty())
+		{
+			int fallbackFinderIndex;
+			std::optional<QImage> fallbackImage = loadIcon(*finders, request.m_fallbackIconName, request.m_scale, fallbackFinderIndex);
+			fallbackResult = Result { generation, std::move(request.m_fallbackIconName), request.m_scale, std::move(fallbackImage), fallbackFinderIndex };
+		}
+		lock.lock();
 
-		// and try to load it from each ZIP file
-		for (const auto &finder : m_finders)
+		// post the results, unless we already have an event on its way
+		if (generation == m_generation)
 		{
-			// try to get a stream and open it
-			std::unique_ptr<QIODevice> stream = finder->getIconStream(icon_file_name);
-			if (stream && stream->open(QIODevice::ReadOnly))
+			m_results.push_back(Result { generation, std::move(request.m_iconName), request.m_scale, std::move(image), finderIndex });
+			if (fallbackResult)
+				m_results.push_back(std::move(*fallbackResult));
+			if (!m_resultsEventPosted)
 			{
-				// read the bytes
-				QByteArray byteArray = stream->readAll();
-
-				// we've found an entry - try to load the icon; note that while this can
-				// fail, we want to memoize the failure
-				std::optional<QPixmap> icon = LoadIcon(std::move(icon_file_name), byteArray);
-
-				// record the result in the icon map
-				iter = m_icon_map.emplace(icon_name, std::move(icon)).first;
-				break;
+				m_resultsEventPosted = true;
+				QCoreApplication::postEvent(this, new QEvent(s_resultsEventId));
 			}
 		}
 	}
+}
 
-	// if we found (or added) something, return it
-	const QPixmap *result = (iter != m_icon_map.end() && iter->second.has_value())
-		? &*iter->second
-		: nullptr;
-	return result;
+
+//-------------------------------------------------
+//  iconKey - the key in the icon map for a
+//	particular variant of an icon
+//-------------------------------------------------
+
+QString IconLoader::iconKey(const QString &iconName, int scale)
+{
+	return scale == 1
+		? iconName
+		: iconName + "@" + QString::number(scale) + "x";
 }
 
 
 //-------------------------------------------------
-//  LoadIcon
+//  pixmapBytes
 //-------------------------------------------------
 
-std::optional<QPixmap> IconLoader::LoadIcon(QString &&icon_name, const QByteArray &byteArray)
+size_t IconLoader::pixmapBytes(const QPixmap &pixmap)
 {
-	// load the icon into a file
-	QPixmap image;
-	return image.loadFromData(byteArray)
-		? image.scaled(ICON_SIZE_X, ICON_SIZE_Y)
-		: std::optional<QPixmap>();
+	return (size_t)pixmap.width() * pixmap.height() * 4;
+}
+
+
+//-------------------------------------------------
+//  loadIcon - finds and decodes an icon; called
+//	from the worker threads
+//-------------------------------------------------
+
+std::optional<QImage> IconLoader::loadIcon(const FinderList &finders, const QString &iconName, int scale, int &finderIndex)
+{
+	// first determine the real file name
+	QString iconFileName = iconName + ".ico";
+
+	// and try to load it from each path
+	for (finderIndex = 0; finderIndex < (int)finders.size(); finderIndex++)
+	{
+		std::optional<QByteArray> byteArray = finders[finderIndex]->readFile(iconFileName);
+		if (byteArray)
+		{
+			// we've found an entry; .ico files often have several sizes, so use the smallest one
+			// that is at least as large as we want (or failing that, the largest)
+			int size = ICON_SIZE * scale;
+			QBuffer buffer(&*byteArray);
+			QImageReader reader(&buffer);
+			int bestImageNumber = -1;
+			QSize bestSize;
+			for (int i = 0; i < reader.imageCount() && reader.jumpToImage(i); i++)
+			{
+				QSize imageSize = reader.size();
+				bool better = bestImageNumber < 0
+					|| (imageSize.width() >= size
+						? bestSize.width() < size || imageSize.width() < bestSize.width()
+						: bestSize.width() < size && imageSize.width() > bestSize.width());
+				if (better)
+				{
+					bestImageNumber = i;
+					bestSize = imageSize;
+				}
+			}
+
+			// note that while this can fail, we want to memoize the failure; converting here
+			// spares the GUI thread from doing so when it becomes a QPixmap
+			QImage image;
+			if ((bestImageNumber >= 0 && !reader.jumpToImage(bestImageNumber)) || !reader.read(&image))
+				return { };
+			return image.scaled(size, size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation).convertToFormat(IconCache::ICON_FORMAT);
+		}
+	}
+	return { };
 }
@@ -11,39 +11,156 @@
 #ifndef ICONLOADER_H
 #define ICONLOADER_H
 
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QImage>
+#include <QObject>
 #include <QPixmap>
 
-#include <optional>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
+#include "iconcache.h"
 #include "info.h"
 
+class ImageFinder;
 class Preferences;
 
-class IconLoader
+class IconLoader : public QObject
 {
 public:
+	struct Statistics
+	{
+		std::uint64_t	m_hits;				// found in memory
+		std::uint64_t	m_diskHits;			// copied out of the disk cache
+		std::uint64_t	m_misses;			// had to be decoded
+		std::uint64_t	m_evictions;
+		size_t			m_residentBytes;
+		size_t			m_residentCount;
+	};
+
+	static const int ICON_SIZE = 16;							// in device independent pixels
+	static const size_t DEFAULT_BUDGET = 16 * 1024 * 1024;		// bytes
+
 	// ctor / dtor
 	IconLoader(Preferences &prefs);
 	~IconLoader();
 
 	// methods
 	void refreshIcons();
-	const QPixmap &getIcon(const info::machine &machine);
+
+	// icons are rendered for the device pixel ratio of the screen we are on; each ratio gets its
+	// own variant of each icon, rounded up to a whole number; returns whether that changed, in
+	// which case icons on screen should be repainted
+	bool setDevicePixelRatio(qreal devicePixelRatio);
+
+	// returns the icon for a machine; icons are decoded in the background, so if this one is
+	// not ready yet a blank placeholder is returned and pending is set
+	const QPixmap &getIcon(const info::machine &machine, bool &pending);
+
+	// starts loading icons for machines that are likely to come on screen soon; these are
+	// loaded after any icons that are pending, and replace any previous prefetch that has not
+	// been done yet
+	void prefetchIcons(const std::vector<info::machine> &machines);
+
+	// callbacks invoked on the GUI thread when icons that were pending become ready
+	void addIconsLoadedCallback(std::function<void()> &&callback);
+
+	// the number of times we went to the file system looking for icons
+	std::uint64_t probeCount() const;
+
+	// loaded icons are kept in memory up to a budget, after which the least recently used are
+	// dropped; they can be copied out of the disk cache again if needed
+	size_t budget() const							{ return m_budget; }
+	void setBudget(size_t budget);
+	const Statistics &statistics() const			{ return m_statistics; }
+
+	// virtuals
+	virtual bool event(QEvent *event) override;
 
 private:
-	class IconFinder;
-	class DirectoryIconFinder;
-	class ZipIconFinder;
-	
-	Preferences &										m_prefs;
-	std::unordered_map<QString, std::optional<QPixmap>>	m_icon_map;
-	std::vector<std::unique_ptr<IconFinder>>			m_finders;
-	QPixmap												m_blankIcon;
-
-	std::optional<QPixmap> LoadIcon(QString &&icon_name, const QByteArray &byteArray);
-	const QPixmap *getIconByName(const QString &iconName);
+	typedef std::vector<std::unique_ptr<ImageFinder>> FinderList;
+
+	enum class IconStatus
+	{
+		Pending,
+		Loaded,
+		Missing
+	};
+
+	struct Icon
+	{
+		IconStatus						m_status;
+		QPixmap							m_pixmap;
+		std::list<QString>::iterator	m_lruPosition;		// only when loaded
+	};
+
+	struct Request
+	{
+		QString					m_iconName;
+		QString					m_fallbackIconName;		// prefetches only
+		int						m_scale;
+	};
+
+	struct Result
+	{
+		std::uint64_t			m_generation;
+		QString					m_iconName;
+		int						m_scale;
+		std::optional<QImage>	m_image;
+		int						m_finderIndex;
+	};
+
+	Preferences &							m_prefs;
+	std::unordered_map<QString, Icon>		m_iconMap;		// keyed by iconKey()
+	std::list<QString>						m_lru;			// loaded icons, most recently used first
+	size_t									m_budget;
+	Statistics								m_statistics;
+	int										m_scale;
+	std::vector<IconCache::Source>			m_sources;
+	std::map<int, std::unique_ptr<IconCache>>	m_iconCaches;	// keyed by scale
+	QPixmap									m_blankIcon;
+	std::vector<std::function<void()>>		m_iconsLoadedCallbacks;
+	std::uint64_t							m_retiredProbeCount;
+	std::uint64_t							m_lastProbeCount;
+	QElapsedTimer							m_probeTimer;
+
+	// shared with the worker threads
+	std::mutex								m_mutex;
+	std::condition_variable					m_condition;
+	std::shared_ptr<const FinderList>		m_finders;
+	std::uint64_t							m_generation;
+	std::deque<Request>						m_requests;		// most recent at the back
+	std::deque<Request>						m_prefetchRequests;	// nearest first
+	std::vector<Result>						m_results;
+	bool									m_resultsEventPosted;
+	bool									m_exiting;
+	std::vector<std::thread>				m_threads;
+
+	static QEvent::Type						s_resultsEventId;
+
+	const Icon *getIconByName(const QString &iconName);
+	const Icon *findIcon(const QString &iconName, int scale);
+	Icon &addLoadedIcon(QString &&key, QPixmap &&pixmap);
+	void trim();
+	IconCache &iconCache(int scale);
+	void processResults();
+	void logProbes();
+	void threadProc();
+	static QString iconKey(const QString &iconName, int scale);
+	static size_t pixmapBytes(const QPixmap &pixmap);
+	static std::optional<QImage> loadIcon(const FinderList &finders, const QString &iconName, int scale, int &finderIndex);
 };
 
 #endif // ICONLOADER_H
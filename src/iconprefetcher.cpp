@@ -0,0 +1,108 @@
+/***************************************************************************
+
+	iconprefetcher.cpp
+
+	Loads icons for rows that are about to be scrolled into view
+
+***************************************************************************/
+
+#include <QAbstractItemView>
+#include <QAbstractProxyModel>
+#include <QScrollBar>
+
+#include <algorithm>
+
+#include "iconprefetcher.h"
+#include "iconloader.h"
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+IconPrefetcher::IconPrefetcher(QAbstractItemView &view, IconLoader &iconLoader, MachineFunc &&machineFunc)
+	: QObject(&view)
+	, m_view(view)
+	, m_iconLoader(iconLoader)
+	, m_machineFunc(std::move(machineFunc))
+	, m_lookahead(DEFAULT_LOOKAHEAD)
+	, m_lastFirstRow(0)
+{
+	// the range changes when the model is reset or filtered, so between the two of these we
+	// hear about anything that changes what is on screen
+	QScrollBar &scrollBar = *m_view.verticalScrollBar();
+	connect(&scrollBar, &QScrollBar::valueChanged, this, [this](int) { update(); });
+	connect(&scrollBar, &QScrollBar::rangeChanged, this, [this](int, int) { update(); });
+}
+
+
+//-------------------------------------------------
+//  setLookahead
+//-------------------------------------------------
+
+void IconPrefetcher::setLookahead(int lookahead)
+{
+	m_lookahead = std::max(lookahead, 0);
+	update();
+}
+
+
+//-------------------------------------------------
+//  update
+//-------------------------------------------------
+
+void IconPrefetcher::update()
+{
+	QAbstractItemModel *model = m_view.model();
+	int rowCount = model ? model->rowCount() : 0;
+	if (rowCount == 0)
+		return;
+
+	// what is on screen?  the view asks for those icons itself
+	QModelIndex firstIndex = m_view.indexAt(QPoint(0, 0));
+	QModelIndex lastIndex = m_view.indexAt(QPoint(0, m_view.viewport()->height() - 1));
+
+	// in tree views we go by the top level rows, and leave the children of expanded rows to the view
+	while (firstIndex.parent().isValid())
+		firstIndex = firstIndex.parent();
+	while (lastIndex.parent().isValid())
+		lastIndex = lastIndex.parent();
+	int firstRow = firstIndex.isValid() ? firstIndex.row() : 0;
+	int lastRow = lastIndex.isValid() ? lastIndex.row() : rowCount - 1;
+
+	// prefetch what is coming up in the direction we are scrolling, nearest first
+	bool scrollingUp = firstRow < m_lastFirstRow;
+	m_lastFirstRow = firstRow;
+	std::vector<int> rows;
+	if (scrollingUp)
+	{
+		for (int row = firstRow - 1; row >= 0 && row >= firstRow - m_lookahead; row--)
+			rows.push_back(row);
+	}
+	else
+	{
+		for (int row = lastRow + 1; row < rowCount && row <= lastRow + m_lookahead; row++)
+			rows.push_back(row);
+	}
+
+	// map those rows back to machines
+	std::vector<info::machine> machines;
+	machines.reserve(rows.size());
+	for (int row : rows)
+	{
+		QModelIndex index = model->index(row, 0);
+		for (const QAbstractProxyModel *proxyModel = qobject_cast<const QAbstractProxyModel *>(index.model()); proxyModel; proxyModel = qobject_cast<const QAbstractProxyModel *>(index.model()))
+			index = proxyModel->mapToSource(index);
+
+		std::optional<info::machine> machine = m_machineFunc(index);
+		if (machine)
+			machines.push_back(*machine);
+	}
+
+	// this replaces the previous prefetch, abandoning rows that we have scrolled away from
+	m_iconLoader.prefetchIcons(machines);
+}
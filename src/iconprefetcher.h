@@ -0,0 +1,57 @@
+/***************************************************************************
+
+	iconprefetcher.h
+
+	Loads icons for rows that are about to be scrolled into view
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef ICONPREFETCHER_H
+#define ICONPREFETCHER_H
+
+#include <QObject>
+
+#include <functional>
+#include <optional>
+
+#include "info.h"
+
+QT_BEGIN_NAMESPACE
+class QAbstractItemView;
+class QModelIndex;
+QT_END_NAMESPACE
+
+class IconLoader;
+
+
+// ======================> IconPrefetcher
+
+class IconPrefetcher : public QObject
+{
+public:
+	// maps an index in the view's source model to the machine whose icon it shows
+	typedef std::function<std::optional<info::machine>(const QModelIndex &sourceIndex)> MachineFunc;
+
+	static const int DEFAULT_LOOKAHEAD = 64;
+
+	// ctor
+	IconPrefetcher(QAbstractItemView &view, IconLoader &iconLoader, MachineFunc &&machineFunc);
+
+	// the number of rows past the visible ones to prefetch, in the direction of scrolling
+	int lookahead() const			{ return m_lookahead; }
+	void setLookahead(int lookahead);
+
+private:
+	QAbstractItemView &		m_view;
+	IconLoader &			m_iconLoader;
+	MachineFunc				m_machineFunc;
+	int						m_lookahead;
+	int						m_lastFirstRow;
+
+	void update();
+};
+
+
+#endif // ICONPREFETCHER_H
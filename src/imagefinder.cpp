@@ -0,0 +1,198 @@
+/***************************************************************************
+
+	imagefinder.cpp
+
+	Locating image files in directories and zip archives
+
+***************************************************************************/
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include "imagefinder.h"
+#include "quazip/quazipfile.h"
+
+
+//**************************************************************************
+//  IMAGE FINDER
+//**************************************************************************
+
+//-------------------------------------------------
+//  dtor
+//-------------------------------------------------
+
+ImageFinder::~ImageFinder()
+{
+}
+
+
+//-------------------------------------------------
+//  create
+//-------------------------------------------------
+
+std::unique_ptr<ImageFinder> ImageFinder::create(const QString &path)
+{
+	std::unique_ptr<ImageFinder> result;
+	QFileInfo fi(path);
+	if (fi.isDir())
+	{
+		result = std::make_unique<DirectoryImageFinder>(QString(path));
+	}
+	else if (fi.isFile())
+	{
+		auto zipImageFinder = std::make_unique<ZipImageFinder>(path);
+		if (zipImageFinder->open())
+			result = std::move(zipImageFinder);
+	}
+	return result;
+}
+
+
+//**************************************************************************
+//  DIRECTORY IMAGE FINDER
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+DirectoryImageFinder::DirectoryImageFinder(QString &&path)
+{
+	// list the top level once, so that we only go to the file system for images that are
+	// there; most machines do not have icons, and we would otherwise try every path for
+	// each of them (and again for their parents)
+	Directory &root = m_directories[QString()];
+	root.m_path = std::move(path);
+	countProbe();
+	for (QString &fileName : QDir(root.m_path).entryList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot))
+		root.m_entries.emplace(fileName.toLower(), std::move(fileName));
+}
+
+
+//-------------------------------------------------
+//  readFile
+//-------------------------------------------------
+
+std::optional<QByteArray> DirectoryImageFinder::readFile(const QString &fileName)
+{
+	// find the file
+	QString lowerFileName = fileName.toLower();
+	int slashPos = lowerFileName.lastIndexOf('/');
+	QString path;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		const Directory &directory = listDirectory(slashPos >= 0 ? lowerFileName.left(slashPos) : QString());
+		auto iter = directory.m_entries.find(lowerFileName.mid(slashPos + 1));
+		if (iter == directory.m_entries.end())
+			return { };
+		path = directory.m_path + "/" + iter->second;
+	}
+
+	// and read it outside of the lock
+	countProbe();
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly))
+		return { };
+	return file.readAll();
+}
+
+
+//-------------------------------------------------
+//  listDirectory - lists a subdirectory the first
+//	time we look in it; called with the lock held
+//-------------------------------------------------
+
+const DirectoryImageFinder::Directory &DirectoryImageFinder::listDirectory(const QString &subdirectory)
+{
+	// have we already been here?  note that the root is listed by the ctor
+	auto iter = m_directories.find(subdirectory);
+	if (iter != m_directories.end())
+		return iter->second;
+
+	// find the actual name of this directory in its parent
+	int slashPos = subdirectory.lastIndexOf('/');
+	const Directory &parent = listDirectory(slashPos >= 0 ? subdirectory.left(slashPos) : QString());
+	auto parentIter = parent.m_entries.find(subdirectory.mid(slashPos + 1));
+	QString path = parentIter != parent.m_entries.end()
+		? parent.m_path + "/" + parentIter->second
+		: QString();
+
+	// and list it; references to elements of an unordered_map survive insertions
+	Directory &directory = m_directories[subdirectory];
+	if (!path.isEmpty())
+	{
+		countProbe();
+		for (QString &fileName : QDir(path).entryList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot))
+			directory.m_entries.emplace(fileName.toLower(), std::move(fileName));
+		directory.m_path = std::move(path);
+	}
+	return directory;
+}
+
+
+//**************************************************************************
+//  ZIP IMAGE FINDER
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+ZipImageFinder::ZipImageFinder(const QString &path)
+	: m_zip(path)
+{
+}
+
+
+//-------------------------------------------------
+//  open
+//-------------------------------------------------
+
+bool ZipImageFinder::open()
+{
+	countProbe();
+	if (!m_zip.open(QuaZip::Mode::mdUnzip))
+		return false;
+
+	// QuaZip::setCurrentFile() walks the central directory, which for an archive with tens of
+	// thousands of entries is far too slow to do for every lookup (and especially for every
+	// miss), so walk it once and remember where everything is
+	for (bool more = m_zip.goToFirstFile(); more; more = m_zip.goToNextFile())
+	{
+		unz64_file_pos pos;
+		if (unzGetFilePos64(m_zip.getUnzFile(), &pos) == UNZ_OK)
+			m_entries.emplace(m_zip.getCurrentFileName().toLower(), pos);
+	}
+
+	// we position the zip on entries ourselves; this is only here so that QuaZip considers
+	// there to be a current file
+	return m_zip.goToFirstFile();
+}
+
+
+//-------------------------------------------------
+//  readFile
+//-------------------------------------------------
+
+std::optional<QByteArray> ZipImageFinder::readFile(const QString &fileName)
+{
+	// find the file; the index is not modified after open() so this needs no lock
+	auto iter = m_entries.find(fileName.toLower());
+	if (iter == m_entries.end())
+		return { };
+
+	// the zip has a current file, so only one thread can read from it at a time; decoding
+	// what we read is the expensive part, and that happens outside of the lock
+	std::lock_guard<std::mutex> lock(m_mutex);
+	countProbe();
+	unz64_file_pos pos = iter->second;
+	if (unzGoToFilePos64(m_zip.getUnzFile(), &pos) != UNZ_OK)
+		return { };
+
+	// and read it
+	QuaZipFile file(&m_zip);
+	if (!file.open(QIODevice::ReadOnly))
+		return { };
+	return file.readAll();
+}
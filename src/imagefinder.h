@@ -0,0 +1,92 @@
+/***************************************************************************
+
+	imagefinder.h
+
+	Locating image files in directories and zip archives
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef IMAGEFINDER_H
+#define IMAGEFINDER_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+#include "quazip/quazip.h"
+
+
+// ======================> ImageFinder
+class ImageFinder
+{
+public:
+	ImageFinder() = default;
+	ImageFinder(const ImageFinder &) = delete;
+	ImageFinder(ImageFinder &&) = delete;
+	virtual ~ImageFinder();
+
+	// creates a finder for a directory or a zip archive, or returns nullptr if the path is neither
+	static std::unique_ptr<ImageFinder> create(const QString &path);
+
+	// reads a file, looking it up without regard to case; file names can have subdirectories
+	// separated by '/' (e.g. - "nes/smb.png"); this can be called from any thread
+	virtual std::optional<QByteArray> readFile(const QString &fileName) = 0;
+
+	// file system accesses, for instrumentation
+	std::uint64_t probeCount() const { return m_probeCount; }
+
+protected:
+	void countProbe() { m_probeCount++; }
+
+private:
+	std::atomic<std::uint64_t>	m_probeCount = { 0 };
+};
+
+
+// ======================> DirectoryImageFinder
+class DirectoryImageFinder : public ImageFinder
+{
+public:
+	DirectoryImageFinder(QString &&path);
+
+	virtual std::optional<QByteArray> readFile(const QString &fileName) override;
+
+private:
+	struct Directory
+	{
+		QString									m_path;			// empty if it does not exist
+		std::unordered_map<QString, QString>	m_entries;		// lower case to actual
+	};
+
+	std::mutex								m_mutex;
+	std::unordered_map<QString, Directory>	m_directories;	// keyed by lower case subdirectory
+
+	const Directory &listDirectory(const QString &subdirectory);
+};
+
+
+// ======================> ZipImageFinder
+class ZipImageFinder : public ImageFinder
+{
+public:
+	ZipImageFinder(const QString &path);
+
+	bool open();
+	virtual std::optional<QByteArray> readFile(const QString &fileName) override;
+
+private:
+	std::mutex									m_mutex;
+	QuaZip										m_zip;
+	std::unordered_map<QString, unz64_file_pos>	m_entries;
+};
+
+
+#endif // IMAGEFINDER_H
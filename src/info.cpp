@@ -7,6 +7,9 @@
 ***************************************************************************/
 
 #include <assert.h>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
 #include <stdexcept>
 
 #include <QDataStream>
@@ -163,6 +166,9 @@ bool info::database::load(QDataStream &input, const QString &expected_version)
 	m_loaded_strings.clear();
 	m_string_table_offset = string_table_offset;
 
+	// ...and the index of machines by name
+	build_machine_name_index();
+
 	// ...and last but not least set up the version
 	m_version = &get_string(hdr.m_build_strindex);
 
@@ -194,6 +200,7 @@ void info::database::reset()
 	m_ram_options_count = 0;
 	m_string_table_offset = 0;
 	m_loaded_strings.clear();
+	m_machines_by_name.clear();
 	m_version = &util::g_empty_string;
 	on_changed();
 }
@@ -224,7 +231,7 @@ const QString &info::database::get_string(std::uint32_t offset) const
 		return iter->second;
 
 	const char *string = get_string_from_data(m_data, m_string_table_offset, util::safe_static_cast<std::uint32_t>(offset));
-	m_loaded_strings.emplace(offset, QString::fromUtf8(string));
+	m_loaded_strings.emplace(offset, util::from_utf8(string));
 	return m_loaded_strings.find(offset)->second;
 }
 
@@ -235,14 +242,60 @@ const QString &info::database::get_string(std::uint32_t offset) const
 
 std::optional<info::machine> info::database::find_machine(const QString &machine_name) const
 {
-	auto iter = std::find_if(
-		machines().begin(),
-		machines().end(),
-		[&machine_name](const info::machine m)
+	std::optional<std::uint32_t> index = find_machine_index(machine_name);
+	return index
+		? std::optional<info::machine>(machines()[*index])
+		: std::optional<info::machine>();
+}
+
+
+//-------------------------------------------------
+//  database::find_machine_index
+//-------------------------------------------------
+
+std::optional<std::uint32_t> info::database::find_machine_index(const QString &machine_name) const
+{
+	QByteArray machine_name_utf8 = machine_name.toUtf8();
+	auto iter = std::lower_bound(
+		m_machines_by_name.begin(),
+		m_machines_by_name.end(),
+		machine_name_utf8,
+		[this](std::uint32_t index, const QByteArray &name)
 		{
-			return m.name() == machine_name;
+			return strcmp(get_raw_string(machines()[index].name_strindex()), name.constData()) < 0;
+		});
+	return iter != m_machines_by_name.end() && strcmp(get_raw_string(machines()[*iter].name_strindex()), machine_name_utf8.constData()) == 0
+		? std::optional<std::uint32_t>(*iter)
+		: std::optional<std::uint32_t>();
+}
+
+
+//-------------------------------------------------
+//  database::get_raw_string - gets a string as
+//	UTF-8 straight out of the string table
+//-------------------------------------------------
+
+const char *info::database::get_raw_string(std::uint32_t offset) const
+{
+	return get_string_from_data(m_data, m_string_table_offset, offset);
+}
+
+
+//-------------------------------------------------
+//  database::build_machine_name_index - sorts the
+//	machines by name, so that we can look them up
+//	without decoding every name
+//-------------------------------------------------
+
+void info::database::build_machine_name_index()
+{
+	m_machines_by_name.resize(m_machines_count);
+	std::iota(m_machines_by_name.begin(), m_machines_by_name.end(), 0);
+	std::sort(
+		m_machines_by_name.begin(),
+		m_machines_by_name.end(),
+		[this](std::uint32_t a, std::uint32_t b)
+		{
+			return strcmp(get_raw_string(machines()[a].name_strindex()), get_raw_string(machines()[b].name_strindex())) < 0;
 		});
-	return iter != machines().end()
-		? std::optional<info::machine>(*iter)
-		: std::optional<info::machine>();
 }
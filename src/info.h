@@ -276,6 +276,15 @@ namespace info
 		const QString &year() const			{ return get_string(inner().m_year_strindex); }
 		const QString &manufacturer() const	{ return get_string(inner().m_manufacturer_strindex); }
 
+		// string table offsets; strings are interned, so these are equal when the strings are
+		std::uint32_t name_strindex() const			{ return inner().m_name_strindex; }
+		std::uint32_t sourcefile_strindex() const	{ return inner().m_sourcefile_strindex; }
+		std::uint32_t clone_of_strindex() const		{ return inner().m_clone_of_strindex; }
+		std::uint32_t rom_of_strindex() const		{ return inner().m_rom_of_strindex; }
+		std::uint32_t description_strindex() const	{ return inner().m_description_strindex; }
+		std::uint32_t year_strindex() const			{ return inner().m_year_strindex; }
+		std::uint32_t manufacturer_strindex() const	{ return inner().m_manufacturer_strindex; }
+
 		// views
 		device::view 				devices() const;
 		configuration::view			configurations() const;
@@ -312,6 +321,7 @@ namespace info
 		bool load(QDataStream &input, const QString &expected_version = "");
 		void reset();
 		std::optional<machine> find_machine(const QString &machine_name) const;
+		std::optional<std::uint32_t> find_machine_index(const QString &machine_name) const;
 		const QString &version() const			{ return *m_version; }
 		void set_on_changed(std::function<void()> &&on_changed) { m_on_changed = std::move(on_changed); }
 
@@ -345,11 +355,14 @@ namespace info
 		std::uint32_t										m_ram_options_count;
 		size_t												m_string_table_offset;
 		mutable std::unordered_map<std::uint32_t, QString>	m_loaded_strings;
+		std::vector<std::uint32_t>							m_machines_by_name;
 		const QString *									m_version;
 		std::function<void()>								m_on_changed;
 
 		// private functions
 		void on_changed();
+		const char *get_raw_string(std::uint32_t offset) const;
+		void build_machine_name_index();
 	};
 
 	inline device::view					machine::devices() const		{ return db().devices().subview(inner().m_devices_index, inner().m_devices_count); }
@@ -6,6 +6,9 @@
 
 ***************************************************************************/
 
+#include <algorithm>
+#include <thread>
+
 #include "info_builder.h"
 #include "xmlparser.h"
 
@@ -14,14 +17,14 @@
 //  LOCALS
 //**************************************************************************
 
-static const util::enum_parser<info::software_list::status_type> s_status_parser =
+static constexpr auto s_status_parser = util::make_static_enum_parser<info::software_list::status_type>(
 {
 	{ "original", info::software_list::status_type::ORIGINAL, },
 	{ "compatible", info::software_list::status_type::COMPATIBLE }
-};
+});
 
 
-static const util::enum_parser<info::configuration_condition::relation_t> s_relation_parser =
+static constexpr auto s_relation_parser = util::make_static_enum_parser<info::configuration_condition::relation_t>(
 {
 	{ "eq", info::configuration_condition::relation_t::EQ },
 	{ "ne", info::configuration_condition::relation_t::NE },
@@ -29,7 +32,25 @@ static const util::enum_parser<info::configuration_condition::relation_t> s_rela
 	{ "le", info::configuration_condition::relation_t::LE },
 	{ "lt", info::configuration_condition::relation_t::LT },
 	{ "ge", info::configuration_condition::relation_t::GE }
-};
+});
+
+
+//-------------------------------------------------
+//  byte_converter - adapts a parser to a value
+//	stored as a std::uint8_t in the binary format
+//-------------------------------------------------
+
+template<typename T, typename TParser>
+static auto byte_converter(const TParser &parser)
+{
+	return [parser](const char *text, std::uint8_t &value)
+	{
+		T parsed_value;
+		bool result = parser(text, parsed_value);
+		value = (std::uint8_t)parsed_value;
+		return result;
+	};
+}
 
 
 //**************************************************************************
@@ -50,6 +71,39 @@ static std::uint32_t to_uint32(T &&value)
 };
 
 
+//-------------------------------------------------
+//  find_machine_boundary - finds the next point at
+//	or after 'pos' where a machine element starts
+//-------------------------------------------------
+
+static size_t find_machine_boundary(const char *data, size_t size, size_t pos)
+{
+	static const char s_machine_tag[] = "<machine ";
+	const size_t tag_length = sizeof(s_machine_tag) - 1;
+
+	// '<' cannot appear unescaped in attributes or content, so a raw string search
+	// will only ever land on real element starts
+	for (; pos + tag_length <= size; pos++)
+	{
+		if (data[pos] == '<' && !memcmp(&data[pos], s_machine_tag, tag_length))
+			return pos;
+	}
+	return size;
+}
+
+
+//-------------------------------------------------
+//  parse_error_message
+//-------------------------------------------------
+
+static QString parse_error_message(const QString &message, int line)
+{
+	return line > 0
+		? QString("%1 (line %2)").arg(message, QString::number(line))
+		: message;
+}
+
+
 //-------------------------------------------------
 //  process_xml()
 //-------------------------------------------------
@@ -60,48 +114,236 @@ bool info::database_builder::process_xml(QDataStream &input, QString &error_mess
 	assert(m_machines.empty());
 	assert(m_devices.empty());
 
-	// prepare data
-	info::binaries::header header = { 0, };
+	// reserve space and parse
+	reserve_tables(1);
+	std::uint32_t build_strindex = 0;
+	int error_line;
+	if (!parse_xml({ &input }, build_strindex, error_message, error_line))
+	{
+		error_message = parse_error_message(error_message, error_line);
+		return false;
+	}
+
+	// and finish up
+	finalize(build_strindex);
+	error_message.clear();
+	return true;
+}
+
+
+//-------------------------------------------------
+//  process_xml_parallel() - splits spooled -listxml
+//	output at machine boundaries, parses each chunk
+//	on its own thread and merges the results; the
+//	output is identical to process_xml()
+//-------------------------------------------------
+
+bool info::database_builder::process_xml_parallel(const char *data, size_t size, QString &error_message, int chunk_count)
+{
+	static const char s_mame_begin_tag[] = "<mame>";
+	static const char s_mame_end_tag[] = "</mame>";
+
+	// sanity check; ensure we're fresh
+	assert(m_machines.empty());
+	assert(m_devices.empty());
+
+	// determine how many chunks we want
+	if (chunk_count <= 0)
+		chunk_count = std::max((int)std::thread::hardware_concurrency(), 1);
+
+	// identify the body (the machines) and the end of the document
+	size_t body_begin = find_machine_boundary(data, size, 0);
+	size_t body_end = body_begin;
+	for (size_t pos = size; pos > body_begin + sizeof(s_mame_end_tag) - 1; pos--)
+	{
+		if (!memcmp(&data[pos - (sizeof(s_mame_end_tag) - 1)], s_mame_end_tag, sizeof(s_mame_end_tag) - 1))
+		{
+			body_end = pos - (sizeof(s_mame_end_tag) - 1);
+			break;
+		}
+	}
+
+	// if we could not find any machines, or if we only want one chunk, parse serially
+	if (chunk_count == 1 || body_begin >= body_end)
+	{
+		QByteArray byte_array = QByteArray::fromRawData(data, util::safe_static_cast<int>(size));
+		QDataStream input(byte_array);
+		return process_xml(input, error_message);
+	}
 
+	// split the body into chunks, each starting on a machine boundary
+	std::vector<std::pair<size_t, size_t>> chunk_ranges;
+	size_t chunk_begin = body_begin;
+	for (int i = 1; i <= chunk_count && chunk_begin < body_end; i++)
+	{
+		size_t chunk_end = i < chunk_count
+			? std::min(find_machine_boundary(data, body_end, body_begin + (body_end - body_begin) * i / chunk_count), body_end)
+			: body_end;
+		if (chunk_end > chunk_begin)
+		{
+			chunk_ranges.emplace_back(chunk_begin, chunk_end);
+			chunk_begin = chunk_end;
+		}
+	}
+
+	// prepare the partial builders; chunks are parsed straight out of the input, wrapped
+	// in a root element fed separately - the first chunk is preceded by the real document
+	// header so we pick up the build, the others get a synthetic root element
+	struct chunk
+	{
+		size_t				m_begin;
+		size_t				m_end;
+		database_builder	m_builder;
+		std::uint32_t		m_build_strindex;
+		QString				m_error_message;
+		int					m_error_line;
+		bool				m_success;
+	};
+	std::vector<chunk> chunks(chunk_ranges.size());
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		chunks[i].m_begin = i == 0 ? 0 : chunk_ranges[i].first;
+		chunks[i].m_end = chunk_ranges[i].second;
+		chunks[i].m_build_strindex = 0;
+		chunks[i].m_error_line = 0;
+		chunks[i].m_success = false;
+		chunks[i].m_builder.reserve_tables((int)chunks.size());
+	}
+
+	// and parse each chunk on its own thread
+	std::vector<std::thread> threads;
+	threads.reserve(chunks.size());
+	for (chunk &c : chunks)
+	{
+		threads.emplace_back([&c, data]()
+		{
+			QByteArray begin_tag = QByteArray::fromRawData(s_mame_begin_tag, sizeof(s_mame_begin_tag) - 1);
+			QByteArray text = QByteArray::fromRawData(&data[c.m_begin], util::safe_static_cast<int>(c.m_end - c.m_begin));
+			QByteArray end_tag = QByteArray::fromRawData(s_mame_end_tag, sizeof(s_mame_end_tag) - 1);
+			QDataStream begin_tag_input(begin_tag);
+			QDataStream text_input(text);
+			QDataStream end_tag_input(end_tag);
+			c.m_success = c.m_begin == 0
+				? c.m_builder.parse_xml({ &text_input, &end_tag_input }, c.m_build_strindex, c.m_error_message, c.m_error_line)
+				: c.m_builder.parse_xml({ &begin_tag_input, &text_input, &end_tag_input }, c.m_build_strindex, c.m_error_message, c.m_error_line);
+		});
+	}
+	for (std::thread &thread : threads)
+		thread.join();
+
+	// did any chunk fail?  if so, the line is relative to the start of the chunk (the
+	// synthetic root element does not have any line breaks), so we have to count the
+	// lines that came before it
+	for (const chunk &c : chunks)
+	{
+		if (!c.m_success)
+		{
+			int error_line = c.m_error_line > 0
+				? c.m_error_line + (int)std::count(data, &data[c.m_begin], '\n')
+				: 0;
+			error_message = parse_error_message(c.m_error_message, error_line);
+			return false;
+		}
+	}
+
+	// merge the partial results in document order; this interns strings in the same
+	// order that the serial parse does, so the string table comes out identical
+	reserve_tables(1);
+	std::uint32_t build_strindex = 0;
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		std::vector<std::uint32_t> string_map = m_strings.merge(chunks[i].m_builder.m_strings);
+		if (i == 0)
+			build_strindex = string_map[chunks[i].m_build_strindex];
+		chunks[i].m_builder.rebase_strings(string_map);
+		merge(chunks[i].m_builder);
+	}
+
+	// and finish up
+	finalize(build_strindex);
+	error_message.clear();
+	return true;
+}
+
+
+//-------------------------------------------------
+//  reserve_tables
+//-------------------------------------------------
+
+void info::database_builder::reserve_tables(int divisor)
+{
 	// reserve space based on what we know about MAME 0.213
-	m_machines.reserve(40000);					// 36111 machines
-	m_devices.reserve(9000);					// 8211 devices
-	m_configurations.reserve(500000);			// 474840 configurations
-	m_configuration_conditions.reserve(6000);	// 5910 conditions
-	m_configuration_settings.reserve(1500000);	// 1454273 settings
-	m_software_lists.reserve(4200);				// 3977 software lists
-	m_ram_options.reserve(3800);				// 3616 ram options
+	m_machines.reserve(40000 / divisor);					// 36111 machines
+	m_devices.reserve(9000 / divisor);						// 8211 devices
+	m_configurations.reserve(500000 / divisor);				// 474840 configurations
+	m_configuration_conditions.reserve(6000 / divisor);		// 5910 conditions
+	m_configuration_settings.reserve(1500000 / divisor);	// 1454273 settings
+	m_software_lists.reserve(4200 / divisor);				// 3977 software lists
+	m_ram_options.reserve(3800 / divisor);					// 3616 ram options
+}
 
-	// header magic variables
-	header.m_size_header					= sizeof(info::binaries::header);
-	header.m_size_machine					= sizeof(info::binaries::machine);
-	header.m_size_device					= sizeof(info::binaries::device);
-	header.m_size_configuration				= sizeof(info::binaries::configuration);
-	header.m_size_configuration_setting		= sizeof(info::binaries::configuration_setting);
-	header.m_size_configuration_condition	= sizeof(info::binaries::configuration_condition);
-	header.m_size_software_list				= sizeof(info::binaries::software_list);
-	header.m_size_ram_option				= sizeof(info::binaries::ram_option);
+
+//-------------------------------------------------
+//  parse_xml
+//-------------------------------------------------
+
+bool info::database_builder::parse_xml(const std::initializer_list<QDataStream *> &inputs, std::uint32_t &build_strindex, QString &error_message, int &error_line)
+{
+	// converters for attributes stored in the binary format
+	auto strindex_converter = [this](const char *text, std::uint32_t &value)
+	{
+		value = m_strings.get(text);
+		return true;
+	};
+	auto flag_converter = byte_converter<bool>([](const char *text, bool &value) { return XmlParser::ConvertAttribute(text, value); });
+
+	// the attributes we read off of each element, declared once
+	const auto machine_schema = XmlParser::Schema(
+		XmlParser::Bind("name",			&binaries::machine::m_name_strindex,					strindex_converter),
+		XmlParser::Bind("sourcefile",	&binaries::machine::m_sourcefile_strindex,				strindex_converter),
+		XmlParser::Bind("cloneof",		&binaries::machine::m_clone_of_strindex,				strindex_converter),
+		XmlParser::Bind("romof",		&binaries::machine::m_rom_of_strindex,					strindex_converter));
+	const auto configuration_schema = XmlParser::Schema(
+		XmlParser::Bind("name",			&binaries::configuration::m_name_strindex,				strindex_converter),
+		XmlParser::Bind("tag",			&binaries::configuration::m_tag_strindex,				strindex_converter),
+		XmlParser::Bind("mask",			&binaries::configuration::m_mask));
+	const auto configuration_setting_schema = XmlParser::Schema(
+		XmlParser::Bind("name",			&binaries::configuration_setting::m_name_strindex,		strindex_converter),
+		XmlParser::Bind("value",		&binaries::configuration_setting::m_value));
+	const auto configuration_condition_schema = XmlParser::Schema(
+		XmlParser::Bind("tag",			&binaries::configuration_condition::m_tag_strindex,		strindex_converter),
+		XmlParser::Bind("relation",		&binaries::configuration_condition::m_relation,			byte_converter<configuration_condition::relation_t>(s_relation_parser)),
+		XmlParser::Bind("mask",			&binaries::configuration_condition::m_mask),
+		XmlParser::Bind("value",		&binaries::configuration_condition::m_value));
+	const auto device_schema = XmlParser::Schema(
+		XmlParser::Bind("type",			&binaries::device::m_type_strindex,						strindex_converter),
+		XmlParser::Bind("tag",			&binaries::device::m_tag_strindex,						strindex_converter),
+		XmlParser::Bind("interface",	&binaries::device::m_interface_strindex,				strindex_converter),
+		XmlParser::Bind("mandatory",	&binaries::device::m_mandatory,							flag_converter));
+	const auto software_list_schema = XmlParser::Schema(
+		XmlParser::Bind("name",			&binaries::software_list::m_name_strindex,				strindex_converter),
+		XmlParser::Bind("filter",		&binaries::software_list::m_filter_strindex,			strindex_converter),
+		XmlParser::Bind("status",		&binaries::software_list::m_status,						byte_converter<software_list::status_type>(s_status_parser)));
+	const auto ram_option_schema = XmlParser::Schema(
+		XmlParser::Bind("name",			&binaries::ram_option::m_name_strindex,					strindex_converter),
+		XmlParser::Bind("default",		&binaries::ram_option::m_is_default,					flag_converter));
 
 	// parse the -listxml output
 	XmlParser xml;
 	std::string current_device_extensions;
-	xml.OnElementBegin({ "mame" }, [this, &header](const XmlParser::Attributes &attributes)
+	xml.OnElementBegin({ "mame" }, [this, &build_strindex](const XmlParser::Attributes &attributes)
 	{
 		std::string build;
-		header.m_build_strindex = attributes.Get("build", build) ? m_strings.get(build) : 0;		
+		build_strindex = attributes.Get("build", build) ? m_strings.get(build) : 0;
 	});
-	xml.OnElementBegin({ "mame", "machine" }, [this](const XmlParser::Attributes &attributes)
+	xml.OnElementBegin({ "mame", "machine" }, [this, &machine_schema](const XmlParser::Attributes &attributes)
 	{
 		bool runnable;
 		if (attributes.Get("runnable", runnable) && !runnable)
 			return XmlParser::element_result::SKIP;
 
-		std::string data;
 		info::binaries::machine &machine = m_machines.emplace_back();
-		machine.m_name_strindex			= attributes.Get("name", data) ? m_strings.get(data) : 0;
-		machine.m_sourcefile_strindex	= attributes.Get("sourcefile", data) ? m_strings.get(data) : 0;
-		machine.m_clone_of_strindex		= attributes.Get("cloneof", data) ? m_strings.get(data) : 0;
-		machine.m_rom_of_strindex		= attributes.Get("romof", data) ? m_strings.get(data) : 0;
+		machine_schema.Apply(attributes, machine);
 		machine.m_configurations_index	= to_uint32(m_configurations.size());
 		machine.m_configurations_count	= 0;
 		machine.m_software_lists_index	= to_uint32(m_software_lists.size());
@@ -128,49 +370,34 @@ bool info::database_builder::process_xml(QDataStream &input, QString &error_mess
 		util::last(m_machines).m_manufacturer_strindex = m_strings.get(content);
 	});
 	xml.OnElementBegin({ { "mame", "machine", "configuration" },
-						 { "mame", "machine", "dipswitch" } }, [this](const XmlParser::Attributes &attributes)
+						 { "mame", "machine", "dipswitch" } }, [this, &configuration_schema](const XmlParser::Attributes &attributes)
 	{
-		std::string data;
 		info::binaries::configuration &configuration = m_configurations.emplace_back();
-		configuration.m_name_strindex					= attributes.Get("name", data) ? m_strings.get(data) : 0;
-		configuration.m_tag_strindex					= attributes.Get("tag", data) ? m_strings.get(data) : 0;
+		configuration_schema.Apply(attributes, configuration);
 		configuration.m_configuration_settings_index	= to_uint32(m_configuration_settings.size());
 		configuration.m_configuration_settings_count	= 0;
-		attributes.Get("mask", configuration.m_mask);
 	
 		util::last(m_machines).m_configurations_count++;
 	});
 	xml.OnElementBegin({ { "mame", "machine", "configuration", "confsetting" },
-						 { "mame", "machine", "dipswitch", "dipvalue" } }, [this](const XmlParser::Attributes &attributes)
+						 { "mame", "machine", "dipswitch", "dipvalue" } }, [this, &configuration_setting_schema](const XmlParser::Attributes &attributes)
 	{
-		std::string data;
 		info::binaries::configuration_setting &configuration_setting = m_configuration_settings.emplace_back();
-		configuration_setting.m_name_strindex		= attributes.Get("name", data) ? m_strings.get(data) : 0;
+		configuration_setting_schema.Apply(attributes, configuration_setting);
 		configuration_setting.m_conditions_index	= to_uint32(m_configuration_conditions.size());
-		attributes.Get("value", configuration_setting.m_value);
 
 		util::last(m_configurations).m_configuration_settings_count++;
 	});
 	xml.OnElementBegin({ { "mame", "machine", "configuration", "confsetting", "condition" },
-						 { "mame", "machine", "dipswitch", "dipvalue", "condition" } }, [this](const XmlParser::Attributes &attributes)
+						 { "mame", "machine", "dipswitch", "dipvalue", "condition" } }, [this, &configuration_condition_schema](const XmlParser::Attributes &attributes)
 	{
-		std::string data;
 		info::binaries::configuration_condition &configuration_condition = m_configuration_conditions.emplace_back();
-		configuration_condition::relation_t relation;
-		configuration_condition.m_tag_strindex			= attributes.Get("tag", data) ? m_strings.get(data) : 0;
-		configuration_condition.m_relation				= (uint8_t)(attributes.Get("relation", relation, s_relation_parser) ? relation : info::configuration_condition::relation_t::UNKNOWN);
-		attributes.Get("mask", configuration_condition.m_mask);
-		attributes.Get("value", configuration_condition.m_value);
+		configuration_condition_schema.Apply(attributes, configuration_condition);
 	});
-	xml.OnElementBegin({ "mame", "machine", "device" }, [this, &current_device_extensions](const XmlParser::Attributes &attributes)
+	xml.OnElementBegin({ "mame", "machine", "device" }, [this, &device_schema, &current_device_extensions](const XmlParser::Attributes &attributes)
 	{
-		std::string data;
-		bool mandatory;
 		info::binaries::device &device = m_devices.emplace_back();
-		device.m_type_strindex			= attributes.Get("type", data) ? m_strings.get(data) : 0;
-		device.m_tag_strindex			= attributes.Get("tag", data) ? m_strings.get(data) : 0;
-		device.m_interface_strindex		= attributes.Get("interface", data) ? m_strings.get(data) : 0;
-		device.m_mandatory				= attributes.Get("mandatory", mandatory) && mandatory ? 1 : 0;
+		device_schema.Apply(attributes, device);
 		device.m_instance_name_strindex	= 0;
 		device.m_extensions_strindex	= 0;
 
@@ -198,23 +425,16 @@ bool info::database_builder::process_xml(QDataStream &input, QString &error_mess
 		if (!current_device_extensions.empty())
 			util::last(m_devices).m_extensions_strindex = m_strings.get(current_device_extensions);
 	});
-	xml.OnElementBegin({ "mame", "machine", "softwarelist" }, [this](const XmlParser::Attributes &attributes)
+	xml.OnElementBegin({ "mame", "machine", "softwarelist" }, [this, &software_list_schema](const XmlParser::Attributes &attributes)
 	{
-		std::string data;
-		info::software_list::status_type status;
 		info::binaries::software_list &software_list = m_software_lists.emplace_back();
-		software_list.m_name_strindex			= attributes.Get("name", data) ? m_strings.get(data) : 0;
-		software_list.m_filter_strindex			= attributes.Get("filter", data) ? m_strings.get(data) : 0;
-		software_list.m_status					= (uint8_t) (attributes.Get("status", status, s_status_parser) ? status : info::software_list::status_type::ORIGINAL);
+		software_list_schema.Apply(attributes, software_list);
 		util::last(m_machines).m_software_lists_count++;
 	});
-	xml.OnElementBegin({ "mame", "machine", "ramoption" }, [this](const XmlParser::Attributes &attributes)
+	xml.OnElementBegin({ "mame", "machine", "ramoption" }, [this, &ram_option_schema](const XmlParser::Attributes &attributes)
 	{
-		std::string data;
-		bool b;
 		info::binaries::ram_option &ram_option = m_ram_options.emplace_back();
-		ram_option.m_name_strindex				= attributes.Get("name", data) ? m_strings.get(data) : 0;
-		ram_option.m_is_default					= attributes.Get("default", b) && b;
+		ram_option_schema.Apply(attributes, ram_option);
 		ram_option.m_value						= 0;
 		util::last(m_machines).m_ram_options_count++;
 	});
@@ -229,12 +449,13 @@ bool info::database_builder::process_xml(QDataStream &input, QString &error_mess
 	bool success;
 	try
 	{
-		success = xml.Parse(input);
+		success = xml.Parse(inputs);
 	}
 	catch (std::exception &ex)
 	{
 		// did an exception (probably thrown by to_uint32) get thrown?
 		error_message = ex.what();
+		error_line = xml.ErrorLineNumber();
 		return false;
 	}
 	if (!success)
@@ -242,8 +463,130 @@ bool info::database_builder::process_xml(QDataStream &input, QString &error_mess
 		// now check for XML parsing errors; this is likely the result of somebody aborting the DB rebuild, but
 		// it is the caller's responsibility to handle that situation
 		error_message = xml.ErrorMessage();
+		error_line = xml.ErrorLineNumber();
 		return false;
 	}
+	return true;
+}
+
+
+//-------------------------------------------------
+//  rebase_strings - translates string indices of a
+//	partial build into the merged string table
+//-------------------------------------------------
+
+void info::database_builder::rebase_strings(const std::vector<std::uint32_t> &string_map)
+{
+	auto rebase = [&string_map](std::uint32_t &strindex)
+	{
+		strindex = string_map[strindex];
+	};
+
+	for (info::binaries::machine &machine : m_machines)
+	{
+		rebase(machine.m_name_strindex);
+		rebase(machine.m_sourcefile_strindex);
+		rebase(machine.m_clone_of_strindex);
+		rebase(machine.m_rom_of_strindex);
+		rebase(machine.m_description_strindex);
+		rebase(machine.m_year_strindex);
+		rebase(machine.m_manufacturer_strindex);
+	}
+	for (info::binaries::device &device : m_devices)
+	{
+		rebase(device.m_type_strindex);
+		rebase(device.m_tag_strindex);
+		rebase(device.m_interface_strindex);
+		rebase(device.m_instance_name_strindex);
+		rebase(device.m_extensions_strindex);
+	}
+	for (info::binaries::configuration &configuration : m_configurations)
+	{
+		rebase(configuration.m_name_strindex);
+		rebase(configuration.m_tag_strindex);
+	}
+	for (info::binaries::configuration_condition &configuration_condition : m_configuration_conditions)
+		rebase(configuration_condition.m_tag_strindex);
+	for (info::binaries::configuration_setting &configuration_setting : m_configuration_settings)
+		rebase(configuration_setting.m_name_strindex);
+	for (info::binaries::software_list &software_list : m_software_lists)
+	{
+		rebase(software_list.m_name_strindex);
+		rebase(software_list.m_filter_strindex);
+	}
+	for (info::binaries::ram_option &ram_option : m_ram_options)
+		rebase(ram_option.m_name_strindex);
+}
+
+
+//-------------------------------------------------
+//  merge - appends the tables of a partial build
+//	(whose strings have already been rebased),
+//	rebasing table indices as we go
+//-------------------------------------------------
+
+template<typename T>
+static void append_table(std::vector<T> &dest, const std::vector<T> &src)
+{
+	dest.insert(dest.end(), src.begin(), src.end());
+}
+
+
+void info::database_builder::merge(const database_builder &partial)
+{
+	// determine the base indices
+	std::uint32_t devices_base					= to_uint32(m_devices.size());
+	std::uint32_t configurations_base			= to_uint32(m_configurations.size());
+	std::uint32_t configuration_settings_base	= to_uint32(m_configuration_settings.size());
+	std::uint32_t configuration_conditions_base	= to_uint32(m_configuration_conditions.size());
+	std::uint32_t software_lists_base			= to_uint32(m_software_lists.size());
+	std::uint32_t ram_options_base				= to_uint32(m_ram_options.size());
+	size_t machines_begin						= m_machines.size();
+	size_t configurations_begin					= m_configurations.size();
+	size_t configuration_settings_begin			= m_configuration_settings.size();
+
+	// append the tables
+	append_table(m_machines,					partial.m_machines);
+	append_table(m_devices,						partial.m_devices);
+	append_table(m_configurations,				partial.m_configurations);
+	append_table(m_configuration_settings,		partial.m_configuration_settings);
+	append_table(m_configuration_conditions,	partial.m_configuration_conditions);
+	append_table(m_software_lists,				partial.m_software_lists);
+	append_table(m_ram_options,					partial.m_ram_options);
+
+	// and rebase the indices within the appended entries
+	for (size_t i = machines_begin; i < m_machines.size(); i++)
+	{
+		m_machines[i].m_configurations_index	+= configurations_base;
+		m_machines[i].m_software_lists_index	+= software_lists_base;
+		m_machines[i].m_ram_options_index		+= ram_options_base;
+		m_machines[i].m_devices_index			+= devices_base;
+	}
+	for (size_t i = configurations_begin; i < m_configurations.size(); i++)
+		m_configurations[i].m_configuration_settings_index += configuration_settings_base;
+	for (size_t i = configuration_settings_begin; i < m_configuration_settings.size(); i++)
+		m_configuration_settings[i].m_conditions_index += configuration_conditions_base;
+}
+
+
+//-------------------------------------------------
+//  finalize
+//-------------------------------------------------
+
+void info::database_builder::finalize(std::uint32_t build_strindex)
+{
+	info::binaries::header header = { 0, };
+
+	// header magic variables
+	header.m_size_header					= sizeof(info::binaries::header);
+	header.m_size_machine					= sizeof(info::binaries::machine);
+	header.m_size_device					= sizeof(info::binaries::device);
+	header.m_size_configuration				= sizeof(info::binaries::configuration);
+	header.m_size_configuration_setting		= sizeof(info::binaries::configuration_setting);
+	header.m_size_configuration_condition	= sizeof(info::binaries::configuration_condition);
+	header.m_size_software_list				= sizeof(info::binaries::software_list);
+	header.m_size_ram_option				= sizeof(info::binaries::ram_option);
+	header.m_build_strindex					= build_strindex;
 
 	// final magic bytes on string table
 	m_strings.embed_value(info::binaries::MAGIC_STRINGTABLE_END);
@@ -259,10 +602,6 @@ bool info::database_builder::process_xml(QDataStream &input, QString &error_mess
 
 	// and salt it
 	m_salted_header = util::salt(header, info::binaries::salt());
-
-	// success!
-	error_message.clear();
-	return true;
 }
 
 
@@ -339,6 +678,14 @@ std::uint32_t info::database_builder::string_table::get(const QString &s)
 }
 
 
+std::uint32_t info::database_builder::string_table::get(const char *s)
+{
+	// reuse the lookup key buffer to avoid an allocation per attribute
+	m_lookup_key.assign(s);
+	return get(m_lookup_key);
+}
+
+
 //-------------------------------------------------
 //  string_table::data
 //-------------------------------------------------
@@ -347,3 +694,27 @@ const std::vector<char> &info::database_builder::string_table::data() const
 {
 	return m_data;
 }
+
+
+//-------------------------------------------------
+//  string_table::merge - interns all strings from
+//	another table (in the order that they were
+//	added), returning a map of old offsets to new
+//-------------------------------------------------
+
+std::vector<std::uint32_t> info::database_builder::string_table::merge(const string_table &that)
+{
+	std::vector<std::uint32_t> result;
+	result.resize(that.m_data.size(), 0);
+
+	// skip past the empty string and the initial magic bytes
+	size_t pos = 1 + sizeof(info::binaries::MAGIC_STRINGTABLE_BEGIN);
+	while (pos < that.m_data.size())
+	{
+		const char *s = &that.m_data[pos];
+		size_t length = strlen(s);
+		result[pos] = get(std::string(s, length));
+		pos += length + 1;
+	}
+	return result;
+}
@@ -28,6 +28,7 @@ namespace info
 
 		// methods
 		bool process_xml(QDataStream &input, QString &error_message);
+		bool process_xml_parallel(const char *data, size_t size, QString &error_message, int chunk_count = 0);
 		void emit_info(QDataStream &stream) const;
 
 	private:
@@ -38,7 +39,9 @@ namespace info
 			string_table();
 			std::uint32_t get(const std::string &string);
 			std::uint32_t get(const QString &string);
+			std::uint32_t get(const char *string);
 			const std::vector<char> &data() const;
+			std::vector<std::uint32_t> merge(const string_table &that);
 
 			template<typename T> void embed_value(T value)
 			{
@@ -49,6 +52,7 @@ namespace info
 		private:
 			std::vector<char>								m_data;
 			std::unordered_map<std::string, std::uint32_t>	m_map;
+			std::string										m_lookup_key;
 		};
 
 		info::binaries::header									m_salted_header;
@@ -60,6 +64,12 @@ namespace info
 		std::vector<info::binaries::software_list>				m_software_lists;
 		std::vector<info::binaries::ram_option>					m_ram_options;
 		string_table											m_strings;
+
+		void reserve_tables(int divisor);
+		bool parse_xml(const std::initializer_list<QDataStream *> &inputs, std::uint32_t &build_strindex, QString &error_message, int &error_line);
+		void rebase_strings(const std::vector<std::uint32_t> &string_map);
+		void merge(const database_builder &partial);
+		void finalize(std::uint32_t build_strindex);
 	};
 };
 
@@ -8,7 +8,9 @@
 
 #include <unordered_map>
 #include <exception>
+#include <thread>
 #include <QCoreApplication>
+#include <QTemporaryFile>
 
 #include "listxmltask.h"
 #include "xmlparser.h"
@@ -39,6 +41,7 @@ namespace
 		volatile bool	m_aborted;
 
 		void internalProcess(QProcess &process);
+		bool processXmlSpooled(QProcess &process, info::database_builder &builder, QString &error_message);
 	};
 
 	// ======================> list_xml_exception
@@ -132,10 +135,19 @@ void ListXmlTask::internalProcess(QProcess &process)
 {
 	info::database_builder builder;
 
-	// first process the XML
-	QDataStream input(&process);
+	// first process the XML; if we have multiple cores we spool MAME's output so that
+	// we can parse it in parallel, otherwise we stream it directly into the parser
 	QString error_message;
-	bool success = builder.process_xml(input, error_message);
+	bool success;
+	if (std::thread::hardware_concurrency() > 1)
+	{
+		success = processXmlSpooled(process, builder, error_message);
+	}
+	else
+	{
+		QDataStream input(&process);
+		success = builder.process_xml(input, error_message);
+	}
 
 	// before we check to see if there is a parsing error, check for an abort - under which
 	// scenario a parsing error is expected
@@ -161,6 +173,46 @@ void ListXmlTask::internalProcess(QProcess &process)
 }
 
 
+//-------------------------------------------------
+//  processXmlSpooled
+//-------------------------------------------------
+
+bool ListXmlTask::processXmlSpooled(QProcess &process, info::database_builder &builder, QString &error_message)
+{
+	// open up a temporary file to spool into
+	QTemporaryFile spool_file;
+	if (!spool_file.open())
+		throw list_xml_exception(ListXmlResultEvent::Status::ERROR, QString("Could not create temporary file: %1").arg(spool_file.fileName()));
+
+	// and spool MAME's output
+	char buffer[65536];
+	bool done = false;
+	while (!done)
+	{
+		// like XmlParser::internalParse(), we treat any non-positive result as the end
+		process.waitForReadyRead(-1);
+		qint64 bytes_read = process.read(buffer, sizeof(buffer));
+		done = bytes_read <= 0;
+		if (!done && spool_file.write(buffer, bytes_read) != bytes_read)
+			throw list_xml_exception(ListXmlResultEvent::Status::ERROR, QString("Could not write to temporary file: %1").arg(spool_file.fileName()));
+	}
+
+	// if we've been aborted, don't bother parsing
+	if (m_aborted)
+		return false;
+
+	// map the spooled file and parse it
+	qint64 size = spool_file.size();
+	const uchar *data = size > 0 ? spool_file.map(0, size) : nullptr;
+	if (!data)
+	{
+		error_message = "Could not map temporary file";
+		return false;
+	}
+	return builder.process_xml_parallel((const char *)data, util::safe_static_cast<size_t>(size), error_message);
+}
+
+
 //-------------------------------------------------
 //  ListXmlResultEvent ctor
 //-------------------------------------------------
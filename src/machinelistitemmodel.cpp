@@ -6,6 +6,10 @@
 
 ***************************************************************************/
 
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+
 #include "machinelistitemmodel.h"
 #include "iconloader.h"
 #include "utility.h"
@@ -23,8 +27,27 @@ MachineListItemModel::MachineListItemModel(QObject *parent, info::database &info
     m_infoDb.set_on_changed([this]
     {
         beginResetModel();
+        m_pendingIconRows.clear();
+        updateParentRows();
         endResetModel();
     });
+    updateParentRows();
+    m_iconLoader.addIconsLoadedCallback([this]
+    {
+        iconsLoaded();
+    });
+}
+
+
+//-------------------------------------------------
+//  setSoftwareIndex
+//-------------------------------------------------
+
+void MachineListItemModel::setSoftwareIndex(software_index::ptr &&softwareIndex)
+{
+    // nothing that is shown comes from the index, so there is nothing to reset; filters that use
+    // it have to be compiled again to pick it up (see SortFilterProxyModel::refilter())
+    m_softwareIndex = std::move(softwareIndex);
 }
 
 
@@ -104,7 +127,12 @@ QVariant MachineListItemModel::data(const QModelIndex &index, int role) const
 
         case Qt::DecorationRole:
             if (column == Column::Machine)
-                result = m_iconLoader.getIcon(machine);
+            {
+                bool pending;
+                result = m_iconLoader.getIcon(machine, pending);
+                if (pending)
+                    m_pendingIconRows.push_back(index.row());
+            }
             break;
         }
     }
@@ -112,6 +140,207 @@ QVariant MachineListItemModel::data(const QModelIndex &index, int role) const
 }
 
 
+//-------------------------------------------------
+//  cellText - the text of a cell, straight out of
+//	the info DB
+//-------------------------------------------------
+
+QString MachineListItemModel::cellText(int row, int column) const
+{
+    info::machine machine = m_infoDb.machines()[row];
+    switch ((Column)column)
+    {
+    case Column::Machine:
+        return machine.name();
+    case Column::Description:
+        return machine.description();
+    case Column::Year:
+        return machine.year();
+    case Column::Manufacturer:
+        return machine.manufacturer();
+    default:
+        return QString();
+    }
+}
+
+
+//-------------------------------------------------
+//  compileFilterTerm - fields are matched against
+//	the info DB, by string table offset where we
+//	can, and otherwise once per distinct string
+//-------------------------------------------------
+
+std::function<bool(int row)> MachineListItemModel::compileFilterTerm(const SearchQuery::Term &term) const
+{
+    typedef std::uint32_t (info::machine::*StrindexAccessor)() const;
+    typedef const QString &(info::machine::*TextAccessor)() const;
+
+    // plain text is up to the proxy
+    if (term.m_field.isEmpty())
+        return { };
+
+    // flags are "is:flag"; there are no others yet
+    if (term.m_field == "is")
+    {
+        if (term.m_text == "clone")
+        {
+            return [this](int row)
+            {
+                return m_infoDb.machines()[row].clone_of_strindex() != 0;
+            };
+        }
+        return [](int row) { return false; };
+    }
+
+    // fields that name another machine only ever match exactly
+    StrindexAccessor machineNameAccessor = term.m_field == "cloneof"
+        ? &info::machine::clone_of_strindex
+        : term.m_field == "romof"
+            ? &info::machine::rom_of_strindex
+            : nullptr;
+    if (machineNameAccessor)
+    {
+        std::optional<info::machine> machine = m_infoDb.find_machine(term.m_text);
+        if (!machine)
+            return [](int row) { return false; };
+        return [this, machineNameAccessor, strindex{ machine->name_strindex() }](int row)
+        {
+            return (m_infoDb.machines()[row].*machineNameAccessor)() == strindex;
+        };
+    }
+
+    // software matches the machines that can run software matching the text; until the index is
+    // built, nothing does
+    if (term.m_field == "software")
+    {
+        auto compatible = std::make_shared<std::vector<bool>>(m_infoDb.machines().size(), false);
+        if (m_softwareIndex)
+        {
+            for (info::machine machine : software_index::compatible_machines(m_infoDb, m_softwareIndex->search(term.m_text)))
+            {
+                std::optional<std::uint32_t> index = m_infoDb.find_machine_index(machine.name());
+                if (index)
+                    (*compatible)[*index] = true;
+            }
+        }
+        return [compatible](int row)
+        {
+            return (*compatible)[row];
+        };
+    }
+
+    // everything else is text
+    static const struct
+    {
+        const char *        m_field;
+        StrindexAccessor    m_strindexAccessor;
+        TextAccessor        m_textAccessor;
+    } s_textFields[] =
+    {
+        { "machine",        &info::machine::name_strindex,          &info::machine::name },
+        { "name",           &info::machine::name_strindex,          &info::machine::name },
+        { "description",    &info::machine::description_strindex,   &info::machine::description },
+        { "year",           &info::machine::year_strindex,          &info::machine::year },
+        { "manufacturer",   &info::machine::manufacturer_strindex,  &info::machine::manufacturer },
+        { "source",         &info::machine::sourcefile_strindex,    &info::machine::sourcefile },
+        { "sourcefile",     &info::machine::sourcefile_strindex,    &info::machine::sourcefile }
+    };
+    auto iter = std::find_if(std::begin(s_textFields), std::end(s_textFields), [&term](const auto &field)
+    {
+        return term.m_field == field.m_field;
+    });
+    if (iter == std::end(s_textFields))
+        return { };
+
+    // there are far fewer distinct manufacturers, years and source files than there are machines,
+    // so remember how each string went
+    auto results = std::make_shared<std::unordered_map<std::uint32_t, bool>>();
+    return [this, term, strindexAccessor{ iter->m_strindexAccessor }, textAccessor{ iter->m_textAccessor }, results](int row)
+    {
+        info::machine machine = m_infoDb.machines()[row];
+        std::uint32_t strindex = (machine.*strindexAccessor)();
+        auto resultIter = results->find(strindex);
+        if (resultIter == results->end())
+            resultIter = results->emplace(strindex, term.matches((machine.*textAccessor)())).first;
+        return resultIter->second;
+    };
+}
+
+
+//-------------------------------------------------
+//  findRowByKey - rows are machines in info DB
+//	order, so the info DB's name index does this
+//-------------------------------------------------
+
+int MachineListItemModel::findRowByKey(const QString &key) const
+{
+    std::optional<std::uint32_t> index = m_infoDb.find_machine_index(key);
+    return index ? util::safe_static_cast<int>(*index) : -1;
+}
+
+
+//-------------------------------------------------
+//  parentRow - in tree mode, clones are shown
+//	under the machine that they are a clone of
+//-------------------------------------------------
+
+int MachineListItemModel::parentRow(int row) const
+{
+    return row < (int)m_parentRows.size()
+        ? m_parentRows[row]
+        : -1;
+}
+
+
+//-------------------------------------------------
+//  updateParentRows - works out which machine each
+//	is a clone of up front, so that building the
+//	tree does not involve looking up names
+//-------------------------------------------------
+
+void MachineListItemModel::updateParentRows()
+{
+    auto machines = m_infoDb.machines();
+    m_parentRows.assign(machines.size(), -1);
+    for (std::uint32_t i = 0; i < machines.size(); i++)
+    {
+        info::machine machine = machines[i];
+        if (machine.clone_of_strindex() != 0)
+        {
+            // MAME does not have clones of clones, but parents have to be top level so make sure
+            std::optional<std::uint32_t> parentIndex = m_infoDb.find_machine_index(machine.clone_of());
+            if (parentIndex && *parentIndex != i && machines[*parentIndex].clone_of_strindex() == 0)
+                m_parentRows[i] = util::safe_static_cast<int>(*parentIndex);
+        }
+    }
+}
+
+
+//-------------------------------------------------
+//  iconsLoaded - notifies views of rows whose
+//	icons were pending; those that are still
+//	pending will ask again when they are repainted
+//-------------------------------------------------
+
+void MachineListItemModel::iconsLoaded()
+{
+    std::vector<int> rows = std::move(m_pendingIconRows);
+    m_pendingIconRows.clear();
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    // coalesce contiguous rows; these are usually whatever is on screen
+    for (auto iter = rows.begin(); iter != rows.end(); )
+    {
+        auto end = iter + 1;
+        while (end != rows.end() && *end == *(end - 1) + 1)
+            end++;
+        emit dataChanged(index(*iter, (int)Column::Machine, QModelIndex()), index(*(end - 1), (int)Column::Machine, QModelIndex()), { Qt::DecorationRole });
+        iter = end;
+    }
+}
+
+
 //-------------------------------------------------
 //  headerData
 //-------------------------------------------------
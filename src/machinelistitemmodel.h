@@ -11,14 +11,19 @@
 
 #include <QAbstractItemModel>
 
+#include <vector>
+
 #include "info.h"
+#include "softwareindex.h"
+#include "sortfilterproxymodel.h"
+#include "tableviewmanager.h"
 
 class IconLoader;
 
 
 // ======================> MachineListItemModel
 
-class MachineListItemModel : public QAbstractItemModel
+class MachineListItemModel : public QAbstractItemModel, public SortFilterProxyModel::ITextSource, public TableViewManager::IKeySource
 {
 public:
 	enum class Column
@@ -32,6 +37,10 @@ public:
 
 	MachineListItemModel(QObject *parent, info::database &infoDb, IconLoader &iconLoader);
 
+	// the index across every software list, which "software:" in the search box looks in; the
+	// proxy has to refilter for this to take effect
+	void setSoftwareIndex(software_index::ptr &&softwareIndex);
+
 	// virtuals
 	virtual QModelIndex index(int row, int column, const QModelIndex &parent) const override;
 	virtual QModelIndex parent(const QModelIndex &child) const override;
@@ -39,10 +48,20 @@ public:
 	virtual int columnCount(const QModelIndex &parent) const override;
 	virtual QVariant data(const QModelIndex &index, int role) const override;
 	virtual QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+	virtual QString cellText(int row, int column) const override;
+	virtual std::function<bool(int row)> compileFilterTerm(const SearchQuery::Term &term) const override;
+	virtual int findRowByKey(const QString &key) const override;
+	virtual int parentRow(int row) const override;
 
 private:
-	info::database &	m_infoDb;
-	IconLoader &		m_iconLoader;
+	info::database &			m_infoDb;
+	IconLoader &				m_iconLoader;
+	mutable std::vector<int>	m_pendingIconRows;
+	software_index::ptr			m_softwareIndex;
+	std::vector<int>			m_parentRows;		// the machine that each is a clone of, or -1
+
+	void updateParentRows();
+	void iconsLoaded();
 };
 
 #endif // MACHINELISTITEMMODEL_H
@@ -15,18 +15,20 @@
 #include <QUrl>
 #include <QCloseEvent>
 #include <QFileDialog>
-#include <QSortFilterProxyModel>
 #include <QTextStream>
+#include <QWindow>
 
 #include "mainwindow.h"
 #include "mameversion.h"
 #include "ui_mainwindow.h"
+#include "iconprefetcher.h"
 #include "machinelistitemmodel.h"
 #include "softwarelistitemmodel.h"
 #include "profilelistitemmodel.h"
 #include "tableviewmanager.h"
 #include "listxmltask.h"
 #include "runmachinetask.h"
+#include "sortfilterproxymodel.h"
 #include "versiontask.h"
 #include "utility.h"
 #include "dialogs/about.h"
@@ -579,11 +581,16 @@ static const int SOUND_ATTENUATION_ON = 0;
 MainWindow::MainWindow(QWidget *parent)
 	: QMainWindow(parent)
 	, m_client(*this, m_prefs)
+	, m_machineListItemModel(nullptr)
 	, m_softwareListItemModel(nullptr)
 	, m_profileListItemModel(nullptr)
 	, m_pinging(false)
 	, m_current_pauser(nullptr)
+	, m_softwareListLoader(*this)
 	, m_icon_loader(m_prefs)
+	, m_previewLoader(m_prefs)
+	, m_previewType(PreviewLoader::Type::Snapshot)
+	, m_softwareIndexGeneration(0)
 {
 	// set up Qt form
 	m_ui = std::make_unique<Ui::MainWindow>();
@@ -591,15 +598,21 @@ MainWindow::MainWindow(QWidget *parent)
 
 	// initial preferences read
 	m_prefs.Load();
+	software_list_cache::global().set_budget((size_t)m_prefs.GetSoftwareListCacheSize() * 1024 * 1024);
 
 	// set up machines view
-	QAbstractItemModel &machineListItemModel = *new MachineListItemModel(this, m_info_db, m_icon_loader);
+	m_machineListItemModel = new MachineListItemModel(this, m_info_db, m_icon_loader);
 	TableViewManager::setup(
-		*m_ui->machinesTableView,
-		machineListItemModel,
+		*m_ui->machinesTreeView,
+		*m_machineListItemModel,
 		m_ui->machinesSearchBox,
 		m_prefs,
 		s_machineListTableViewDesc);
+	new IconPrefetcher(*m_ui->machinesTreeView, m_icon_loader, [this](const QModelIndex &index)
+	{
+		return std::optional<info::machine>(m_info_db.machines()[index.row()]);
+	});
+	m_ui->machinesGroupClonesCheckBox->setChecked(m_prefs.GetGroupClones());
 
 	// set up software list view
 	m_softwareListItemModel = new SoftwareListItemModel(this);
@@ -618,8 +631,27 @@ MainWindow::MainWindow(QWidget *parent)
 		nullptr,
 		m_prefs,
 		s_profileListTableViewDesc);
+	new IconPrefetcher(*m_ui->profilesTableView, m_icon_loader, [this](const QModelIndex &index)
+	{
+		return m_info_db.find_machine(m_profileListItemModel->getProfileByIndex(index.row()).machine());
+	});
 	m_profileListItemModel->refresh(true, true);
 
+	// set up the preview pane; previews are decoded in the background, and the pane is only told
+	// about them when they are ready, so moving through the lists is never held up by them
+	m_ui->previewSplitter->setStretchFactor(0, 1);
+	m_ui->previewSplitter->setStretchFactor(1, 0);
+	m_previewLoader.setPreviewLoadedCallback([this]() { updatePreview(); });
+	m_ui->previewPane->setOnClicked([this]()
+	{
+		m_previewType = m_previewType == PreviewLoader::Type::Snapshot
+			? PreviewLoader::Type::Title
+			: PreviewLoader::Type::Snapshot;
+		updatePreview();
+	});
+	for (QAbstractItemView *view : std::initializer_list<QAbstractItemView *>{ m_ui->machinesTreeView, m_ui->softwareTableView, m_ui->profilesTableView })
+		connect(view->selectionModel(), &QItemSelectionModel::currentRowChanged, this, [this]() { updatePreview(); });
+
 	// set up the ping timer
 	QTimer &pingTimer = *new QTimer(this);
 	connect(&pingTimer, &QTimer::timeout, this, &MainWindow::InvokePing);
@@ -628,6 +660,7 @@ MainWindow::MainWindow(QWidget *parent)
 	// setup properties that pertain to runtime behavior
 	setupPropSyncAspect((QWidget &) *m_ui->tabWidget,			&QWidget::isEnabled,	&QWidget::setEnabled,		{ },								false);
 	setupPropSyncAspect((QWidget &) *m_ui->tabWidget,			&QWidget::isHidden,		&QWidget::setHidden,		{ },								true);
+	setupPropSyncAspect((QWidget &) *m_ui->previewPane,			&QWidget::isHidden,		&QWidget::setHidden,		{ },								true);
 	setupPropSyncAspect(*m_ui->rootWidget,						&QWidget::isHidden,		&QWidget::setHidden,		{ },								[this]() { return !AttachToRootPanel(); });
 	setupPropSyncAspect((QWidget &) *this,						&QWidget::windowTitle,	&QWidget::setWindowTitle,	&status::state::paused,				[this]() { return getTitleBarText(); });
 
@@ -705,6 +738,13 @@ MainWindow::MainWindow(QWidget *parent)
 MainWindow::~MainWindow()
 {
 	m_prefs.Save();
+
+	// software index builds post to us when they are done, so see them off first
+	m_softwareIndexGeneration++;
+	for (std::future<software_index::ptr> &future : m_supersededSoftwareIndexFutures)
+		future.wait();
+	if (m_softwareIndexFuture.valid())
+		m_softwareIndexFuture.wait();
 }
 
 
@@ -1161,6 +1201,17 @@ void MainWindow::on_actionPaths_triggered()
 	{
 		m_icon_loader.refreshIcons();
 	}
+
+	// did the user change the snapshots or titles path?
+	if (is_changed(Preferences::global_path_type::SNAPSHOTS) || is_changed(Preferences::global_path_type::TITLES))
+	{
+		m_previewLoader.refreshPaths();
+		updatePreview();
+	}
+
+	// did the user change the hash path?
+	if (is_changed(Preferences::global_path_type::HASH))
+		buildSoftwareIndex(true);
 }
 
 
@@ -1196,10 +1247,10 @@ void MainWindow::on_actionBletchMameWebSite_triggered()
 
 
 //-------------------------------------------------
-//  on_machinesTableView_activated
+//  on_machinesTreeView_activated
 //-------------------------------------------------
 
-void MainWindow::on_machinesTableView_activated(const QModelIndex &index)
+void MainWindow::on_machinesTreeView_activated(const QModelIndex &index)
 {
 	// run the machine
 	const info::machine machine = machineFromModelIndex(index);
@@ -1208,12 +1259,25 @@ void MainWindow::on_machinesTableView_activated(const QModelIndex &index)
 
 
 //-------------------------------------------------
-//  on_machinesTableView_customContextMenuRequested
+//  on_machinesTreeView_customContextMenuRequested
+//-------------------------------------------------
+
+void MainWindow::on_machinesTreeView_customContextMenuRequested(const QPoint &pos)
+{
+	LaunchingListContextMenu(m_ui->machinesTreeView->mapToGlobal(pos));
+}
+
+
+//-------------------------------------------------
+//  on_machinesGroupClonesCheckBox_toggled
 //-------------------------------------------------
 
-void MainWindow::on_machinesTableView_customContextMenuRequested(const QPoint &pos)
+void MainWindow::on_machinesGroupClonesCheckBox_toggled(bool checked)
 {
-	LaunchingListContextMenu(m_ui->machinesTableView->mapToGlobal(pos));
+	// the proxy model does the grouping; whatever was selected is shown again when it resets
+	m_ui->machinesTreeView->setRootIsDecorated(checked);
+	dynamic_cast<SortFilterProxyModel &>(*m_ui->machinesTreeView->model()).setTreeMode(checked);
+	m_prefs.SetGroupClones(checked);
 }
 
 
@@ -1253,6 +1317,16 @@ void MainWindow::on_softwareTableView_customContextMenuRequested(const QPoint &p
 }
 
 
+//-------------------------------------------------
+//  on_softwareAvailableOnlyCheckBox_toggled
+//-------------------------------------------------
+
+void MainWindow::on_softwareAvailableOnlyCheckBox_toggled(bool checked)
+{
+	m_softwareListItemModel->setAvailableOnly(checked);
+}
+
+
 //-------------------------------------------------
 //  on_profilesTableView_activated
 //-------------------------------------------------
@@ -1308,6 +1382,7 @@ void MainWindow::on_tabWidget_currentChanged(int index)
 		updateSoftwareList();
 		break;
 	}
+	updatePreview();
 }
 
 
@@ -1338,10 +1413,26 @@ bool MainWindow::event(QEvent *event)
 	{
 		result = onChatter(static_cast<ChatterEvent &>(*event));
 	}
+	else if (event->type() == SoftwareListLoadedEvent::eventId())
+	{
+		result = onSoftwareListLoaded(static_cast<SoftwareListLoadedEvent &>(*event));
+	}
+	else if (event->type() == SoftwareIndexBuiltEvent::eventId())
+	{
+		result = onSoftwareIndexBuilt(static_cast<SoftwareIndexBuiltEvent &>(*event));
+	}
 	else if (event->type() == QEvent::WindowActivate)
 	{
 		ensureProperFocus();
 	}
+	else if (event->type() == QEvent::Show)
+	{
+		// icons are rendered for the screen we are on; we only have a window handle to tell us
+		// when that changes once we are shown
+		if (windowHandle())
+			connect(windowHandle(), &QWindow::screenChanged, this, &MainWindow::updateDevicePixelRatio, Qt::UniqueConnection);
+		updateDevicePixelRatio();
+	}
 
 	// if we have a result, we've handled the event; otherwise we have to pass it on
 	// to QMainWindow::event()
@@ -1434,6 +1525,7 @@ MainWindow::check_mame_info_status MainWindow::CheckMameInfoDatabase()
 		return check_mame_info_status::DB_NEEDS_REBUILD;
 
 	// success!  we can update the machine list
+	buildSoftwareIndex(false);
 	return check_mame_info_status::SUCCESS;
 }
 
@@ -1486,10 +1578,47 @@ bool MainWindow::refreshMameInfoDatabase()
 		return false;
 	}
 
+	buildSoftwareIndex(false);
 	return true;
 }
 
 
+//-------------------------------------------------
+//  buildSoftwareIndex - starts building the index
+//	across every software list in the background,
+//	unless we already have (or are building) one
+//	and are not asked to rebuild it
+//-------------------------------------------------
+
+void MainWindow::buildSoftwareIndex(bool rebuild)
+{
+	if (m_softwareIndexFuture.valid() && !rebuild)
+		return;
+
+	// supersede any build in flight; it notices between lists and its result is dropped because the
+	// generation moved on, but the future blocks when it goes away so we hang on to it until it is done
+	std::uint64_t generation = ++m_softwareIndexGeneration;
+	auto isDone = [](const std::future<software_index::ptr> &future)
+	{
+		return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	};
+	m_supersededSoftwareIndexFutures.erase(
+		std::remove_if(m_supersededSoftwareIndexFutures.begin(), m_supersededSoftwareIndexFutures.end(), isDone),
+		m_supersededSoftwareIndexFutures.end());
+	if (m_softwareIndexFuture.valid())
+		m_supersededSoftwareIndexFutures.push_back(std::move(m_softwareIndexFuture));
+
+	m_softwareIndexFuture = software_index::build_async(
+		m_prefs.GetSplitPaths(Preferences::global_path_type::HASH),
+		Preferences::GetSoftwareListCacheDirectory(),
+		[this, generation]() { return m_softwareIndexGeneration != generation; },
+		[this, generation](const software_index::ptr &index)
+		{
+			QCoreApplication::postEvent(this, new SoftwareIndexBuiltEvent(generation, software_index::ptr(index)));
+		});
+}
+
+
 //-------------------------------------------------
 //  GetRunningMachine
 //-------------------------------------------------
@@ -1539,7 +1668,7 @@ void MainWindow::Run(const info::machine &machine, const software_list::software
 	// for which no images are mounted (suggesting a fresh launch)
 	QString software_name;
 	if (software)
-		software_name = software->m_name;
+		software_name = software->name();
 	else if (profile && profile->images().empty())
 		software_name = profile->software();
 
@@ -1847,7 +1976,8 @@ bool MainWindow::onListXmlCompleted(const ListXmlResultEvent &event)
 		// if it succeeded, try to load the DB
 		{
 			QString db_path = m_prefs.GetMameXmlDatabasePath();
-			m_info_db.load(db_path);
+			if (m_info_db.load(db_path))
+				buildSoftwareIndex(false);
 		}
 		break;
 
@@ -1926,24 +2056,45 @@ bool MainWindow::onRunMachineCompleted(const RunMachineCompletedEvent &event)
 void MainWindow::updateSoftwareList()
 {
 	// identify the selection
-	QModelIndexList selection = m_ui->machinesTableView->selectionModel()->selectedIndexes();
+	QModelIndexList selection = m_ui->machinesTreeView->selectionModel()->selectedIndexes();
 	if (selection.size() > 0)
 	{
 		// load software lists for the current machine
 		const info::machine machine = machineFromModelIndex(selection[0]);
 
-		// load the software
-		m_currentSoftwareList = machine.name();
-		m_softwareListCollection.load(m_prefs, machine);
+		// gather the list names here; the info DB is not safe to access from the loader
+		std::vector<QString> softlistNames;
+		for (const info::software_list softlist : machine.software_lists())
+			softlistNames.push_back(softlist.name());
 
-		// and load the model
-		m_softwareListItemModel->load(m_softwareListCollection, false);
+		// and kick off the load; the model stays empty until the results come back
+		std::uint64_t generation = m_softwareListLoader.load(
+			QString(machine.name()),
+			m_prefs.GetSplitPaths(Preferences::global_path_type::HASH),
+			Preferences::GetSoftwareListCacheDirectory(),
+			m_prefs.GetSplitPaths(Preferences::global_path_type::ROMS),
+			std::move(softlistNames));
+		m_softwareListItemModel->beginLoading(generation);
 	}
 	else
 	{
 		// no machines are selected - reset the software list view
+		m_softwareListLoader.cancel();
 		m_softwareListItemModel->reset();
 	}
+	updateSoftwareListLoadingIndicator();
+}
+
+
+//-------------------------------------------------
+//  updateSoftwareListLoadingIndicator
+//-------------------------------------------------
+
+void MainWindow::updateSoftwareListLoadingIndicator()
+{
+	bool loading = m_softwareListItemModel->isLoading();
+	m_ui->softwareTableView->setEnabled(!loading);
+	m_ui->softwareSearchBox->setPlaceholderText(loading ? "Loading software lists..." : QString());
 }
 
 
@@ -2060,6 +2211,63 @@ bool MainWindow::onChatter(const ChatterEvent &event)
 }
 
 
+//-------------------------------------------------
+//  onSoftwareListLoaded
+//-------------------------------------------------
+
+bool MainWindow::onSoftwareListLoaded(SoftwareListLoadedEvent &event)
+{
+	// the selection may have moved on since this load was requested; if so, these
+	// results are stale and another load is already in flight
+	if (!m_softwareListItemModel->isAwaiting(event.generation()))
+		return true;
+
+	m_currentSoftwareList = event.machineName();
+	m_softwareListCollection = std::move(event.softwareListCollection());
+	m_softwareListItemModel->load(m_softwareListCollection, false, QString(), &event.availability());
+	updateSoftwareListLoadingIndicator();
+	return true;
+}
+
+
+//-------------------------------------------------
+//  updateDevicePixelRatio - renders icons for the
+//	screen that we are on
+//-------------------------------------------------
+
+void MainWindow::updateDevicePixelRatio()
+{
+	// icons that are already on screen are of the old ratio until they are painted again
+	if (m_icon_loader.setDevicePixelRatio(devicePixelRatioF()))
+	{
+		for (QAbstractItemView *view : std::initializer_list<QAbstractItemView *>{ m_ui->machinesTreeView, m_ui->profilesTableView })
+			view->viewport()->update();
+	}
+}
+
+
+//-------------------------------------------------
+//  onSoftwareIndexBuilt
+//-------------------------------------------------
+
+bool MainWindow::onSoftwareIndexBuilt(SoftwareIndexBuiltEvent &event)
+{
+	// ignore builds that were superseded after they finished
+	if (event.generation() != m_softwareIndexGeneration)
+		return true;
+
+	m_softwareIndex = std::move(event.index());
+	m_machineListItemModel->setSoftwareIndex(software_index::ptr(m_softwareIndex));
+
+	// only "software:" looks in the index, so the machine list is left alone unless it is there
+	SortFilterProxyModel &proxyModel = dynamic_cast<SortFilterProxyModel &>(*m_ui->machinesTreeView->model());
+	SearchQuery query(proxyModel.filterText());
+	if (std::any_of(query.terms().begin(), query.terms().end(), [](const SearchQuery::Term &term) { return term.m_field == "software"; }))
+		proxyModel.refilter();
+	return true;
+}
+
+
 //-------------------------------------------------
 //  GetFileDialogFilename
 //-------------------------------------------------
@@ -2140,12 +2348,12 @@ void MainWindow::FileDialogCommand(std::vector<QString> &&commands, const QStrin
 void MainWindow::LaunchingListContextMenu(const QPoint &pos, const software_list::software *software)
 {
 	// identify the machine
-	QModelIndex index = m_ui->machinesTableView->selectionModel()->selectedIndexes()[0];
+	QModelIndex index = m_ui->machinesTreeView->selectionModel()->selectedIndexes()[0];
 	const info::machine machine = machineFromModelIndex(index);
 
 	// identify the description
 	const QString &description = software
-		? software->m_description
+		? software->description()
 		: machine.description();
 
 	QMenu popupMenu(this);
@@ -2208,7 +2416,7 @@ void MainWindow::CreateProfile(const info::machine &machine, const software_list
 
 	// identify the description, for use when we create the file name
 	const QString &description = software
-		? software->m_description
+		? software->description()
 		: machine.name();
 
 	// get the full path for a new profile
@@ -2365,13 +2573,124 @@ void MainWindow::showInGraphicalShell(const QString &path) const
 info::machine MainWindow::machineFromModelIndex(const QModelIndex &index) const
 {
 	// map the index to the actual index
-	QModelIndex actualIndex = sortFilterProxyModel(*m_ui->machinesTableView).mapToSource(index);
+	QModelIndex actualIndex = sortFilterProxyModel(*m_ui->machinesTreeView).mapToSource(index);
 
 	// and look up in the info DB
 	return m_info_db.machines()[actualIndex.row()];
 }
 
 
+//-------------------------------------------------
+//  previewItemFromModelIndex
+//-------------------------------------------------
+
+std::optional<PreviewLoader::Item> MainWindow::previewItemFromModelIndex(const QAbstractItemView &view, const QModelIndex &index) const
+{
+	// map the index to the actual index
+	QModelIndex actualIndex = sortFilterProxyModel(view).mapToSource(index);
+	if (!actualIndex.isValid())
+		return { };
+
+	// software is in a subdirectory named after its list; everything else is a machine
+	std::optional<info::machine> machine;
+	if (&view == m_ui->machinesTreeView)
+	{
+		machine = m_info_db.machines()[actualIndex.row()];
+	}
+	else if (&view == m_ui->softwareTableView)
+	{
+		const software_list &softlist = m_softwareListItemModel->getSoftwareListByIndex(actualIndex.row());
+		const software_list::software &software = m_softwareListItemModel->getSoftwareByIndex(actualIndex.row());
+		return PreviewLoader::Item { softlist.name() + "/" + software.name(), QString() };
+	}
+	else
+	{
+		machine = m_info_db.find_machine(m_profileListItemModel->getProfileByIndex(actualIndex.row()).machine());
+	}
+
+	if (!machine)
+		return { };
+	return PreviewLoader::Item { machine->name(), machine->clone_of() };
+}
+
+
+//-------------------------------------------------
+//  updatePreview - shows the preview for whatever
+//	is selected in the current list
+//-------------------------------------------------
+
+void MainWindow::updatePreview()
+{
+	// identify the list that is showing
+	QAbstractItemView *view;
+	switch (static_cast<Preferences::list_view_type>(m_ui->tabWidget->currentIndex()))
+	{
+	case Preferences::list_view_type::MACHINE:
+		view = m_ui->machinesTreeView;
+		break;
+	case Preferences::list_view_type::SOFTWARELIST:
+		view = m_ui->softwareTableView;
+		break;
+	case Preferences::list_view_type::PROFILE:
+		view = m_ui->profilesTableView;
+		break;
+	default:
+		throw false;
+	}
+
+	// and what is selected in it
+	QModelIndex currentIndex = view->selectionModel()->currentIndex();
+	std::optional<PreviewLoader::Item> item = currentIndex.isValid()
+		? previewItemFromModelIndex(*view, currentIndex)
+		: std::nullopt;
+	if (!item)
+	{
+		m_ui->previewPane->setMessage(QString());
+		return;
+	}
+
+	// show the preview if we have it; if it is pending we leave the pane blank rather than
+	// showing the previous selection's preview, and get called back when it arrives
+	bool pending;
+	const QImage *image = m_previewLoader.getPreview(m_previewType, *item, pending);
+	if (image)
+		m_ui->previewPane->setImage(*image);
+	else if (pending)
+		m_ui->previewPane->setMessage(QString());
+	else
+		m_ui->previewPane->setMessage(m_previewType == PreviewLoader::Type::Snapshot ? "No snapshot" : "No title screen");
+
+	// and get the neighbors ready, since keyboard navigation is most likely to go to them next;
+	// in the machine tree, those are the rows that are shown above and below, which need not be
+	// siblings (they can be clones, or the next parent after the last clone)
+	QTreeView *treeView = view == m_ui->machinesTreeView ? m_ui->machinesTreeView : nullptr;
+	auto step = [treeView](const QModelIndex &index, bool down)
+	{
+		if (!index.isValid())
+			return QModelIndex();
+		if (treeView)
+			return down ? treeView->indexBelow(index) : treeView->indexAbove(index);
+		return index.sibling(index.row() + (down ? 1 : -1), index.column());
+	};
+	std::vector<PreviewLoader::Item> neighbors;
+	QModelIndex belowIndex = currentIndex, aboveIndex = currentIndex;
+	for (int distance = 1; distance <= 2; distance++)
+	{
+		belowIndex = step(belowIndex, true);
+		aboveIndex = step(aboveIndex, false);
+		for (const QModelIndex &neighborIndex : { belowIndex, aboveIndex })
+		{
+			std::optional<PreviewLoader::Item> neighbor = neighborIndex.isValid()
+				? previewItemFromModelIndex(*view, neighborIndex)
+				: std::nullopt;
+			if (neighbor)
+				neighbors.push_back(std::move(*neighbor));
+		}
+	}
+	m_previewLoader.prefetchPreviews(m_previewType, std::move(neighbors));
+}
+
+
 //-------------------------------------------------
 //  getTitleBarText
 //-------------------------------------------------
@@ -2561,8 +2880,8 @@ void MainWindow::ChangeSound(bool sound_enabled)
 //  sortFilterProxyModel
 //-------------------------------------------------
 
-const QSortFilterProxyModel &MainWindow::sortFilterProxyModel(const QTableView &tableView) const
+const SortFilterProxyModel &MainWindow::sortFilterProxyModel(const QAbstractItemView &view) const
 {
-	assert(&tableView == m_ui->machinesTableView || &tableView == m_ui->softwareTableView || &tableView == m_ui->profilesTableView);
-	return *dynamic_cast<QSortFilterProxyModel *>(tableView.model());
+	assert(&view == m_ui->machinesTreeView || &view == m_ui->softwareTableView || &view == m_ui->profilesTableView);
+	return *dynamic_cast<SortFilterProxyModel *>(view.model());
 }
@@ -14,12 +14,18 @@
 #include <QFileDialog>
 #include <memory.h>
 
+#include <atomic>
+#include <future>
+
 #include "profile.h"
 #include "prefs.h"
 #include "client.h"
 #include "iconloader.h"
 #include "info.h"
+#include "previewloader.h"
+#include "softwareindex.h"
 #include "softwarelist.h"
+#include "softwarelistloader.h"
 #include "tableviewmanager.h"
 #include "status.h"
 #include "dialogs/console.h"
@@ -30,11 +36,13 @@ namespace Ui { class MainWindow; }
 class QLineEdit;
 class QTableWidgetItem;
 class QAbstractItemModel;
-class QTableView;
+class QAbstractItemView;
 QT_END_NAMESPACE
 
+class MachineListItemModel;
 class SoftwareListItemModel;
 class ProfileListItemModel;
+class SortFilterProxyModel;
 class MameVersion;
 class VersionResultEvent;
 class ListXmlResultEvent;
@@ -82,9 +90,11 @@ private slots:
 	void on_actionAbout_triggered();
 	void on_actionRefreshMachineInfo_triggered();
 	void on_actionBletchMameWebSite_triggered();
-	void on_machinesTableView_activated(const QModelIndex &index);
-	void on_machinesTableView_customContextMenuRequested(const QPoint &pos);
+	void on_machinesTreeView_activated(const QModelIndex &index);
+	void on_machinesTreeView_customContextMenuRequested(const QPoint &pos);
+	void on_machinesGroupClonesCheckBox_toggled(bool checked);
 	void on_softwareTableView_activated(const QModelIndex &index);
+	void on_softwareAvailableOnlyCheckBox_toggled(bool checked);
 	void on_softwareTableView_customContextMenuRequested(const QPoint &pos);
 	void on_profilesTableView_activated(const QModelIndex &index);
 	void on_profilesTableView_customContextMenuRequested(const QPoint &pos);
@@ -135,6 +145,7 @@ private:
 	std::unique_ptr<Ui::MainWindow>		m_ui;
 	Preferences							m_prefs;
 	MameClient							m_client;
+	MachineListItemModel *				m_machineListItemModel;
 	SoftwareListItemModel *				m_softwareListItemModel;
 	ProfileListItemModel *				m_profileListItemModel;
 	std::vector<Aspect::ptr>			m_aspects;
@@ -158,8 +169,15 @@ private:
 	observable::unique_subscription		m_watch_subscription;
 	QString								m_currentSoftwareList;
 	software_list_collection			m_softwareListCollection;
+	SoftwareListLoader					m_softwareListLoader;
 	std::function<void(const ChatterEvent &)>	m_on_chatter;
 	IconLoader							m_icon_loader;
+	PreviewLoader						m_previewLoader;
+	PreviewLoader::Type					m_previewType;
+	std::atomic<std::uint64_t>			m_softwareIndexGeneration;
+	std::future<software_index::ptr>	m_softwareIndexFuture;
+	std::vector<std::future<software_index::ptr>>	m_supersededSoftwareIndexFutures;
+	software_index::ptr					m_softwareIndex;
 
 	// task notifications
 	bool onVersionCompleted(VersionResultEvent &event);
@@ -167,6 +185,8 @@ private:
 	bool onRunMachineCompleted(const RunMachineCompletedEvent &event);
 	bool onStatusUpdate(StatusUpdateEvent &event);
 	bool onChatter(const ChatterEvent &event);
+	bool onSoftwareListLoaded(SoftwareListLoadedEvent &event);
+	bool onSoftwareIndexBuilt(SoftwareIndexBuiltEvent &event);
 
 	// templated property/action binding
 	template<typename TStartAction, typename TStopAction>				void setupActionAspect(TStartAction &&startAction, TStopAction &&stopAction);
@@ -181,6 +201,8 @@ private:
 	check_mame_info_status CheckMameInfoDatabase();
 	bool PromptForMameExecutable();
 	bool refreshMameInfoDatabase();
+	void buildSoftwareIndex(bool rebuild);
+	void updateDevicePixelRatio();
 	QMessageBox::StandardButton messageBox(const QString &message, QMessageBox::StandardButtons buttons = QMessageBox::Ok);
 	bool shouldPromptOnStop() const;
 	void showInputsDialog(status::input::input_class input_class);
@@ -191,6 +213,7 @@ private:
 	void WatchForImageMount(const QString &tag);
 	void PlaceInRecentFiles(const QString &tag, const QString &path);
 	void updateSoftwareList();
+	void updateSoftwareListLoadingIndicator();
 	info::machine GetRunningMachine() const;
 	bool AttachToRootPanel() const;
 	void Run(const info::machine &machine, const software_list::software *software = nullptr, const profiles::profile *profile = nullptr);
@@ -207,6 +230,8 @@ private:
 	void FocusOnNewProfile(QString &&new_profile_path);
 	void showInGraphicalShell(const QString &path) const;
 	info::machine machineFromModelIndex(const QModelIndex &index) const;
+	std::optional<PreviewLoader::Item> previewItemFromModelIndex(const QAbstractItemView &view, const QModelIndex &index) const;
+	void updatePreview();
 	QString getTitleBarText();
 	static QString InputClassText(status::input::input_class input_class, bool elipsis);
 	void Issue(const std::vector<QString> &args);
@@ -219,7 +244,7 @@ private:
 	void ChangeThrottleRate(float throttle_rate);
 	void ChangeThrottleRate(int adjustment);
 	void ChangeSound(bool sound_enabled);
-	const QSortFilterProxyModel &sortFilterProxyModel(const QTableView &tableView) const;
+	const SortFilterProxyModel &sortFilterProxyModel(const QAbstractItemView &view) const;
 	void ensureProperFocus();
 };
 
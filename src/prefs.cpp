@@ -33,6 +33,8 @@ std::array<const char *, static_cast<size_t>(Preferences::global_path_type::COUN
 	"hash",
 	"artwork",
 	"icons",
+	"snap",
+	"titles",
 	"plugins",
 	"profiles"
 };
@@ -108,7 +110,9 @@ static std::tuple<const QChar *, const QChar *> SplitListViewSelectionKey(const
 Preferences::Preferences()
 	: m_size(950, 600)
 	, m_menu_bar_shown(true)
+	, m_group_clones(false)
 	, m_selected_tab(list_view_type::MACHINE)
+	, m_software_list_cache_size(64)
 {
 	// default paths
 	SetGlobalPath(global_path_type::CONFIG, GetConfigDirectory(true));
@@ -140,14 +144,16 @@ Preferences::path_category Preferences::GetPathCategory(global_path_type path_ty
 
 	case Preferences::global_path_type::ROMS:
 	case Preferences::global_path_type::SAMPLES:
-	case Preferences::global_path_type::HASH:
 	case Preferences::global_path_type::ARTWORK:
 	case Preferences::global_path_type::PLUGINS:
 	case Preferences::global_path_type::PROFILES:
 		result = path_category::MULTIPLE_DIRECTORIES;
 		break;
 
+	case Preferences::global_path_type::HASH:
 	case Preferences::global_path_type::ICONS:
+	case Preferences::global_path_type::SNAPSHOTS:
+	case Preferences::global_path_type::TITLES:
 		result = path_category::MULTIPLE_MIXED;
 		break;
 
@@ -400,6 +406,10 @@ bool Preferences::Load(QDataStream &input)
 		if (attributes.Get("menu_bar_shown", menu_bar_shown))
 			SetMenuBarShown(menu_bar_shown);
 
+		bool group_clones;
+		if (attributes.Get("group_clones", group_clones))
+			SetGroupClones(group_clones);
+
 		list_view_type selected_tab;
 		if (attributes.Get("selected_tab", selected_tab, s_list_view_type_parser))
 			SetSelectedTab(selected_tab);
@@ -437,6 +447,12 @@ bool Preferences::Load(QDataStream &input)
 			SetSize(size);
 		}
 	});
+	xml.OnElementBegin({ "preferences", "softwarelistcache" }, [&](const XmlParser::Attributes &attributes)
+	{
+		int size;
+		if (attributes.Get("size", size) && size > 0)
+			SetSoftwareListCacheSize(size);
+	});
 	xml.OnElementBegin({ "preferences", "selection" }, [&](const XmlParser::Attributes &attributes)
 	{
 		std::string list_view;
@@ -520,7 +536,7 @@ void Preferences::Save()
 void Preferences::Save(std::ostream &output)
 {
 	output << "<!-- Preferences for BletchMAME -->" << std::endl;
-	output << "<preferences menu_bar_shown=\"" << (m_menu_bar_shown ? "1" : "0") << "\" selected_tab=\"" << s_list_view_type_parser[GetSelectedTab()] << "\">" << std::endl;
+	output << "<preferences menu_bar_shown=\"" << (m_menu_bar_shown ? "1" : "0") << "\" group_clones=\"" << (m_group_clones ? "1" : "0") << "\" selected_tab=\"" << s_list_view_type_parser[GetSelectedTab()] << "\">" << std::endl;
 	output << std::endl;
 
 	output << "\t<!-- Paths -->" << std::endl;
@@ -532,6 +548,7 @@ void Preferences::Save(std::ostream &output)
 	if (!m_mame_extra_arguments.isEmpty())
 		output << "\t<mameextraarguments>" << util::to_utf8_string(m_mame_extra_arguments) << "</mameextraarguments>" << std::endl;
 	output << "\t<size width=\"" << m_size.width() << "\" height=\"" << m_size.height() << "\"/>" << std::endl;
+	output << "\t<softwarelistcache size=\"" << m_software_list_cache_size << "\"/>" << std::endl;
 
 	for (const auto &pair : m_list_view_selection)
 	{
@@ -713,6 +730,43 @@ QString Preferences::GetMameXmlDatabasePath(bool ensure_directory_exists) const
 }
 
 
+//-------------------------------------------------
+//  GetSoftwareListCacheDirectory - gets the
+//	directory holding compiled software lists
+//-------------------------------------------------
+
+QString Preferences::GetSoftwareListCacheDirectory(bool ensure_directory_exists)
+{
+	// get the configuration directory
+	QString config_dir = GetConfigDirectory(ensure_directory_exists);
+	if (config_dir.isEmpty())
+		return "";
+
+	QString directory = QDir(config_dir).filePath("softlists");
+	if (ensure_directory_exists)
+		QDir().mkpath(directory);
+	return directory;
+}
+
+
+//-------------------------------------------------
+//  GetIconCacheFileName - gets the file holding
+//	the scaled icons for a device pixel ratio
+//-------------------------------------------------
+
+QString Preferences::GetIconCacheFileName(int scale, bool ensure_directory_exists)
+{
+	QString config_dir = GetConfigDirectory(ensure_directory_exists);
+	if (config_dir.isEmpty())
+		return "";
+
+	QString file_name = scale == 1
+		? QString("icons.cache")
+		: QString("icons@%1x.cache").arg(scale);
+	return QDir(config_dir).filePath(file_name);
+}
+
+
 //-------------------------------------------------
 //  GetFileName
 //-------------------------------------------------
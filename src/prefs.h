@@ -45,6 +45,8 @@ public:
 		HASH,
 		ARTWORK,
 		ICONS,
+		SNAPSHOTS,
+		TITLES,
 		PLUGINS,
 		PROFILES,
 
@@ -117,6 +119,14 @@ public:
 	bool GetMenuBarShown() const							{ return m_menu_bar_shown; }
 	void SetMenuBarShown(bool menu_bar_shown)				{ m_menu_bar_shown = menu_bar_shown; }
 
+	// whether the machine list shows clones under their parents
+	bool GetGroupClones() const								{ return m_group_clones; }
+	void SetGroupClones(bool group_clones)					{ m_group_clones = group_clones; }
+
+	// in megabytes
+	int GetSoftwareListCacheSize() const					{ return m_software_list_cache_size; }
+	void SetSoftwareListCacheSize(int size)					{ m_software_list_cache_size = size; }
+
     const QString &GetMachinePath(const QString &machine_name, machine_path_type path_type) const;
     void SetMachinePath(const QString &machine_name, machine_path_type path_type, QString &&path);
 
@@ -124,6 +134,8 @@ public:
     const std::vector<QString> &GetRecentDeviceFiles(const QString &machine_name, const QString &device_type) const;
 
     QString GetMameXmlDatabasePath(bool ensure_directory_exists = true) const;
+    static QString GetSoftwareListCacheDirectory(bool ensure_directory_exists = true);
+    static QString GetIconCacheFileName(int scale, bool ensure_directory_exists = true);
     QString ApplySubstitutions(const QString &path) const;
 	static QString InternalApplySubstitutions(const QString &src, std::function<QString(const QString &)> func);
 
@@ -152,6 +164,8 @@ private:
     std::unordered_map<QString, QString>													m_list_view_selection;
 	mutable std::unordered_map<QString, QString>											m_list_view_filter;
 	bool																					m_menu_bar_shown;
+	bool																					m_group_clones;
+	int																						m_software_list_cache_size;
 
 	void Save(std::ostream &output);
     QString GetFileName(bool ensure_directory_exists);
@@ -0,0 +1,439 @@
+/***************************************************************************
+
+	previewloader.cpp
+
+	Loads snapshots and title screens in the background
+
+***************************************************************************/
+
+#include <QCoreApplication>
+
+#include <algorithm>
+
+#include "imagefinder.h"
+#include "prefs.h"
+#include "previewloader.h"
+
+
+//**************************************************************************
+//  CONSTANTS
+//**************************************************************************
+
+// memoized misses take up no image memory, but we do not want to keep them forever
+#define MAX_PREVIEWS	1024
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+QEvent::Type PreviewLoader::s_resultsEventId = (QEvent::Type) QEvent::registerEventType();
+
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+PreviewLoader::PreviewLoader(Preferences &prefs)
+	: m_prefs(prefs)
+	, m_budget(DEFAULT_BUDGET)
+	, m_residentBytes(0)
+	, m_generation(0)
+	, m_resultsEventPosted(false)
+	, m_exiting(false)
+{
+	refreshPaths();
+
+	// one worker is plenty; only so many previews can be looked at at once
+	m_thread = std::thread([this]() { threadProc(); });
+}
+
+
+//-------------------------------------------------
+//  dtor
+//-------------------------------------------------
+
+PreviewLoader::~PreviewLoader()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_exiting = true;
+	}
+	m_condition.notify_all();
+	m_thread.join();
+}
+
+
+//-------------------------------------------------
+//  refreshPaths
+//-------------------------------------------------
+
+void PreviewLoader::refreshPaths()
+{
+	// loop through the snapshot and title paths
+	std::shared_ptr<const FinderList> finders[(size_t)Type::COUNT];
+	for (Type type : { Type::Snapshot, Type::Title })
+	{
+		auto typeFinders = std::make_shared<FinderList>();
+		QStringList paths = m_prefs.GetSplitPaths(type == Type::Snapshot
+			? Preferences::global_path_type::SNAPSHOTS
+			: Preferences::global_path_type::TITLES);
+		for (const QString &path : paths)
+		{
+			std::unique_ptr<ImageFinder> finder = ImageFinder::create(path);
+			if (finder)
+				typeFinders->push_back(std::move(finder));
+		}
+		finders[(size_t)type] = std::move(typeFinders);
+	}
+
+	// swap in the new finders; previews that are already being decoded will be discarded when
+	// they arrive because the generation changed
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		for (size_t i = 0; i < (size_t)Type::COUNT; i++)
+			m_finders[i] = std::move(finders[i]);
+		m_generation++;
+		m_request.reset();
+		m_prefetchRequests.clear();
+		m_results.clear();
+	}
+	m_previewMap.clear();
+	m_lru.clear();
+	m_residentBytes = 0;
+}
+
+
+//-------------------------------------------------
+//  getPreview
+//-------------------------------------------------
+
+const QImage *PreviewLoader::getPreview(Type type, const Item &item, bool &pending)
+{
+	// clones fall back to the parent's preview, but we only know to do that once we know the
+	// clone does not have its own
+	QString name = item.m_name;
+	QString fallbackName = item.m_fallbackName;
+	const Preview *preview = findPreview(type, name);
+	if (preview && preview->m_status == PreviewStatus::Missing && !fallbackName.isEmpty())
+	{
+		name = std::move(fallbackName);
+		fallbackName = QString();
+		preview = findPreview(type, name);
+	}
+
+	if (!preview)
+	{
+		// if there is nowhere to look we can answer right away
+		QString key = previewKey(type, name);
+		if (m_finders[(size_t)type]->empty())
+		{
+			addPreview(QString(key), PreviewStatus::Missing, QImage());
+		}
+		else
+		{
+			// otherwise this becomes the request, taking it out of the prefetches if it is there
+			m_previewMap.emplace(key, Preview { PreviewStatus::Pending, QImage(), { } });
+			std::optional<Request> replacedRequest;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				auto prefetchIter = std::find_if(m_prefetchRequests.begin(), m_prefetchRequests.end(), [type, &name](const Request &request)
+				{
+					return request.m_type == type && request.m_item.m_name == name;
+				});
+				if (prefetchIter != m_prefetchRequests.end())
+					m_prefetchRequests.erase(prefetchIter);
+				replacedRequest = std::move(m_request);
+				m_request = Request { type, Item { name, fallbackName } };
+			}
+			m_condition.notify_one();
+
+			// the selection moved on before we got to the previous request, so forget about it;
+			// it will be requested again if the selection comes back
+			if (replacedRequest)
+			{
+				auto replacedIter = m_previewMap.find(previewKey(replacedRequest->m_type, replacedRequest->m_item.m_name));
+				if (replacedIter != m_previewMap.end() && replacedIter->second.m_status == PreviewStatus::Pending)
+					m_previewMap.erase(replacedIter);
+			}
+		}
+		preview = &m_previewMap.find(key)->second;
+	}
+
+	pending = preview->m_status == PreviewStatus::Pending;
+	return preview->m_status == PreviewStatus::Loaded
+		? &preview->m_image
+		: nullptr;
+}
+
+
+//-------------------------------------------------
+//  prefetchPreviews
+//-------------------------------------------------
+
+void PreviewLoader::prefetchPreviews(Type type, std::vector<Item> &&items)
+{
+	if (m_finders[(size_t)type]->empty())
+		return;
+
+	// work out what we do not already have, in the order specified
+	std::deque<Request> requests;
+	for (Item &item : items)
+	{
+		const Preview *preview = findPreview(type, item.m_name);
+		if (preview && preview->m_status == PreviewStatus::Missing && !item.m_fallbackName.isEmpty())
+		{
+			item.m_name = std::move(item.m_fallbackName);
+			item.m_fallbackName = QString();
+			preview = findPreview(type, item.m_name);
+		}
+		if (!preview)
+			requests.push_back(Request { type, std::move(item) });
+	}
+
+	// and replace the previous prefetch; what was left of it is for items that are no longer
+	// next to the selection
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_prefetchRequests = std::move(requests);
+	}
+	m_condition.notify_one();
+}
+
+
+//-------------------------------------------------
+//  setPreviewLoadedCallback
+//-------------------------------------------------
+
+void PreviewLoader::setPreviewLoadedCallback(std::function<void()> &&callback)
+{
+	m_previewLoadedCallback = std::move(callback);
+}
+
+
+//-------------------------------------------------
+//  setBudget
+//-------------------------------------------------
+
+void PreviewLoader::setBudget(size_t budget)
+{
+	m_budget = budget;
+	trim();
+}
+
+
+//-------------------------------------------------
+//  event
+//-------------------------------------------------
+
+bool PreviewLoader::event(QEvent *event)
+{
+	if (event->type() != s_resultsEventId)
+		return QObject::event(event);
+
+	processResults();
+	return true;
+}
+
+
+//-------------------------------------------------
+//  findPreview - looks up a preview that was
+//	already requested
+//-------------------------------------------------
+
+const PreviewLoader::Preview *PreviewLoader::findPreview(Type type, const QString &name)
+{
+	auto iter = m_previewMap.find(previewKey(type, name));
+	if (iter == m_previewMap.end())
+		return nullptr;
+
+	if (iter->second.m_status != PreviewStatus::Pending)
+		m_lru.splice(m_lru.begin(), m_lru, iter->second.m_lruPosition);
+	return &iter->second;
+}
+
+
+//-------------------------------------------------
+//  addPreview
+//-------------------------------------------------
+
+void PreviewLoader::addPreview(QString &&key, PreviewStatus status, QImage &&image)
+{
+	// this may be replacing a pending entry
+	Preview &preview = m_previewMap[key];
+	preview.m_status = status;
+	preview.m_image = std::move(image);
+	m_lru.push_front(std::move(key));
+	preview.m_lruPosition = m_lru.begin();
+	m_residentBytes += imageBytes(preview.m_image);
+
+	// trimming never evicts what we just added
+	trim();
+}
+
+
+//-------------------------------------------------
+//  trim - evicts least recently used previews
+//	until we are within budget
+//-------------------------------------------------
+
+void PreviewLoader::trim()
+{
+	while ((m_residentBytes > m_budget || m_lru.size() > MAX_PREVIEWS) && m_lru.size() > 1)
+	{
+		auto iter = m_previewMap.find(m_lru.back());
+		m_residentBytes -= imageBytes(iter->second.m_image);
+		m_previewMap.erase(iter);
+		m_lru.pop_back();
+	}
+}
+
+
+//-------------------------------------------------
+//  processResults - called on the GUI thread to
+//	take the previews decoded by the worker
+//-------------------------------------------------
+
+void PreviewLoader::processResults()
+{
+	std::vector<Result> results;
+	std::uint64_t generation;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		results = std::move(m_results);
+		m_results.clear();
+		m_resultsEventPosted = false;
+		generation = m_generation;
+	}
+
+	bool anyChanged = false;
+	for (Result &result : results)
+	{
+		if (result.m_generation != generation)
+			continue;
+
+		// prefetched previews are not in the map yet; anything that is there and not pending
+		// was resolved some other way in the meantime
+		QString key = previewKey(result.m_type, result.m_name);
+		auto iter = m_previewMap.find(key);
+		bool wasPending = iter != m_previewMap.end() && iter->second.m_status == PreviewStatus::Pending;
+		if (iter != m_previewMap.end() && !wasPending)
+			continue;
+
+		// note that while decoding can fail, we want to memoize the failure
+		if (result.m_image)
+			addPreview(std::move(key), PreviewStatus::Loaded, std::move(*result.m_image));
+		else
+			addPreview(std::move(key), PreviewStatus::Missing, QImage());
+
+		// nobody is waiting on prefetches
+		anyChanged = anyChanged || wasPending;
+	}
+
+	if (anyChanged && m_previewLoadedCallback)
+		m_previewLoadedCallback();
+}
+
+
+//-------------------------------------------------
+//  threadProc
+//-------------------------------------------------
+
+void PreviewLoader::threadProc()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;)
+	{
+		m_condition.wait(lock, [this]() { return m_exiting || m_request || !m_prefetchRequests.empty(); });
+		if (m_exiting)
+			break;
+
+		// what is selected comes first, and then its neighbors
+		Request request;
+		if (m_request)
+		{
+			request = std::move(*m_request);
+			m_request.reset();
+		}
+		else
+		{
+			request = std::move(m_prefetchRequests.front());
+			m_prefetchRequests.pop_front();
+		}
+		std::uint64_t generation = m_generation;
+		std::shared_ptr<const FinderList> finders = m_finders[(size_t)request.m_type];
+
+		lock.unlock();
+		std::optional<QImage> image = loadPreview(*finders, request.m_item.m_name);
+		std::optional<Result> fallbackResult;
+		if (!image && !request.m_item.m_fallbackName.isEmpty())
+		{
+			std::optional<QImage> fallbackImage = loadPreview(*finders, request.m_item.m_fallbackName);
+			fallbackResult = Result { generation, request.m_type, std::move(request.m_item.m_fallbackName), std::move(fallbackImage) };
+		}
+		lock.lock();
+
+		// post the results, unless we already have an event on its way
+		if (generation == m_generation)
+		{
+			m_results.push_back(Result { generation, request.m_type, std::move(request.m_item.m_name), std::move(image) });
+			if (fallbackResult)
+				m_results.push_back(std::move(*fallbackResult));
+			if (!m_resultsEventPosted)
+			{
+				m_resultsEventPosted = true;
+				QCoreApplication::postEvent(this, new QEvent(s_resultsEventId));
+			}
+		}
+	}
+}
+
+
+//-------------------------------------------------
+//  previewKey
+//-------------------------------------------------
+
+QString PreviewLoader::previewKey(Type type, const QString &name)
+{
+	return QString::number((int)type) + ":" + name;
+}
+
+
+//-------------------------------------------------
+//  imageBytes
+//-------------------------------------------------
+
+size_t PreviewLoader::imageBytes(const QImage &image)
+{
+	return (size_t)image.bytesPerLine() * image.height();
+}
+
+
+//-------------------------------------------------
+//  loadPreview - finds and decodes a preview;
+//	called from the worker thread
+//-------------------------------------------------
+
+std::optional<QImage> PreviewLoader::loadPreview(const FinderList &finders, const QString &name)
+{
+	// MAME saves snapshots as 'snap/pacman.png' or 'snap/pacman/0000.png' depending on the
+	// snapname option, and collections come either way
+	const QString fileNames[] = { name + ".png", name + "/0000.png" };
+
+	for (const auto &finder : finders)
+	{
+		for (const QString &fileName : fileNames)
+		{
+			std::optional<QByteArray> byteArray = finder->readFile(fileName);
+			if (byteArray)
+			{
+				// converting here spares the GUI thread from doing so when it is drawn
+				QImage image;
+				if (!image.loadFromData(*byteArray))
+					return { };
+				return image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+			}
+		}
+	}
+	return { };
+}
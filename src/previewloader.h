@@ -0,0 +1,143 @@
+/***************************************************************************
+
+	previewloader.h
+
+	Loads snapshots and title screens in the background
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef PREVIEWLOADER_H
+#define PREVIEWLOADER_H
+
+#include <QEvent>
+#include <QImage>
+#include <QObject>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class ImageFinder;
+class Preferences;
+
+class PreviewLoader : public QObject
+{
+public:
+	enum class Type
+	{
+		Snapshot,
+		Title,
+
+		COUNT
+	};
+
+	// what we want a preview of; a machine name (e.g. - "pacman") or a software list and software
+	// name (e.g. - "nes/smb"), and optionally another to fall back to, like the parent of a clone
+	struct Item
+	{
+		QString		m_name;
+		QString		m_fallbackName;
+	};
+
+	static const size_t DEFAULT_BUDGET = 32 * 1024 * 1024;		// bytes
+
+	// ctor / dtor
+	PreviewLoader(Preferences &prefs);
+	~PreviewLoader();
+
+	// methods
+	void refreshPaths();
+
+	// returns the preview for an item, or nullptr if there is none; previews are decoded in the
+	// background, so if this one is not ready yet nullptr is returned and pending is set; this
+	// replaces any previous request that has not been started on yet
+	const QImage *getPreview(Type type, const Item &item, bool &pending);
+
+	// starts decoding previews for items that are likely to be asked for next, like the
+	// neighbors of the current selection; this replaces any previous prefetch
+	void prefetchPreviews(Type type, std::vector<Item> &&items);
+
+	// callback invoked on the GUI thread when a preview that was pending becomes ready
+	void setPreviewLoadedCallback(std::function<void()> &&callback);
+
+	// decoded previews are kept in memory up to a budget, after which the least recently used
+	// are dropped
+	size_t budget() const							{ return m_budget; }
+	void setBudget(size_t budget);
+
+	// virtuals
+	virtual bool event(QEvent *event) override;
+
+private:
+	typedef std::vector<std::unique_ptr<ImageFinder>> FinderList;
+
+	enum class PreviewStatus
+	{
+		Pending,
+		Loaded,
+		Missing
+	};
+
+	struct Preview
+	{
+		PreviewStatus					m_status;
+		QImage							m_image;
+		std::list<QString>::iterator	m_lruPosition;		// only when not pending
+	};
+
+	struct Request
+	{
+		Type					m_type;
+		Item					m_item;
+	};
+
+	struct Result
+	{
+		std::uint64_t			m_generation;
+		Type					m_type;
+		QString					m_name;
+		std::optional<QImage>	m_image;
+	};
+
+	Preferences &								m_prefs;
+	std::unordered_map<QString, Preview>		m_previewMap;	// keyed by previewKey()
+	std::list<QString>							m_lru;			// most recently used first
+	size_t										m_budget;
+	size_t										m_residentBytes;
+	std::function<void()>						m_previewLoadedCallback;
+
+	// shared with the worker thread
+	std::mutex									m_mutex;
+	std::condition_variable						m_condition;
+	std::shared_ptr<const FinderList>			m_finders[(size_t)Type::COUNT];
+	std::uint64_t								m_generation;
+	std::optional<Request>						m_request;
+	std::deque<Request>							m_prefetchRequests;	// nearest first
+	std::vector<Result>							m_results;
+	bool										m_resultsEventPosted;
+	bool										m_exiting;
+	std::thread									m_thread;
+
+	static QEvent::Type							s_resultsEventId;
+
+	const Preview *findPreview(Type type, const QString &name);
+	void addPreview(QString &&key, PreviewStatus status, QImage &&image);
+	void trim();
+	void processResults();
+	void threadProc();
+	static QString previewKey(Type type, const QString &name);
+	static size_t imageBytes(const QImage &image);
+	static std::optional<QImage> loadPreview(const FinderList &finders, const QString &name);
+};
+
+#endif // PREVIEWLOADER_H
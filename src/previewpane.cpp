@@ -0,0 +1,132 @@
+/***************************************************************************
+
+	previewpane.cpp
+
+	Shows the snapshot or title screen of the selected item
+
+***************************************************************************/
+
+#include <QMouseEvent>
+#include <QPainter>
+
+#include "previewpane.h"
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+PreviewPane::PreviewPane(QWidget *parent)
+	: QWidget(parent)
+{
+	setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Expanding);
+}
+
+
+//-------------------------------------------------
+//  setImage
+//-------------------------------------------------
+
+void PreviewPane::setImage(const QImage &image)
+{
+	// QImage is implicitly shared, so this is cheap when the image has not changed
+	if (m_message.isEmpty() && image.cacheKey() == m_image.cacheKey())
+		return;
+
+	m_image = image;
+	m_scaledPixmap = QPixmap();
+	m_message.clear();
+	update();
+}
+
+
+//-------------------------------------------------
+//  setMessage
+//-------------------------------------------------
+
+void PreviewPane::setMessage(const QString &message)
+{
+	m_image = QImage();
+	m_scaledPixmap = QPixmap();
+	m_message = message;
+	update();
+}
+
+
+//-------------------------------------------------
+//  setOnClicked
+//-------------------------------------------------
+
+void PreviewPane::setOnClicked(std::function<void()> &&onClicked)
+{
+	m_onClicked = std::move(onClicked);
+}
+
+
+//-------------------------------------------------
+//  sizeHint
+//-------------------------------------------------
+
+QSize PreviewPane::sizeHint() const
+{
+	// MAME snapshots are usually 4:3
+	return QSize(320, 240);
+}
+
+
+//-------------------------------------------------
+//  paintEvent
+//-------------------------------------------------
+
+void PreviewPane::paintEvent(QPaintEvent *event)
+{
+	QPainter painter(this);
+	if (!m_image.isNull())
+	{
+		// scaling is done once for each image and size, rather than every time we paint
+		qreal devicePixelRatio = devicePixelRatioF();
+		if (m_scaledPixmap.isNull())
+		{
+			QSize size = m_image.size().scaled(this->size() * devicePixelRatio, Qt::KeepAspectRatio);
+			m_scaledPixmap = QPixmap::fromImage(m_image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+			m_scaledPixmap.setDevicePixelRatio(devicePixelRatio);
+		}
+
+		QSize size = m_scaledPixmap.size() / devicePixelRatio;
+		QPoint position((width() - size.width()) / 2, (height() - size.height()) / 2);
+		painter.drawPixmap(position, m_scaledPixmap);
+	}
+	else if (!m_message.isEmpty())
+	{
+		painter.setPen(palette().color(QPalette::Disabled, QPalette::Text));
+		painter.drawText(rect(), Qt::AlignCenter | Qt::TextWordWrap, m_message);
+	}
+}
+
+
+//-------------------------------------------------
+//  resizeEvent
+//-------------------------------------------------
+
+void PreviewPane::resizeEvent(QResizeEvent *event)
+{
+	m_scaledPixmap = QPixmap();
+	QWidget::resizeEvent(event);
+}
+
+
+//-------------------------------------------------
+//  mousePressEvent
+//-------------------------------------------------
+
+void PreviewPane::mousePressEvent(QMouseEvent *event)
+{
+	if (event->button() == Qt::LeftButton && m_onClicked)
+		m_onClicked();
+	else
+		QWidget::mousePressEvent(event);
+}
@@ -0,0 +1,54 @@
+/***************************************************************************
+
+	previewpane.h
+
+	Shows the snapshot or title screen of the selected item
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef PREVIEWPANE_H
+#define PREVIEWPANE_H
+
+#include <QImage>
+#include <QPixmap>
+#include <QWidget>
+
+#include <functional>
+
+
+// ======================> PreviewPane
+
+class PreviewPane : public QWidget
+{
+public:
+	// ctor
+	PreviewPane(QWidget *parent = nullptr);
+
+	// shows an image, scaled to fit while keeping its aspect ratio
+	void setImage(const QImage &image);
+
+	// shows a message in place of an image; an empty message leaves the pane blank
+	void setMessage(const QString &message);
+
+	// callback invoked when the pane is clicked
+	void setOnClicked(std::function<void()> &&onClicked);
+
+	// virtuals
+	virtual QSize sizeHint() const override;
+
+protected:
+	virtual void paintEvent(QPaintEvent *event) override;
+	virtual void resizeEvent(QResizeEvent *event) override;
+	virtual void mousePressEvent(QMouseEvent *event) override;
+
+private:
+	QImage					m_image;
+	QPixmap					m_scaledPixmap;		// m_image scaled to our size, made when first painted
+	QString					m_message;
+	std::function<void()>	m_onClicked;
+};
+
+
+#endif // PREVIEWPANE_H
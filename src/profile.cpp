@@ -189,7 +189,7 @@ void profiles::profile::create(QTextStream &stream, const info::machine &machine
 	profile new_profile;
 	new_profile.m_machine = machine.name();
 	if (software)
-		new_profile.m_software = software->m_name;
+		new_profile.m_software = software->name();
 	new_profile.save_as(stream);
 }
 
@@ -24,6 +24,7 @@ ProfileListItemModel::ProfileListItemModel(QObject *parent, Preferences &prefs,
     , m_infoDb(infoDb)
     , m_iconLoader(iconLoader)
     , m_fileSystemWatcher(*new QFileSystemWatcher(this))
+    , m_iconsPending(false)
 {
     connect(&m_fileSystemWatcher, &QFileSystemWatcher::directoryChanged, this, [this](const QString &path)
     {
@@ -37,6 +38,14 @@ ProfileListItemModel::ProfileListItemModel(QObject *parent, Preferences &prefs,
             m_fswCallback = std::function<void()>();
         }
     });
+
+    // there are never many profiles, so we do not bother to track which rows were waiting
+    m_iconLoader.addIconsLoadedCallback([this]
+    {
+        if (m_iconsPending && !m_profiles.empty())
+            emit dataChanged(index(0, (int)Column::Name, QModelIndex()), index((int)m_profiles.size() - 1, (int)Column::Name, QModelIndex()), { Qt::DecorationRole });
+        m_iconsPending = false;
+    });
 }
 
 
@@ -189,7 +198,11 @@ QVariant ProfileListItemModel::data(const QModelIndex &index, int role) const
             {
                 std::optional<info::machine> machine = m_infoDb.find_machine(p.machine());
                 if (machine)
-                    result = m_iconLoader.getIcon(*machine);
+                {
+                    bool pending;
+                    result = m_iconLoader.getIcon(*machine, pending);
+                    m_iconsPending = m_iconsPending || pending;
+                }
             }
             break;
         }
@@ -241,3 +254,16 @@ Qt::ItemFlags ProfileListItemModel::flags(const QModelIndex &index) const
         result |= Qt::ItemIsEditable;
     return result;
 }
+
+
+//-------------------------------------------------
+//  findRowByKey - there are rarely enough profiles
+//  for this to be worth indexing; keys are the
+//  paths as shown, with native separators
+//-------------------------------------------------
+
+int ProfileListItemModel::findRowByKey(const QString &key) const
+{
+    QModelIndex index = findProfileIndex(QDir::fromNativeSeparators(key));
+    return index.isValid() ? index.row() : -1;
+}
@@ -13,6 +13,7 @@
 
 #include "info.h"
 #include "profile.h"
+#include "tableviewmanager.h"
 
 QT_BEGIN_NAMESPACE
 class QFileSystemWatcher;
@@ -24,7 +25,7 @@ class Preferences;
 
 // ======================> MachineListItemModel
 
-class ProfileListItemModel : public QAbstractItemModel
+class ProfileListItemModel : public QAbstractItemModel, public TableViewManager::IKeySource
 {
 public:
 	enum class Column
@@ -52,6 +53,7 @@ public:
 	virtual QVariant data(const QModelIndex &index, int role) const override;
 	virtual QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
 	virtual Qt::ItemFlags flags(const QModelIndex &index) const override;
+	virtual int findRowByKey(const QString &key) const override;
 
 private:
 	Preferences &					m_prefs;
@@ -60,6 +62,7 @@ private:
 	QFileSystemWatcher &			m_fileSystemWatcher;
 	std::vector<profiles::profile>	m_profiles;
 	std::function<void()>			m_fswCallback;
+	mutable bool					m_iconsPending;
 
 };
 
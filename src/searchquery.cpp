@@ -0,0 +1,160 @@
+/***************************************************************************
+
+	searchquery.cpp
+
+	Parsing of what is typed into the search boxes
+
+***************************************************************************/
+
+#include <limits>
+
+#include "searchquery.h"
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+SearchQuery::SearchQuery(const QString &text)
+{
+	int length = text.size();
+	int position = 0;
+	while (position < length)
+	{
+		// skip whitespace
+		if (text[position].isSpace())
+		{
+			position++;
+			continue;
+		}
+		Term term;
+
+		// a leading '-' negates the term, but a '-' on its own is just text
+		if (text[position] == '-' && position + 1 < length && !text[position + 1].isSpace())
+		{
+			term.m_negated = true;
+			position++;
+		}
+		int tokenPosition = position;
+
+		// is this restricted to a field?
+		int fieldEnd = position;
+		while (fieldEnd < length && text[fieldEnd].isLetter())
+			fieldEnd++;
+		if (fieldEnd > position && fieldEnd + 1 < length && text[fieldEnd] == ':' && !text[fieldEnd + 1].isSpace())
+		{
+			term.m_field = text.mid(position, fieldEnd - position).toLower();
+			position = fieldEnd + 1;
+		}
+
+		// the text, which can be quoted to have spaces in it
+		if (text[position] == '\"')
+		{
+			int textPosition = ++position;
+			while (position < length && text[position] != '\"')
+				position++;
+			term.m_text = text.mid(textPosition, position - textPosition).toLower();
+			if (position < length)
+				position++;
+		}
+		else
+		{
+			int textPosition = position;
+			while (position < length && !text[position].isSpace())
+				position++;
+			term.m_text = text.mid(textPosition, position - textPosition).toLower();
+		}
+		term.m_token = text.mid(tokenPosition, position - tokenPosition).toLower();
+		term.m_isRange = !term.m_field.isEmpty() && parseRange(term);
+
+		// an empty pair of quotes matches everything, so there is no point in keeping it
+		if (!term.m_text.isEmpty())
+			m_terms.push_back(std::move(term));
+	}
+}
+
+
+//-------------------------------------------------
+//  parseRange - parses "min..max", where either
+//	end can be left off
+//-------------------------------------------------
+
+bool SearchQuery::parseRange(Term &term)
+{
+	int dotsPosition = term.m_text.indexOf("..");
+	if (dotsPosition < 0)
+		return false;
+
+	QString minText = term.m_text.left(dotsPosition);
+	QString maxText = term.m_text.mid(dotsPosition + 2);
+	if (minText.isEmpty() && maxText.isEmpty())
+		return false;
+
+	bool minOk = true, maxOk = true;
+	term.m_rangeMin = !minText.isEmpty() ? minText.toInt(&minOk) : std::numeric_limits<int>::min();
+	term.m_rangeMax = !maxText.isEmpty() ? maxText.toInt(&maxOk) : std::numeric_limits<int>::max();
+	return minOk && maxOk;
+}
+
+
+//-------------------------------------------------
+//  Term ctor
+//-------------------------------------------------
+
+SearchQuery::Term::Term()
+	: m_negated(false)
+	, m_isRange(false)
+	, m_rangeMin(0)
+	, m_rangeMax(0)
+{
+}
+
+
+//-------------------------------------------------
+//  Term::matches
+//-------------------------------------------------
+
+bool SearchQuery::Term::matches(const QString &text) const
+{
+	return m_isRange
+		? matchesRange(text)
+		: text.contains(m_text, Qt::CaseInsensitive);
+}
+
+
+//-------------------------------------------------
+//  Term::matchesRange
+//-------------------------------------------------
+
+bool SearchQuery::Term::matchesRange(const QString &text) const
+{
+	// years can have unknown digits (e.g. - "198?"), in which case we match if any year that it
+	// could be is in range; a '?' after all four digits just means that the year is uncertain
+	int low = 0, high = 0, digitCount = 0;
+	for (QChar ch : text)
+	{
+		if (ch.isDigit())
+		{
+			low = low * 10 + ch.digitValue();
+			high = high * 10 + ch.digitValue();
+		}
+		else if (ch == '?' && digitCount < 4)
+		{
+			low = low * 10;
+			high = high * 10 + 9;
+		}
+		else
+		{
+			break;
+		}
+
+		// anything this long is not a number that we would be looking for
+		if (++digitCount > 9)
+			return false;
+	}
+	return digitCount > 0 && high >= m_rangeMin && low <= m_rangeMax;
+}
@@ -0,0 +1,67 @@
+/***************************************************************************
+
+	searchquery.h
+
+	Parsing of what is typed into the search boxes
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef SEARCHQUERY_H
+#define SEARCHQUERY_H
+
+#include <QString>
+
+#include <vector>
+
+
+// ======================> SearchQuery
+
+// A query is a list of terms separated by spaces, all of which must match:
+//
+//	pacman					"pacman" somewhere in the row
+//	"pac-man (midway)"		a phrase with spaces in it
+//	manufacturer:capcom		"capcom" somewhere in the manufacturer
+//	year:1990..1995			a year in this range; either end can be left off
+//	-is:clone				anything not matching the term
+//
+// What fields there are (and flags like "is:clone" above) is up to whoever evaluates the query;
+// words without a field are always text
+class SearchQuery
+{
+public:
+	class Term
+	{
+	public:
+		QString		m_token;		// the term as typed (less any '-'), in lower case
+		QString		m_field;		// lower case; empty if this is not restricted to a field
+		QString		m_text;			// lower case
+		bool		m_negated;
+		bool		m_isRange;
+		int			m_rangeMin;
+		int			m_rangeMax;
+
+		Term();
+
+		// does this text match, ignoring whether the term is negated?
+		bool matches(const QString &text) const;
+		bool matchesRange(const QString &text) const;
+	};
+
+	// ctors
+	SearchQuery() = default;
+	SearchQuery(const QString &text);
+
+	// accessors
+	const std::vector<Term> &terms() const { return m_terms; }
+	bool isEmpty() const { return m_terms.empty(); }
+
+private:
+	std::vector<Term>	m_terms;
+
+	static bool parseRange(Term &term);
+};
+
+
+#endif // SEARCHQUERY_H
@@ -0,0 +1,117 @@
+/***************************************************************************
+
+	softwareavailability.cpp
+
+	Tracking which software list entries are present in the ROM paths
+
+***************************************************************************/
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+
+#include "softwareavailability.h"
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  global
+//-------------------------------------------------
+
+software_availability &software_availability::global()
+{
+	static software_availability s_instance;
+	return s_instance;
+}
+
+
+//-------------------------------------------------
+//  get
+//-------------------------------------------------
+
+software_availability::set_ptr software_availability::get(const QStringList &rom_paths, const QString &list_name)
+{
+	// gather the contents of each <rompath>/<listname>
+	std::vector<set_ptr> contents;
+	for (const QString &rom_path : rom_paths)
+	{
+		set_ptr directory_contents = get_directory(rom_path + "/" + list_name);
+		if (directory_contents && !directory_contents->empty())
+			contents.push_back(std::move(directory_contents));
+	}
+
+	// the common case is that software only lives in one place, and we can share the set
+	if (contents.size() == 1)
+		return std::move(contents[0]);
+
+	auto result = std::make_shared<std::unordered_set<QString>>();
+	for (const set_ptr &directory_contents : contents)
+		result->insert(directory_contents->begin(), directory_contents->end());
+	return result;
+}
+
+
+//-------------------------------------------------
+//  clear
+//-------------------------------------------------
+
+void software_availability::clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_directories.clear();
+}
+
+
+//-------------------------------------------------
+//  get_directory - returns the contents of a
+//	directory, scanning it only if it changed
+//-------------------------------------------------
+
+software_availability::set_ptr software_availability::get_directory(const QString &path)
+{
+	// adding or removing software changes the directory's modification time
+	QFileInfo file_info(path);
+	qint64 mtime = file_info.isDir()
+		? file_info.lastModified().toMSecsSinceEpoch()
+		: -1;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto iter = m_directories.find(path);
+		if (iter != m_directories.end() && iter->second.m_mtime == mtime)
+			return iter->second.m_contents;
+	}
+
+	// scan without holding the lock
+	set_ptr contents = mtime >= 0
+		? scan_directory(path)
+		: set_ptr();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_directories[path] = directory { mtime, contents };
+	return contents;
+}
+
+
+//-------------------------------------------------
+//  scan_directory
+//-------------------------------------------------
+
+software_availability::set_ptr software_availability::scan_directory(const QString &path)
+{
+	auto result = std::make_shared<std::unordered_set<QString>>();
+
+	// directories hold loose files and CHDs
+	QDir dir(path);
+	for (QString &name : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+		result->insert(std::move(name));
+
+	// and archives hold everything else
+	for (const QString &name : dir.entryList({ "*.zip", "*.7z" }, QDir::Files))
+		result->insert(name.left(name.lastIndexOf('.')));
+
+	return result;
+}
@@ -0,0 +1,61 @@
+/***************************************************************************
+
+	softwareavailability.h
+
+	Tracking which software list entries are present in the ROM paths
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef SOFTWAREAVAILABILITY_H
+#define SOFTWAREAVAILABILITY_H
+
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+
+// ======================> software_availability
+// MAME looks for software in <rompath>/<listname>/<software>, either as a directory or as an
+// archive; this scans those directories (never individual files) and caches the results per
+// directory, rescanning only the directories whose modification times change
+class software_availability
+{
+public:
+	typedef std::shared_ptr<const std::unordered_set<QString>> set_ptr;
+	typedef std::unordered_map<QString, set_ptr> map;
+
+	software_availability() = default;
+	software_availability(const software_availability &) = delete;
+
+	// the process-wide instance
+	static software_availability &global();
+
+	// returns the names of the software in a list that are present in the ROM paths; this hits
+	// the file system, and should not be called on the UI thread
+	set_ptr get(const QStringList &rom_paths, const QString &list_name);
+
+	// methods
+	void clear();
+
+private:
+	struct directory
+	{
+		qint64		m_mtime;
+		set_ptr		m_contents;
+	};
+
+	std::mutex									m_mutex;
+	std::unordered_map<QString, directory>		m_directories;
+
+	set_ptr get_directory(const QString &path);
+	static set_ptr scan_directory(const QString &path);
+};
+
+
+#endif // SOFTWAREAVAILABILITY_H
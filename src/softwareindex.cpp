@@ -0,0 +1,413 @@
+/***************************************************************************
+
+	softwareindex.cpp
+
+	Search index across every software list in the hash paths
+
+***************************************************************************/
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "softwareindex.h"
+#include "softwarelist.h"
+#include "utility.h"
+
+
+//**************************************************************************
+//  CONSTANTS
+//**************************************************************************
+
+#define LOG_BUILD		0
+
+static const char MANIFEST_FILE_NAME[] = "software.swlindex";
+static const quint32 MANIFEST_MAGIC = 0x49575342;		// 'BSWI'
+static const quint32 MANIFEST_VERSION = 1;
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+QEvent::Type SoftwareIndexBuiltEvent::s_eventId = (QEvent::Type) QEvent::registerEventType();
+
+
+//-------------------------------------------------
+//  build
+//-------------------------------------------------
+
+software_index software_index::build(const QStringList &hash_paths, const QString &cache_directory, const std::function<bool()> &is_cancelled)
+{
+	auto start_time = std::chrono::steady_clock::now();
+
+	// what did we have last time?
+	QString manifest_file_name = !cache_directory.isEmpty()
+		? cache_directory + "/" + MANIFEST_FILE_NAME
+		: QString();
+	software_index previous;
+	if (!manifest_file_name.isEmpty())
+		previous.load_manifest(manifest_file_name);
+
+	// enumerate the hash files; like software_list::try_load(), earlier paths win
+	std::vector<source> sources;
+	std::unordered_set<QString> seen_names;
+	for (const QString &path : hash_paths)
+	{
+		std::optional<QFileInfo> archive_info = software_list::find_hash_archive(path);
+		if (archive_info)
+		{
+			// members of an archive all share its size and timestamp
+			for (QString &list_name : software_list::hash_archive_list_names(*archive_info))
+			{
+				if (seen_names.insert(list_name).second)
+				{
+					QString member_path = archive_info->absoluteFilePath() + "/" + list_name + ".xml";
+					sources.push_back(source { std::move(list_name), std::move(member_path), path, archive_info->size(), archive_info->lastModified().toMSecsSinceEpoch(), 0, 0 });
+				}
+			}
+		}
+		else
+		{
+			for (const QFileInfo &file_info : QDir(path).entryInfoList({ "*.xml" }, QDir::Files))
+			{
+				QString list_name = file_info.completeBaseName();
+				if (seen_names.insert(list_name).second)
+					sources.push_back(source { std::move(list_name), file_info.absoluteFilePath(), path, file_info.size(), file_info.lastModified().toMSecsSinceEpoch(), 0, 0 });
+			}
+		}
+	}
+	std::sort(sources.begin(), sources.end(), [](const source &a, const source &b)
+	{
+		return a.m_list_name < b.m_list_name;
+	});
+
+	// reuse what we can from the manifest
+	std::unordered_map<QString, const source *> previous_sources;
+	for (const source &src : previous.m_sources)
+		previous_sources.emplace(src.m_path, &src);
+	std::vector<std::vector<entry>> source_entries(sources.size());
+	std::vector<size_t> stale_sources;
+	for (size_t i = 0; i < sources.size(); i++)
+	{
+		auto iter = previous_sources.find(sources[i].m_path);
+		if (iter != previous_sources.end() && iter->second->m_size == sources[i].m_size && iter->second->m_mtime == sources[i].m_mtime)
+		{
+			auto begin = previous.m_entries.begin() + iter->second->m_entries_index;
+			source_entries[i].assign(begin, begin + iter->second->m_entries_count);
+		}
+		else
+		{
+			stale_sources.push_back(i);
+		}
+	}
+
+	// and load the rest concurrently
+	std::atomic<size_t> next_index(0);
+	auto worker = [&]()
+	{
+		size_t index;
+		while (!(is_cancelled && is_cancelled()) && (index = next_index++) < stale_sources.size())
+		{
+			const source &src = sources[stale_sources[index]];
+			// the manifest already keeps what we need, so there is no point in caching the whole list
+			std::optional<software_list> softlist = software_list::try_load({ src.m_hash_path }, src.m_list_name, QString());
+			if (softlist)
+			{
+				std::vector<entry> &entries = source_entries[stale_sources[index]];
+				entries.reserve(softlist->get_software().size());
+				for (const software_list::software &sw : softlist->get_software())
+					entries.push_back(entry { src.m_list_name, sw.name(), sw.description(), sw.year(), sw.publisher() });
+			}
+		}
+	};
+	util::run_pooled(worker, stale_sources.size() > 1 ? stale_sources.size() - 1 : 0);
+
+	// a partial index is worse than none at all
+	if (is_cancelled && is_cancelled())
+		return software_index();
+
+	// assemble the index
+	software_index result;
+	for (size_t i = 0; i < sources.size(); i++)
+	{
+		sources[i].m_entries_index = (std::uint32_t)result.m_entries.size();
+		sources[i].m_entries_count = (std::uint32_t)source_entries[i].size();
+		std::move(source_entries[i].begin(), source_entries[i].end(), std::back_inserter(result.m_entries));
+	}
+	result.m_sources = std::move(sources);
+	result.build_tokens();
+
+	// and persist it if anything changed
+	if (!manifest_file_name.isEmpty() && (!stale_sources.empty() || result.m_sources.size() != previous.m_sources.size()))
+		result.save_manifest(manifest_file_name);
+
+	if (LOG_BUILD)
+	{
+		auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time);
+		qDebug("software_index::build(): %d lists (%d loaded), %d entries, %d tokens in %d ms",
+			(int)result.m_sources.size(), (int)stale_sources.size(), (int)result.m_entries.size(), (int)result.m_tokens.size(), (int)elapsed.count());
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  build_async
+//-------------------------------------------------
+
+std::future<software_index::ptr> software_index::build_async(const QStringList &hash_paths, const QString &cache_directory, std::function<bool()> &&is_cancelled, std::function<void(const ptr &)> &&on_built)
+{
+	return std::async(std::launch::async, [hash_paths, cache_directory, is_cancelled{ std::move(is_cancelled) }, on_built{ std::move(on_built) }]()
+	{
+		ptr result = std::make_shared<const software_index>(build(hash_paths, cache_directory, is_cancelled));
+		if (is_cancelled && is_cancelled())
+			return ptr();
+		if (on_built)
+			on_built(result);
+		return result;
+	});
+}
+
+
+//-------------------------------------------------
+//  search
+//-------------------------------------------------
+
+std::vector<const software_index::entry *> software_index::search(const QString &query, size_t max_results) const
+{
+	std::vector<QString> words;
+	tokenize(query, [&words](QString &&word)
+	{
+		words.push_back(std::move(word));
+	});
+
+	// every word narrows down the matches
+	std::vector<std::uint32_t> matches;
+	for (size_t i = 0; i < words.size(); i++)
+	{
+		// tokens starting with this word are contiguous
+		auto iter = std::lower_bound(m_tokens.begin(), m_tokens.end(), words[i], [](const token &t, const QString &word)
+		{
+			return t.m_text < word;
+		});
+		std::vector<std::uint32_t> word_matches;
+		for (; iter != m_tokens.end() && iter->m_text.startsWith(words[i]); iter++)
+			word_matches.push_back(iter->m_entry_index);
+		std::sort(word_matches.begin(), word_matches.end());
+		word_matches.erase(std::unique(word_matches.begin(), word_matches.end()), word_matches.end());
+
+		if (i == 0)
+		{
+			matches = std::move(word_matches);
+		}
+		else
+		{
+			std::vector<std::uint32_t> intersection;
+			std::set_intersection(matches.begin(), matches.end(), word_matches.begin(), word_matches.end(), std::back_inserter(intersection));
+			matches = std::move(intersection);
+		}
+		if (matches.empty())
+			break;
+	}
+
+	std::vector<const entry *> results;
+	results.reserve(std::min(matches.size(), max_results));
+	for (size_t i = 0; i < matches.size() && i < max_results; i++)
+		results.push_back(&m_entries[matches[i]]);
+	return results;
+}
+
+
+//-------------------------------------------------
+//  compatible_machines
+//-------------------------------------------------
+
+std::vector<info::machine> software_index::compatible_machines(const info::database &db, const QString &list_name)
+{
+	return compatible_machines(db, [&list_name](const QString &name)
+	{
+		return name == list_name;
+	});
+}
+
+
+std::vector<info::machine> software_index::compatible_machines(const info::database &db, const std::vector<const entry *> &entries)
+{
+	// results are usually spread over a handful of lists
+	std::unordered_set<QString> list_names;
+	for (const entry *e : entries)
+		list_names.insert(e->m_list_name);
+
+	return compatible_machines(db, [&list_names](const QString &name)
+	{
+		return list_names.find(name) != list_names.end();
+	});
+}
+
+
+std::vector<info::machine> software_index::compatible_machines(const info::database &db, const std::function<bool(const QString &)> &list_predicate)
+{
+	std::vector<info::machine> results;
+	for (info::machine machine : db.machines())
+	{
+		for (info::software_list softlist : machine.software_lists())
+		{
+			if (list_predicate(softlist.name()))
+			{
+				results.push_back(machine);
+				break;
+			}
+		}
+	}
+	return results;
+}
+
+
+//-------------------------------------------------
+//  build_tokens
+//-------------------------------------------------
+
+void software_index::build_tokens()
+{
+	m_tokens.clear();
+	for (std::uint32_t i = 0; i < m_entries.size(); i++)
+	{
+		auto add_token = [this, i](QString &&text)
+		{
+			m_tokens.push_back(token { std::move(text), i });
+		};
+		tokenize(m_entries[i].m_name, add_token);
+		tokenize(m_entries[i].m_description, add_token);
+		tokenize(m_entries[i].m_year, add_token);
+		tokenize(m_entries[i].m_publisher, add_token);
+	}
+
+	// sort so that prefix searches are a binary search, and drop words repeated within an entry
+	std::sort(m_tokens.begin(), m_tokens.end(), [](const token &a, const token &b)
+	{
+		return a.m_text < b.m_text || (a.m_text == b.m_text && a.m_entry_index < b.m_entry_index);
+	});
+	m_tokens.erase(std::unique(m_tokens.begin(), m_tokens.end(), [](const token &a, const token &b)
+	{
+		return a.m_entry_index == b.m_entry_index && a.m_text == b.m_text;
+	}), m_tokens.end());
+	m_tokens.shrink_to_fit();
+}
+
+
+//-------------------------------------------------
+//  tokenize - splits text into lower case words
+//-------------------------------------------------
+
+void software_index::tokenize(const QString &text, const std::function<void(QString &&)> &func)
+{
+	QString word;
+	for (QChar ch : text)
+	{
+		if (ch.isLetterOrNumber())
+		{
+			word += ch.toLower();
+		}
+		else if (!word.isEmpty())
+		{
+			func(std::move(word));
+			word = QString();
+		}
+	}
+	if (!word.isEmpty())
+		func(std::move(word));
+}
+
+
+//-------------------------------------------------
+//  load_manifest
+//-------------------------------------------------
+
+bool software_index::load_manifest(const QString &file_name)
+{
+	QFile file(file_name);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_0);
+	quint32 magic, version, source_count;
+	stream >> magic >> version >> source_count;
+	if (stream.status() != QDataStream::Ok || magic != MANIFEST_MAGIC || version != MANIFEST_VERSION)
+		return false;
+
+	for (quint32 i = 0; stream.status() == QDataStream::Ok && i < source_count; i++)
+	{
+		source &src = m_sources.emplace_back();
+		quint32 entries_count;
+		stream >> src.m_list_name >> src.m_path >> src.m_size >> src.m_mtime >> entries_count;
+		src.m_entries_index = (std::uint32_t)m_entries.size();
+		src.m_entries_count = entries_count;
+
+		for (quint32 j = 0; stream.status() == QDataStream::Ok && j < entries_count; j++)
+		{
+			entry &e = m_entries.emplace_back();
+			e.m_list_name = src.m_list_name;
+			stream >> e.m_name >> e.m_description >> e.m_year >> e.m_publisher;
+		}
+	}
+
+	// anything short of a complete read and we start from scratch
+	if (stream.status() != QDataStream::Ok)
+	{
+		m_sources.clear();
+		m_entries.clear();
+		return false;
+	}
+	return true;
+}
+
+
+//-------------------------------------------------
+//  save_manifest
+//-------------------------------------------------
+
+bool software_index::save_manifest(const QString &file_name) const
+{
+	QSaveFile file(file_name);
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_0);
+	stream << MANIFEST_MAGIC << MANIFEST_VERSION << (quint32)m_sources.size();
+	for (const source &src : m_sources)
+	{
+		stream << src.m_list_name << src.m_path << src.m_size << src.m_mtime << (quint32)src.m_entries_count;
+		for (std::uint32_t i = 0; i < src.m_entries_count; i++)
+		{
+			const entry &e = m_entries[src.m_entries_index + i];
+			stream << e.m_name << e.m_description << e.m_year << e.m_publisher;
+		}
+	}
+	return stream.status() == QDataStream::Ok && file.commit();
+}
+
+
+//-------------------------------------------------
+//  SoftwareIndexBuiltEvent ctor
+//-------------------------------------------------
+
+SoftwareIndexBuiltEvent::SoftwareIndexBuiltEvent(std::uint64_t generation, software_index::ptr &&index)
+	: QEvent(eventId())
+	, m_generation(generation)
+	, m_index(std::move(index))
+{
+}
@@ -0,0 +1,120 @@
+/***************************************************************************
+
+	softwareindex.h
+
+	Search index across every software list in the hash paths
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef SOFTWAREINDEX_H
+#define SOFTWAREINDEX_H
+
+#include <QEvent>
+#include <QString>
+#include <QStringList>
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "info.h"
+
+
+// ======================> software_index
+class software_index
+{
+public:
+	class test;
+	typedef std::shared_ptr<const software_index> ptr;
+
+	struct entry
+	{
+		QString			m_list_name;
+		QString			m_name;
+		QString			m_description;
+		QString			m_year;
+		QString			m_publisher;
+	};
+
+	software_index() = default;
+	software_index(const software_index &) = delete;
+	software_index(software_index &&) = default;
+	software_index &operator=(software_index &&) = default;
+
+	// builds an index of every software list in the hash paths; if a cache directory is specified
+	// the index is persisted there, and lists whose hash files did not change since then are not
+	// loaded again
+	static software_index build(const QStringList &hash_paths, const QString &cache_directory, const std::function<bool()> &is_cancelled = { });
+
+	// builds the index on a background thread, calling on_built there with the result unless the
+	// build is cancelled (in which case the future holds null)
+	static std::future<ptr> build_async(const QStringList &hash_paths, const QString &cache_directory, std::function<bool()> &&is_cancelled = { }, std::function<void(const ptr &)> &&on_built = { });
+
+	// accessors
+	const std::vector<entry> &entries() const { return m_entries; }
+
+	// finds the entries that have a word starting with each word in the query; matching is
+	// case insensitive and results are in list order
+	std::vector<const entry *> search(const QString &query, size_t max_results = ~(size_t)0) const;
+
+	// finds the machines that can use a particular software list, or any of the lists of a set
+	// of search results
+	static std::vector<info::machine> compatible_machines(const info::database &db, const QString &list_name);
+	static std::vector<info::machine> compatible_machines(const info::database &db, const std::vector<const entry *> &entries);
+
+private:
+	struct source
+	{
+		QString			m_list_name;
+		QString			m_path;
+		QString			m_hash_path;		// not persisted
+		qint64			m_size;
+		qint64			m_mtime;
+		std::uint32_t	m_entries_index;
+		std::uint32_t	m_entries_count;
+	};
+
+	struct token
+	{
+		QString			m_text;
+		std::uint32_t	m_entry_index;
+	};
+
+	std::vector<source>		m_sources;
+	std::vector<entry>		m_entries;
+	std::vector<token>		m_tokens;		// sorted by text
+
+	// methods
+	void build_tokens();
+	bool load_manifest(const QString &file_name);
+	bool save_manifest(const QString &file_name) const;
+	static void tokenize(const QString &text, const std::function<void(QString &&)> &func);
+	static std::vector<info::machine> compatible_machines(const info::database &db, const std::function<bool(const QString &)> &list_predicate);
+};
+
+
+// ======================> SoftwareIndexBuiltEvent
+
+class SoftwareIndexBuiltEvent : public QEvent
+{
+public:
+	// ctor
+	SoftwareIndexBuiltEvent(std::uint64_t generation, software_index::ptr &&index);
+
+	// accessors
+	static QEvent::Type eventId()					{ return s_eventId; }
+	std::uint64_t generation() const				{ return m_generation; }
+	software_index::ptr &index()					{ return m_index; }
+
+private:
+	static QEvent::Type		s_eventId;
+	std::uint64_t			m_generation;
+	software_index::ptr		m_index;
+};
+
+
+#endif // SOFTWAREINDEX_H
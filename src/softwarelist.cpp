@@ -6,61 +6,388 @@
 
 ***************************************************************************/
 
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
+
+#include <atomic>
+#include <tuple>
+
 #include "softwarelist.h"
 #include "prefs.h"
 #include "xmlparser.h"
+#include "quazip/quazip.h"
+#include "quazip/quazipfile.h"
+
+
+//**************************************************************************
+//  CONSTANTS
+//**************************************************************************
+
+#define LOG_LOAD_TIMES		0
+
+
+//**************************************************************************
+//  BINARY CACHE REPRESENTATION
+//**************************************************************************
+
+namespace
+{
+	namespace cache_binaries
+	{
+		const std::uint32_t MAGIC_CACHE = 0x4C575342;		// 'BSWL'
+		const std::uint32_t CACHE_VERSION = 1;
+
+		struct header
+		{
+			std::uint32_t	m_magic;
+			std::uint32_t	m_version;
+			std::uint8_t	m_size_header;
+			std::uint8_t	m_size_software;
+			std::uint8_t	m_size_part;
+			std::uint8_t	m_reserved;
+			std::uint32_t	m_source_path_strindex;
+			std::uint64_t	m_source_size;
+			std::int64_t	m_source_mtime;
+			std::uint32_t	m_name_strindex;
+			std::uint32_t	m_description_strindex;
+			std::uint32_t	m_software_count;
+			std::uint32_t	m_parts_count;
+			std::uint32_t	m_string_table_size;
+		};
+
+		// the tables follow the header, and are used in place
+		static_assert(sizeof(header) % alignof(software_list::binaries::software) == 0);
+		static_assert(sizeof(software_list::binaries::software) % alignof(software_list::binaries::part) == 0);
+	};
+
+	//-------------------------------------------------
+	//  append_string - appends a string to a string
+	//	table, returning its offset
+	//-------------------------------------------------
+
+	std::uint32_t append_string(std::vector<std::uint8_t> &data, const QString &s)
+	{
+		// strings are stored as UTF-16 with a length prefix, and padded to keep every entry aligned
+		std::uint32_t result = util::safe_static_cast<std::uint32_t>(data.size());
+		std::uint32_t length = util::safe_static_cast<std::uint32_t>(s.size());
+		size_t entry_size = (sizeof(length) + length * sizeof(QChar) + 3) & ~3;
+		data.resize(data.size() + entry_size, 0);
+		memcpy(&data[result], &length, sizeof(length));
+		memcpy(&data[result + sizeof(length)], s.constData(), length * sizeof(QChar));
+		return result;
+	}
+
+	// ======================> cache_string_table_reader
+	// bounds checks the strings of a compiled software list; this came off of the disk, so we
+	// check every string once up front rather than every time that one is decoded
+	class cache_string_table_reader
+	{
+	public:
+		cache_string_table_reader(const std::uint8_t *data, size_t size)
+			: m_data(data)
+			, m_size(size)
+		{
+		}
+
+		bool is_valid(std::uint32_t strindex) const
+		{
+			std::uint32_t length;
+			if ((strindex & 3) || size_t(strindex) + sizeof(length) > m_size)
+				return false;
+			memcpy(&length, m_data + strindex, sizeof(length));
+			return size_t(length) * sizeof(QChar) <= m_size - strindex - sizeof(length);
+		}
+
+		bool get(std::uint32_t strindex, QString &result) const
+		{
+			if (!is_valid(strindex))
+				return false;
+			std::uint32_t length;
+			memcpy(&length, m_data + strindex, sizeof(length));
+			result = QString(reinterpret_cast<const QChar *>(m_data + strindex + sizeof(length)), util::safe_static_cast<int>(length));
+			return true;
+		}
+
+	private:
+		const std::uint8_t *	m_data;
+		size_t					m_size;
+	};
+
+	// ======================> hash_archive_index
+	// maps software list names to their entries in the central directory of a zipped hash
+	// archive; QuaZip::setCurrentFile() walks the central directory, which is slow for archives
+	// holding thousands of lists, so we walk it once and remember where everything is
+	class hash_archive_index
+	{
+	public:
+		typedef std::shared_ptr<const hash_archive_index> ptr;
+
+		// returns the index for an archive, building it if the archive is new or changed
+		static ptr get(const QFileInfo &archive_info)
+		{
+			static std::mutex s_mutex;
+			static std::unordered_map<QString, std::tuple<qint64, QDateTime, ptr>> s_indexes;
+
+			// building under the lock is deliberate; when loading lists concurrently, every
+			// worker is likely to want the same archive at the same time
+			std::lock_guard<std::mutex> lock(s_mutex);
+			std::tuple<qint64, QDateTime, ptr> &entry = s_indexes[archive_info.absoluteFilePath()];
+			if (!std::get<2>(entry) || std::get<0>(entry) != archive_info.size() || std::get<1>(entry) != archive_info.lastModified())
+			{
+				auto index = std::make_shared<hash_archive_index>();
+				index->build(archive_info.absoluteFilePath());
+				entry = std::make_tuple(archive_info.size(), archive_info.lastModified(), std::move(index));
+			}
+			return std::get<2>(entry);
+		}
+
+		const unz64_file_pos *find(const QString &softlist_name) const
+		{
+			auto iter = m_members.find(softlist_name);
+			return iter != m_members.end()
+				? &iter->second
+				: nullptr;
+		}
+
+		QStringList list_names() const
+		{
+			QStringList results;
+			for (const auto &pair : m_members)
+				results.push_back(pair.first);
+			return results;
+		}
+
+	private:
+		std::unordered_map<QString, unz64_file_pos>	m_members;
+
+		void build(const QString &archive_path)
+		{
+			QuaZip zip(archive_path);
+			if (!zip.open(QuaZip::Mode::mdUnzip))
+				return;
+
+			// lists are found by their base name wherever they are in the archive, so both
+			// 'hash.zip/hash/a2600.xml' and 'hash.zip/a2600.xml' work; the first one wins
+			for (bool more = zip.goToFirstFile(); more; more = zip.goToNextFile())
+			{
+				QString file_name = zip.getCurrentFileName();
+				unz64_file_pos pos;
+				if (file_name.endsWith(".xml", Qt::CaseInsensitive) && unzGetFilePos64(zip.getUnzFile(), &pos) == UNZ_OK)
+					m_members.emplace(QFileInfo(file_name).completeBaseName(), pos);
+			}
+		}
+	};
+
+	// ======================> hash_archive_member
+	// a single hash file within an archive; it is inflated as it is read, so the parser never
+	// needs the whole thing in memory
+	class hash_archive_member
+	{
+	public:
+		hash_archive_member(const QString &archive_path)
+			: m_zip(archive_path)
+			, m_file(&m_zip)
+		{
+		}
+
+		bool open(const unz64_file_pos &pos)
+		{
+			// we position the zip on the member ourselves; goToFirstFile() is only there so that
+			// QuaZip considers there to be a current file
+			return m_zip.open(QuaZip::Mode::mdUnzip)
+				&& m_zip.goToFirstFile()
+				&& unzGoToFilePos64(m_zip.getUnzFile(), &pos) == UNZ_OK
+				&& m_file.open(QIODevice::ReadOnly);
+		}
+
+		QIODevice &device() { return m_file; }
+
+	private:
+		QuaZip		m_zip;
+		QuaZipFile	m_file;
+	};
+
+	// ======================> hash_source
+	// where a particular software list was found in the hash paths
+	struct hash_source
+	{
+		QString						m_hash_path;		// the hash path that had the list
+		QFileInfo					m_file_info;		// the XML file, or the archive that contains it
+		hash_archive_index::ptr		m_archive_index;	// non-null if in an archive
+		const unz64_file_pos *		m_archive_pos;
+	};
+
+	//-------------------------------------------------
+	//  find_hash_sources - finds every place in the
+	//	hash paths that has a particular list, in order
+	//	of precedence
+	//-------------------------------------------------
+
+	std::vector<hash_source> find_hash_sources(const QStringList &hash_paths, const QString &softlist_name)
+	{
+		std::vector<hash_source> results;
+		for (const QString &path : hash_paths)
+		{
+			std::optional<QFileInfo> archive_info = software_list::find_hash_archive(path);
+			if (archive_info)
+			{
+				hash_archive_index::ptr index = hash_archive_index::get(*archive_info);
+				const unz64_file_pos *pos = index->find(softlist_name);
+				if (pos)
+					results.push_back(hash_source { path, std::move(*archive_info), std::move(index), pos });
+			}
+			else
+			{
+				QFileInfo file_info(path + "/" + softlist_name + ".xml");
+				if (file_info.isFile())
+					results.push_back(hash_source { path, std::move(file_info), { }, nullptr });
+			}
+		}
+		return results;
+	}
+};
+
+
+//**************************************************************************
+//  SOFTWARE LIST BUILDER
+//**************************************************************************
+
+// ======================> software_list::builder
+// accumulates software and parts while a list is being loaded, interning their strings, and
+// then lays out the final tables
+class software_list::builder
+{
+public:
+	builder()
+	{
+		// the empty string is always offset zero
+		intern(QString());
+	}
+
+	std::uint32_t intern(const QString &s)
+	{
+		auto iter = m_lookup.find(s);
+		if (iter != m_lookup.end())
+			return iter->second;
+
+		std::uint32_t result = append_string(m_strings, s);
+		m_lookup.emplace(s, result);
+		return result;
+	}
+
+	binaries::software &add_software(std::uint32_t name)
+	{
+		return m_software.emplace_back(binaries::software { name, 0, 0, 0, util::safe_static_cast<std::uint32_t>(m_parts.size()), 0 });
+	}
+
+	binaries::software &last_software()
+	{
+		assert(!m_software.empty());
+		return util::last(m_software);
+	}
+
+	void add_part(std::uint32_t name, std::uint32_t interface_name)
+	{
+		assert(!m_software.empty());
+		m_parts.emplace_back(binaries::part { name, interface_name });
+		util::last(m_software).m_parts_count++;
+	}
+
+	void reserve(size_t software_count, size_t parts_count)
+	{
+		m_software.reserve(software_count);
+		m_parts.reserve(parts_count);
+	}
+
+	// lays everything out in the list; the builder is spent afterwards
+	void finish(software_list &list)
+	{
+		size_t software_size = m_software.size() * sizeof(m_software[0]);
+		size_t parts_size = m_parts.size() * sizeof(m_parts[0]);
+		std::vector<std::uint8_t> data(software_size + parts_size + m_strings.size());
+		memcpy(data.data(), m_software.data(), software_size);
+		memcpy(data.data() + software_size, m_parts.data(), parts_size);
+		memcpy(data.data() + software_size + parts_size, m_strings.data(), m_strings.size());
+
+		list.m_data = table_storage(std::move(data));
+
+		list.m_software_count = util::safe_static_cast<std::uint32_t>(m_software.size());
+		list.m_parts_offset = software_size;
+		list.m_parts_count = util::safe_static_cast<std::uint32_t>(m_parts.size());
+		list.m_string_table_offset = software_size + parts_size;
+		list.m_lazy = std::make_unique<lazy_state>();
+	}
+
+private:
+	std::vector<std::uint8_t>					m_strings;
+	std::unordered_map<QString, std::uint32_t>	m_lookup;
+	std::vector<binaries::software>				m_software;
+	std::vector<binaries::part>					m_parts;
+};
 
 
 //**************************************************************************
 //  SOFTWARE LIST
 //**************************************************************************
 
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+software_list::software_list()
+	: m_software_count(0)
+	, m_parts_offset(0)
+	, m_parts_count(0)
+	, m_string_table_offset(0)
+	, m_lazy(std::make_unique<lazy_state>())
+{
+}
+
+
 //-------------------------------------------------
 //  load
 //-------------------------------------------------
 
 bool software_list::load(QDataStream &stream, QString &error_message)
 {
+	builder b;
 	XmlParser xml;
-	std::string current_device_extensions;
 	xml.OnElementBegin({ "softwarelist" }, [this](const XmlParser::Attributes &attributes)
 	{
 		attributes.Get("name", m_name);
 		attributes.Get("description", m_description);
 	});
-	xml.OnElementBegin({ "softwarelist", "software" }, [this](const XmlParser::Attributes &attributes)
+	xml.OnElementBegin({ "softwarelist", "software" }, [&b](const XmlParser::Attributes &attributes)
 	{
-		software &s = m_software.emplace_back();
-		attributes.Get("name", s.m_name);
-		s.m_parts.reserve(16);
+		QString name;
+		attributes.Get("name", name);
+		b.add_software(b.intern(name));
 	});
-	xml.OnElementEnd({ "softwarelist", "software" }, [this](QString &&)
+	xml.OnElementEnd({ "softwarelist", "software", "description" }, [&b](QString &&content)
 	{
-		util::last(m_software).m_parts.shrink_to_fit();
+		b.last_software().m_description_strindex = b.intern(content);
 	});
-	xml.OnElementEnd({ "softwarelist", "software", "description" }, [this](QString &&content)
+	xml.OnElementEnd({ "softwarelist", "software", "year" }, [&b](QString &&content)
 	{
-		util::last(m_software).m_description = std::move(content);
+		b.last_software().m_year_strindex = b.intern(content);
 	});
-	xml.OnElementEnd({ "softwarelist", "software", "year" }, [this](QString &&content)
+	xml.OnElementEnd({ "softwarelist", "software", "publisher" }, [&b](QString &&content)
 	{
-		util::last(m_software).m_year = std::move(content);
+		b.last_software().m_publisher_strindex = b.intern(content);
 	});
-	xml.OnElementEnd({ "softwarelist", "software", "publisher" }, [this](QString &&content)
+	xml.OnElementBegin({ "softwarelist", "software", "part" }, [&b](const XmlParser::Attributes &attributes)
 	{
-		util::last(m_software).m_publisher = std::move(content);
-	});
-	xml.OnElementBegin({ "softwarelist", "software", "part" }, [this](const XmlParser::Attributes &attributes)
-	{
-		part &p = util::last(m_software).m_parts.emplace_back();
-		attributes.Get("name", p.m_name);
-		attributes.Get("interface", p.m_interface);
+		QString name, interface_name;
+		attributes.Get("name", name);
+		attributes.Get("interface", interface_name);
+		b.add_part(b.intern(name), b.intern(interface_name));
 	});
 
 	// parse the XML, but be bold and try to reserve lots of space
-	m_software.reserve(4000);
+	b.reserve(4000, 6000);
 	bool success = xml.Parse(stream);
-	m_software.shrink_to_fit();
+	b.finish(*this);
 
 	// did we succeed?
 	if (!success)
@@ -75,31 +402,439 @@ bool software_list::load(QDataStream &stream, QString &error_message)
 
 
 //-------------------------------------------------
-//  try_load
+//  get_string
 //-------------------------------------------------
 
-std::optional<software_list> software_list::try_load(const QStringList &hash_paths, const QString &softlist_name)
+const QString &software_list::get_string(std::uint32_t strindex) const
 {
-	for (const QString &path : hash_paths)
+	if (m_string_table_offset + strindex >= m_data.size())
+		throw false;
+
+	std::lock_guard<std::mutex> lock(m_lazy->m_strings_mutex);
+	auto iter = m_lazy->m_strings.find(strindex);
+	if (iter == m_lazy->m_strings.end())
 	{
-		QString full_path = path + "/" + softlist_name + ".xml";
-		QFile file(full_path);
+		const std::uint8_t *entry = m_data.data() + m_string_table_offset + strindex;
+		std::uint32_t length;
+		memcpy(&length, entry, sizeof(length));
+		QString s(reinterpret_cast<const QChar *>(entry + sizeof(length)), util::safe_static_cast<int>(length));
+		iter = m_lazy->m_strings.emplace(strindex, std::move(s)).first;
+	}
+	return iter->second;
+}
 
-		if (file.open(QIODevice::ReadOnly))
+
+//-------------------------------------------------
+//  find_software
+//-------------------------------------------------
+
+std::optional<software_list::software> software_list::find_software(const QString &name) const
+{
+	// the index is built the first time that it is needed
+	std::call_once(m_lazy->m_software_index_once, [this]()
+	{
+		m_lazy->m_software_index.reserve(m_software_count);
+		for (std::uint32_t i = 0; i < m_software_count; i++)
 		{
-			software_list softlist;
-			QString error_message;
-			QDataStream file_stream(&file);
+			// if names are duplicated, the first one wins just like it would in a linear search
+			m_lazy->m_software_index.emplace(get_software()[i].name(), i);
+		}
+	});
 
-			if (file_stream.status() == QDataStream::Status::Ok && softlist.load(file_stream, error_message))
+	auto iter = m_lazy->m_software_index.find(name);
+	return iter != m_lazy->m_software_index.end()
+		? get_software()[iter->second]
+		: std::optional<software>();
+}
+
+
+//-------------------------------------------------
+//  estimated_size - approximate number of bytes
+//	that this list occupies in memory
+//-------------------------------------------------
+
+size_t software_list::estimated_size() const
+{
+	// strings are interned in the string table; copies of the ones that are asked for are made
+	// as they are, but most lists are only ever looked at in part (a mapped cache is counted
+	// too, even though its pages can be dropped and read back in)
+	size_t result = sizeof(*this) + sizeof(lazy_state) + (m_name.size() + m_description.size()) * sizeof(QChar) + m_data.size();
+
+	// the name index is built as soon as anything is looked up, and shares the names' storage
+	result += m_software_count * (sizeof(QString) + sizeof(std::uint32_t) + 3 * sizeof(void *));
+	return result;
+}
+
+
+//-------------------------------------------------
+//  try_load
+//-------------------------------------------------
+
+std::optional<software_list> software_list::try_load(const QStringList &hash_paths, const QString &softlist_name, const QString &cache_directory)
+{
+	QString cache_file_name = !cache_directory.isEmpty()
+		? cache_directory + "/" + softlist_name + ".swlcache"
+		: QString();
+
+	for (const hash_source &source : find_hash_sources(hash_paths, softlist_name))
+	{
+		// try the compiled copy first; for archives, this is keyed on the archive itself
+		if (!cache_file_name.isEmpty())
+		{
+			software_list softlist;
+			if (softlist.load_cache(cache_file_name, source.m_file_info))
 				return std::move(softlist);
 		}
+
+		// and parse the XML
+		software_list softlist;
+		QString error_message;
+		auto load_from_device = [&softlist, &error_message](QIODevice &device)
+		{
+			QDataStream stream(&device);
+			return stream.status() == QDataStream::Status::Ok && softlist.load(stream, error_message);
+		};
+		bool success;
+		if (source.m_archive_index)
+		{
+			hash_archive_member member(source.m_file_info.absoluteFilePath());
+			success = member.open(*source.m_archive_pos) && load_from_device(member.device());
+		}
+		else
+		{
+			QFile file(source.m_file_info.absoluteFilePath());
+			success = file.open(QIODevice::ReadOnly) && load_from_device(file);
+		}
+
+		if (success)
+		{
+			// failing to write the cache is not fatal; we will just parse again next time
+			if (!cache_file_name.isEmpty())
+				softlist.save_cache(cache_file_name, source.m_file_info);
+			return std::move(softlist);
+		}
 	}
 
 	return { };
 }
 
 
+//-------------------------------------------------
+//  find_hash_archive - finds the zipped archive of
+//	hash files that a hash path refers to, if any
+//-------------------------------------------------
+
+std::optional<QFileInfo> software_list::find_hash_archive(const QString &path)
+{
+	QFileInfo path_info(path);
+	if (path_info.isDir())
+		return { };
+	if (!path_info.isFile())
+		path_info = QFileInfo(path + ".zip");
+	if (!path_info.isFile() || path_info.suffix().compare("zip", Qt::CaseInsensitive) != 0)
+		return { };
+	return path_info;
+}
+
+
+//-------------------------------------------------
+//  hash_archive_list_names - lists the software
+//	lists in a zipped archive of hash files
+//-------------------------------------------------
+
+QStringList software_list::hash_archive_list_names(const QFileInfo &archive_info)
+{
+	return hash_archive_index::get(archive_info)->list_names();
+}
+
+
+//-------------------------------------------------
+//  load_cache - loads a compiled software list,
+//	provided that it was compiled from the current
+//	version of the source; the tables are laid out
+//	just like they are in memory, so the file stays
+//	mapped and they are used where they are
+//-------------------------------------------------
+
+bool software_list::load_cache(const QString &cache_file_name, const QFileInfo &source)
+{
+	// map the cache file
+	auto file = std::make_unique<QFile>(cache_file_name);
+	if (!file->open(QIODevice::ReadOnly) || file->size() < (qint64)sizeof(cache_binaries::header))
+		return false;
+	size_t size = util::safe_static_cast<size_t>(file->size());
+	const std::uint8_t *data = file->map(0, file->size());
+	if (!data)
+		return false;
+
+	// check the header
+	cache_binaries::header hdr;
+	memcpy(&hdr, data, sizeof(hdr));
+	bool success = hdr.m_magic == cache_binaries::MAGIC_CACHE
+		&& hdr.m_version == cache_binaries::CACHE_VERSION
+		&& hdr.m_size_header == sizeof(cache_binaries::header)
+		&& hdr.m_size_software == sizeof(binaries::software)
+		&& hdr.m_size_part == sizeof(binaries::part)
+		&& hdr.m_source_size == (std::uint64_t)source.size()
+		&& hdr.m_source_mtime == source.lastModified().toMSecsSinceEpoch();
+
+	// check the table sizes
+	size_t software_offset	= sizeof(cache_binaries::header);
+	size_t parts_offset		= software_offset	+ (size_t(hdr.m_software_count)	* sizeof(binaries::software));
+	size_t strings_offset	= parts_offset		+ (size_t(hdr.m_parts_count)		* sizeof(binaries::part));
+	success = success && strings_offset + hdr.m_string_table_size == size;
+
+	// the cache is keyed by the full path of the source too
+	cache_string_table_reader strings(success ? data + strings_offset : data, success ? hdr.m_string_table_size : 0);
+	QString source_path;
+	success = success
+		&& strings.get(hdr.m_source_path_strindex, source_path)
+		&& source_path == source.absoluteFilePath()
+		&& strings.get(hdr.m_name_strindex, m_name)
+		&& strings.get(hdr.m_description_strindex, m_description);
+
+	// strings are decoded as they are asked for, so everything that refers to one has to be
+	// checked now
+	for (std::uint32_t i = 0; success && i < hdr.m_software_count; i++)
+	{
+		binaries::software bin_software;
+		memcpy(&bin_software, data + software_offset + i * sizeof(bin_software), sizeof(bin_software));
+		success = strings.is_valid(bin_software.m_name_strindex)
+			&& strings.is_valid(bin_software.m_description_strindex)
+			&& strings.is_valid(bin_software.m_year_strindex)
+			&& strings.is_valid(bin_software.m_publisher_strindex)
+			&& size_t(bin_software.m_parts_index) + bin_software.m_parts_count <= hdr.m_parts_count;
+	}
+	for (std::uint32_t i = 0; success && i < hdr.m_parts_count; i++)
+	{
+		binaries::part bin_part;
+		memcpy(&bin_part, data + parts_offset + i * sizeof(bin_part), sizeof(bin_part));
+		success = strings.is_valid(bin_part.m_name_strindex)
+			&& strings.is_valid(bin_part.m_interface_strindex);
+	}
+
+	// and take the tables as they are; the mapping goes away with the file
+	if (success)
+	{
+		m_data = table_storage(std::move(file), data + software_offset, size - software_offset);
+		m_software_count = hdr.m_software_count;
+		m_parts_offset = parts_offset - software_offset;
+		m_parts_count = hdr.m_parts_count;
+		m_string_table_offset = strings_offset - software_offset;
+		m_lazy = std::make_unique<lazy_state>();
+	}
+	else
+	{
+		m_name.clear();
+		m_description.clear();
+	}
+	return success;
+}
+
+
+//-------------------------------------------------
+//  save_cache - writes out a compiled copy of this
+//	software list
+//-------------------------------------------------
+
+bool software_list::save_cache(const QString &cache_file_name, const QFileInfo &source) const
+{
+	// the string table is ours, with the strings that only the header refers to on the end
+	std::vector<std::uint8_t> strings(m_data.data() + m_string_table_offset, m_data.data() + m_data.size());
+
+	// build the header
+	cache_binaries::header hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.m_magic					= cache_binaries::MAGIC_CACHE;
+	hdr.m_version				= cache_binaries::CACHE_VERSION;
+	hdr.m_size_header			= sizeof(cache_binaries::header);
+	hdr.m_size_software			= sizeof(binaries::software);
+	hdr.m_size_part				= sizeof(binaries::part);
+	hdr.m_source_path_strindex	= append_string(strings, source.absoluteFilePath());
+	hdr.m_source_size			= (std::uint64_t)source.size();
+	hdr.m_source_mtime			= source.lastModified().toMSecsSinceEpoch();
+	hdr.m_name_strindex			= append_string(strings, m_name);
+	hdr.m_description_strindex	= append_string(strings, m_description);
+	hdr.m_software_count		= m_software_count;
+	hdr.m_parts_count			= m_parts_count;
+	hdr.m_string_table_size		= util::safe_static_cast<std::uint32_t>(strings.size());
+
+	// and write it out; QSaveFile ensures that nobody will map a partially written file
+	QSaveFile file(cache_file_name);
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
+	file.write((const char *)&hdr, sizeof(hdr));
+	file.write((const char *)m_data.data(), m_string_table_offset);
+	file.write((const char *)strings.data(), strings.size());
+	return file.commit();
+}
+
+
+//**************************************************************************
+//  SOFTWARE LIST CACHE
+//**************************************************************************
+
+//-------------------------------------------------
+//  software_list_cache ctor
+//-------------------------------------------------
+
+software_list_cache::software_list_cache(size_t budget)
+	: m_budget(budget)
+	, m_resident_size(0)
+{
+}
+
+
+//-------------------------------------------------
+//  software_list_cache::global
+//-------------------------------------------------
+
+software_list_cache &software_list_cache::global()
+{
+	static software_list_cache s_instance;
+	return s_instance;
+}
+
+
+//-------------------------------------------------
+//  software_list_cache::get
+//-------------------------------------------------
+
+software_list::ptr software_list_cache::get(const QStringList &hash_paths, const QString &softlist_name, const QString &cache_directory)
+{
+	// go through the hash files in the same order as software_list::try_load(), so that one
+	// that cannot be loaded falls back to the next
+	for (const hash_source &source : find_hash_sources(hash_paths, softlist_name))
+	{
+		QString path = source.m_archive_index
+			? source.m_file_info.absoluteFilePath() + "/" + softlist_name + ".xml"
+			: source.m_file_info.absoluteFilePath();
+		qint64 source_size = source.m_file_info.size();
+		QDateTime source_mtime = source.m_file_info.lastModified();
+
+		// is this list resident, and current?
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto map_iter = m_map.find(path);
+			if (map_iter != m_map.end())
+			{
+				entry_list::iterator entry_iter = map_iter->second;
+				if (entry_iter->m_source_size == source_size && entry_iter->m_source_mtime == source_mtime)
+				{
+					m_entries.splice(m_entries.begin(), m_entries, entry_iter);
+					return entry_iter->m_softlist;
+				}
+
+				// the hash file changed underneath us
+				m_resident_size -= entry_iter->m_size;
+				m_entries.erase(entry_iter);
+				m_map.erase(map_iter);
+			}
+		}
+
+		// load it without holding the lock; if another thread loads the same list at the same
+		// time, whoever finishes last wins
+		std::optional<software_list> softlist = software_list::try_load({ source.m_hash_path }, softlist_name, cache_directory);
+		if (!softlist)
+			continue;
+		size_t size = softlist->estimated_size();
+		software_list::ptr result = std::make_shared<const software_list>(std::move(softlist.value()));
+
+		// and make it resident, keyed on where it actually came from
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto map_iter = m_map.find(path);
+		if (map_iter != m_map.end())
+		{
+			m_resident_size -= map_iter->second->m_size;
+			m_entries.erase(map_iter->second);
+			m_map.erase(map_iter);
+		}
+		m_entries.push_front(entry { std::move(path), source_size, std::move(source_mtime), result, size });
+		m_map.emplace(m_entries.front().m_path, m_entries.begin());
+		m_resident_size += size;
+		trim();
+		return result;
+	}
+	return { };
+}
+
+
+//-------------------------------------------------
+//  software_list_cache::budget
+//-------------------------------------------------
+
+size_t software_list_cache::budget() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_budget;
+}
+
+
+//-------------------------------------------------
+//  software_list_cache::resident_size
+//-------------------------------------------------
+
+size_t software_list_cache::resident_size() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_resident_size;
+}
+
+
+//-------------------------------------------------
+//  software_list_cache::resident_count
+//-------------------------------------------------
+
+size_t software_list_cache::resident_count() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_entries.size();
+}
+
+
+//-------------------------------------------------
+//  software_list_cache::set_budget
+//-------------------------------------------------
+
+void software_list_cache::set_budget(size_t budget)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_budget = budget;
+	trim();
+}
+
+
+//-------------------------------------------------
+//  software_list_cache::clear
+//-------------------------------------------------
+
+void software_list_cache::clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_entries.clear();
+	m_map.clear();
+	m_resident_size = 0;
+}
+
+
+//-------------------------------------------------
+//  software_list_cache::trim - evicts the least
+//	recently used lists until we are within budget;
+//	the most recent list is always kept
+//-------------------------------------------------
+
+void software_list_cache::trim()
+{
+	while (m_resident_size > m_budget && m_entries.size() > 1)
+	{
+		const entry &victim = m_entries.back();
+		m_resident_size -= victim.m_size;
+		m_map.erase(victim.m_path);
+		m_entries.pop_back();
+	}
+}
+
+
 //**************************************************************************
 //  SOFTWARE LIST COLLECTION
 //**************************************************************************
@@ -110,13 +845,49 @@ std::optional<software_list> software_list::try_load(const QStringList &hash_pat
 
 void software_list_collection::load(const Preferences &prefs, info::machine machine)
 {
-	m_software_lists.clear();
-	QStringList hash_paths = prefs.GetSplitPaths(Preferences::global_path_type::HASH);
+	// gather the names here; the info DB is not safe to access from the loading threads
+	std::vector<QString> softlist_names;
 	for (const info::software_list softlist_info : machine.software_lists())
+		softlist_names.push_back(softlist_info.name());
+
+	load(prefs.GetSplitPaths(Preferences::global_path_type::HASH), Preferences::GetSoftwareListCacheDirectory(), softlist_names);
+}
+
+
+void software_list_collection::load(const QStringList &hash_paths, const QString &cache_directory, const std::vector<QString> &softlist_names, const std::function<bool()> &is_cancelled)
+{
+	m_software_lists.clear();
+
+	// computers can easily reference a dozen lists, so load them concurrently; each worker
+	// claims the next unloaded list until there are none left (or until we are cancelled);
+	// lists that other machines loaded recently come straight out of the cache
+	software_list_cache &cache = software_list_cache::global();
+	std::vector<software_list::ptr> results(softlist_names.size());
+	std::atomic<size_t> next_index(0);
+	std::function<void()> worker = [&]()
 	{
-		std::optional<software_list> softlist = software_list::try_load(hash_paths, softlist_info.name());
-		if (softlist.has_value())
-			m_software_lists.push_back(std::move(softlist.value()));
+		size_t index;
+		while (!(is_cancelled && is_cancelled()) && (index = next_index++) < softlist_names.size())
+		{
+			auto start_time = std::chrono::steady_clock::now();
+			results[index] = cache.get(hash_paths, softlist_names[index], cache_directory);
+			auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time);
+
+			if (LOG_LOAD_TIMES)
+				qDebug("software_list_collection::load(): %s took %.3f ms", softlist_names[index].toLocal8Bit().constData(), elapsed.count() / 1.0e6);
+			if (m_on_list_loaded)
+				m_on_list_loaded(softlist_names[index], results[index] != nullptr, elapsed);
+		}
+	};
+
+	// a single list never involves the pool at all
+	util::run_pooled(worker, softlist_names.size() > 1 ? softlist_names.size() - 1 : 0);
+
+	// and merge the results in the order that the machine declared them
+	for (software_list::ptr &softlist : results)
+	{
+		if (softlist)
+			m_software_lists.push_back(std::move(softlist));
 	}
 }
 
@@ -125,7 +896,7 @@ void software_list_collection::load(const Preferences &prefs, info::machine mach
 //  software_list_collection::find_software_by_name
 //-------------------------------------------------
  
-const software_list::software *software_list_collection::find_software_by_name(const QString &name, const QString &dev_interface) const
+std::optional<software_list::software> software_list_collection::find_software_by_name(const QString &name, const QString &dev_interface) const
 {
 	// local function to determine if there is a special character
 	auto has_special_character = [&name]()
@@ -138,19 +909,17 @@ const software_list::software *software_list_collection::find_software_by_name(c
 
 	if (!name.isEmpty() && !has_special_character())
 	{
-		for (const software_list &swlist : software_lists())
+		for (const software_list::ptr &swlist : software_lists())
 		{
-			const software_list::software *sw = util::find_if_ptr(swlist.get_software(), [&name, &dev_interface](const software_list::software &sw)
+			std::optional<software_list::software> sw = swlist->find_software(name);
+			if (sw && (dev_interface.isEmpty() || std::any_of(sw->parts().begin(), sw->parts().end(), [&dev_interface](const software_list::part &x)
+			{
+				return x.interface_name() == dev_interface;
+			})))
 			{
-				return sw.m_name == name
-					&& (dev_interface.isEmpty() || util::find_if_ptr(sw.m_parts, [&dev_interface](const software_list::part &x)
-					{
-						return x.m_interface == dev_interface;
-					}));
-			});
-			if (sw)
 				return sw;
+			}
 		}
 	}
-	return nullptr;
+	return { };
 }
@@ -11,10 +11,21 @@
 #ifndef SOFTWARELIST_H
 #define SOFTWARELIST_H
 
+#include <QDateTime>
+#include <QFile>
 #include <QString>
 
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <unordered_map>
 
+#include "bindata.h"
 #include "utility.h"
 #include "info.h"
 
@@ -22,51 +33,195 @@ class Preferences;
 
 QT_BEGIN_NAMESPACE
 class QDataStream;
+class QFileInfo;
 QT_END_NAMESPACE
 
 
 // ======================> software_list
 class software_list
 {
+	template<typename TDatabase, typename TPublic, typename TBinary>
+	friend class ::bindata::view;
 public:
 	class test;
-	struct software;
+	typedef std::shared_ptr<const software_list> ptr;
 
-	struct part
+	// the records that software and parts are views over; these are laid out back to back in
+	// one buffer per list (as they are in the compiled cache), and strings are offsets into the
+	// list's string table
+	struct binaries
 	{
-		QString			m_name;
-		QString			m_interface;
+		struct software
+		{
+			std::uint32_t	m_name_strindex;
+			std::uint32_t	m_description_strindex;
+			std::uint32_t	m_year_strindex;
+			std::uint32_t	m_publisher_strindex;
+			std::uint32_t	m_parts_index;
+			std::uint32_t	m_parts_count;
+		};
+
+		struct part
+		{
+			std::uint32_t	m_name_strindex;
+			std::uint32_t	m_interface_strindex;
+		};
 	};
 
-	struct software
+	// ======================> part
+	class part : public bindata::entry<software_list, part, binaries::part>
 	{
-		QString			m_name;
-		QString			m_description;
-		QString			m_year;
-		QString			m_publisher;
-		std::vector<part>	m_parts;
+	public:
+		part(const software_list &list, const binaries::part &inner)
+			: entry(list, inner)
+		{
+		}
+
+		const QString &name() const				{ return get_string(inner().m_name_strindex); }
+		const QString &interface_name() const	{ return get_string(inner().m_interface_strindex); }
 	};
 
-	software_list(const software_list &) = SHOULD_BE_DELETE;
+	// ======================> software
+	class software : public bindata::entry<software_list, software, binaries::software>
+	{
+	public:
+		software(const software_list &list, const binaries::software &inner)
+			: entry(list, inner)
+		{
+		}
+
+		const QString &name() const			{ return get_string(inner().m_name_strindex); }
+		const QString &description() const	{ return get_string(inner().m_description_strindex); }
+		const QString &year() const			{ return get_string(inner().m_year_strindex); }
+		const QString &publisher() const	{ return get_string(inner().m_publisher_strindex); }
+		part::view parts() const;
+	};
+
+	software_list(const software_list &) = delete;
 	software_list(software_list &&) = default;
+	software_list &operator=(software_list &&) = default;
 
-	// attempts to load a software list from a list of paths
-	static std::optional<software_list> try_load(const QStringList &hash_paths, const QString &softlist_name);
+	// attempts to load a software list from a list of paths; if a cache directory is specified,
+	// compiled copies of the hash files are kept there and used while the XML is unchanged
+	static std::optional<software_list> try_load(const QStringList &hash_paths, const QString &softlist_name, const QString &cache_directory = QString());
+
+	// hash paths can be zipped archives of hash files in addition to directories; like MAME, a
+	// hash path 'foo/hash' that is not a directory refers to 'foo/hash.zip' if that exists
+	static std::optional<QFileInfo> find_hash_archive(const QString &path);
+	static QStringList hash_archive_list_names(const QFileInfo &archive_info);
 
 	// accessors
-	const QString &name() const							{ return m_name; }
-	const std::vector<software> &get_software() const	{ return m_software; }
+	const QString &name() const					{ return m_name; }
+	software::view get_software() const			{ return software::view(*this, 0, m_software_count); }
+
+	// methods
+	std::optional<software> find_software(const QString &name) const;
+	size_t estimated_size() const;
+
+	// should only be called by software and part; strings are decoded when they are first asked
+	// for, and can be asked for from any thread
+	const QString &get_string(std::uint32_t strindex) const;
 
 private:
-	QString				m_name;
-	QString				m_description;
-	std::vector<software>	m_software;
+	class builder;
+
+	// the tables are either built in memory when the XML is parsed, or are a view into the
+	// compiled cache, which then stays mapped for as long as the list is around
+	class table_storage
+	{
+	public:
+		table_storage() : m_data(nullptr), m_size(0) { }
+		table_storage(std::vector<std::uint8_t> &&owned) : m_owned(std::move(owned)), m_data(m_owned.data()), m_size(m_owned.size()) { }
+		table_storage(std::unique_ptr<QFile> &&mapped_file, const std::uint8_t *data, size_t size) : m_mapped_file(std::move(mapped_file)), m_data(data), m_size(size) { }
+		table_storage(table_storage &&) = default;
+		table_storage &operator=(table_storage &&) = default;
+
+		const std::uint8_t *data() const	{ return m_data; }
+		size_t size() const					{ return m_size; }
+
+	private:
+		std::vector<std::uint8_t>	m_owned;
+		std::unique_ptr<QFile>		m_mapped_file;
+		const std::uint8_t *		m_data;
+		size_t						m_size;
+	};
+
+	// what is worked out on demand; this is kept apart so that the list stays movable
+	struct lazy_state
+	{
+		std::mutex									m_strings_mutex;
+		std::unordered_map<std::uint32_t, QString>	m_strings;
+		std::once_flag								m_software_index_once;
+		std::unordered_map<QString, std::uint32_t>	m_software_index;
+	};
+
+	QString						m_name;
+	QString						m_description;
+	table_storage				m_data;					// software, then parts, then the string table
+	std::uint32_t				m_software_count;
+	size_t						m_parts_offset;
+	std::uint32_t				m_parts_count;
+	size_t						m_string_table_offset;
+	std::unique_ptr<lazy_state>	m_lazy;
 
 	// ctor
-	software_list() = default;
+	software_list();
 
 	// methods
+	part::view parts() const					{ return part::view(*this, m_parts_offset, m_parts_count); }
 	bool load(QDataStream &stream, QString &error_message);
+	bool load_cache(const QString &cache_file_name, const QFileInfo &source);
+	bool save_cache(const QString &cache_file_name, const QFileInfo &source) const;
+};
+
+inline software_list::part::view software_list::software::parts() const { return db().parts().subview(inner().m_parts_index, inner().m_parts_count); }
+
+
+// ======================> software_list_cache
+// in-memory cache of loaded software lists, shared across machines; lists are keyed by the
+// hash file they were loaded from and are evicted least recently used first once the total
+// exceeds the budget (evicted lists stay alive for as long as somebody references them)
+class software_list_cache
+{
+public:
+	static const size_t DEFAULT_BUDGET = 64 * 1024 * 1024;
+
+	software_list_cache(size_t budget = DEFAULT_BUDGET);
+	software_list_cache(const software_list_cache &) = delete;
+
+	// the process-wide instance
+	static software_list_cache &global();
+
+	// returns the named list, loading it if it is not resident or if its hash file changed
+	software_list::ptr get(const QStringList &hash_paths, const QString &softlist_name, const QString &cache_directory = QString());
+
+	// accessors
+	size_t budget() const;
+	size_t resident_size() const;
+	size_t resident_count() const;
+
+	// methods
+	void set_budget(size_t budget);
+	void clear();
+
+private:
+	struct entry
+	{
+		QString				m_path;
+		qint64				m_source_size;
+		QDateTime			m_source_mtime;
+		software_list::ptr	m_softlist;
+		size_t				m_size;
+	};
+	typedef std::list<entry> entry_list;
+
+	mutable std::mutex								m_mutex;
+	entry_list										m_entries;		// most recently used first
+	std::unordered_map<QString, entry_list::iterator>	m_map;
+	size_t											m_budget;
+	size_t											m_resident_size;
+
+	void trim();
 };
 
 
@@ -74,19 +229,27 @@ private:
 class software_list_collection
 {
 public:
+	// instrumentation hook, invoked after each list is loaded; this is called from the loading
+	// threads, possibly concurrently
+	typedef std::function<void(const QString &softlist_name, bool success, std::chrono::nanoseconds elapsed)> list_loaded_callback;
+
 	software_list_collection() = default;
 	software_list_collection(const software_list_collection &) = SHOULD_BE_DELETE;
 	software_list_collection(software_list_collection &&) = default;
+	software_list_collection &operator=(software_list_collection &&) = default;
 
 	// accessors
-	const std::vector<software_list> &software_lists() const { return m_software_lists; }
+	const std::vector<software_list::ptr> &software_lists() const { return m_software_lists; }
 
 	// methods
 	void load(const Preferences &prefs, info::machine machine);
-	const software_list::software *find_software_by_name(const QString &name, const QString &dev_interface) const;
+	void load(const QStringList &hash_paths, const QString &cache_directory, const std::vector<QString> &softlist_names, const std::function<bool()> &is_cancelled = { });
+	std::optional<software_list::software> find_software_by_name(const QString &name, const QString &dev_interface) const;
+	void set_on_list_loaded(list_loaded_callback &&on_list_loaded) { m_on_list_loaded = std::move(on_list_loaded); }
 
 private:
-	std::vector<software_list>		m_software_lists;
+	std::vector<software_list::ptr>	m_software_lists;
+	list_loaded_callback			m_on_list_loaded;
 };
 
 #endif // SOFTWARELIST_H
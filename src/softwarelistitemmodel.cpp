@@ -6,6 +6,8 @@
 
 ***************************************************************************/
 
+#include <QBrush>
+
 #include "softwarelistitemmodel.h"
 
 
@@ -15,6 +17,7 @@
 
 SoftwareListItemModel::SoftwareListItemModel(QObject *parent)
     : QAbstractItemModel(parent)
+    , m_availableOnly(false)
 {
 }
 
@@ -23,7 +26,7 @@ SoftwareListItemModel::SoftwareListItemModel(QObject *parent)
 //  load
 //-------------------------------------------------
 
-void SoftwareListItemModel::load(const software_list_collection &software_col, bool load_parts, const QString &dev_interface)
+void SoftwareListItemModel::load(const software_list_collection &software_col, bool load_parts, const QString &dev_interface, const software_availability::map *availability)
 {
     beginResetModel();
 
@@ -31,37 +34,87 @@ void SoftwareListItemModel::load(const software_list_collection &software_col, b
     internalReset();
 
     // now enumerate through each list and build the m_parts vector
-    for (const software_list &softlist : software_col.software_lists())
+    for (const software_list::ptr &softlist_ptr : software_col.software_lists())
     {
+        const software_list &softlist = *softlist_ptr;
+
         // if the name of this software list is not in m_softlist_names, add it
         if (std::find(m_softlist_names.begin(), m_softlist_names.end(), softlist.name()) == m_softlist_names.end())
             m_softlist_names.push_back(softlist.name());
 
+        // if we were not told what is available, assume everything is
+        const std::unordered_set<QString> *availableSet = nullptr;
+        if (availability)
+        {
+            auto iter = availability->find(softlist.name());
+            static const std::unordered_set<QString> s_empty;
+            availableSet = iter != availability->end() && iter->second
+                ? iter->second.get()
+                : &s_empty;
+        }
+
         // now enumerate through all software
         for (const software_list::software &software : softlist.get_software())
         {
+            bool available = !availableSet || availableSet->find(software.name()) != availableSet->end();
             if (load_parts)
             {
                 // we're loading individual parts; enumerate through them and add them
-                for (const software_list::part &part : software.m_parts)
+                for (software_list::part part : software.parts())
                 {
-                    if (dev_interface.isEmpty() || dev_interface == part.m_interface)
-                        m_parts.emplace_back(softlist, software, &part);
+                    if (dev_interface.isEmpty() || dev_interface == part.interface_name())
+                        m_allParts.emplace_back(softlist, software, std::move(part), available);
                 }
             }
             else
             {
                 // we're not loading individual parts
                 assert(dev_interface.isEmpty());
-                m_parts.emplace_back(softlist, software, nullptr);
+                m_allParts.emplace_back(softlist, software, std::nullopt, available);
             }
         }
     }
 
+    applyFilter();
     endResetModel();
 }
 
 
+//-------------------------------------------------
+//  setAvailableOnly
+//-------------------------------------------------
+
+void SoftwareListItemModel::setAvailableOnly(bool availableOnly)
+{
+    if (m_availableOnly != availableOnly)
+    {
+        beginResetModel();
+        m_availableOnly = availableOnly;
+        applyFilter();
+        endResetModel();
+    }
+}
+
+
+//-------------------------------------------------
+//  applyFilter - builds the visible rows
+//-------------------------------------------------
+
+void SoftwareListItemModel::applyFilter()
+{
+    m_parts.clear();
+    m_rowsByName.clear();
+    for (const SoftwareAndPart &part : m_allParts)
+    {
+        if (!m_availableOnly || part.available())
+        {
+            m_rowsByName.emplace(part.software().name(), util::safe_static_cast<int>(m_parts.size()));
+            m_parts.push_back(part);
+        }
+    }
+}
+
+
 //-------------------------------------------------
 //  reset
 //-------------------------------------------------
@@ -74,14 +127,31 @@ void SoftwareListItemModel::reset()
 }
 
 
+//-------------------------------------------------
+//  beginLoading - empties the model until the
+//  results for the specified generation arrive
+//-------------------------------------------------
+
+void SoftwareListItemModel::beginLoading(std::uint64_t generation)
+{
+    beginResetModel();
+    internalReset();
+    m_loadingGeneration = generation;
+    endResetModel();
+}
+
+
 //-------------------------------------------------
 //  internalReset
 //-------------------------------------------------
 
 void SoftwareListItemModel::internalReset()
 {
+    m_allParts.clear();
     m_parts.clear();
+    m_rowsByName.clear();
     m_softlist_names.clear();
+    m_loadingGeneration.reset();
 }
 
 
@@ -140,27 +210,69 @@ QVariant SoftwareListItemModel::data(const QModelIndex &index, int role) const
         const software_list::software &sw = m_parts[index.row()].software();
 
         Column column = (Column)index.column();
-        auto x = sw.m_name.toStdString();
         switch (column)
         {
         case Column::Name:
-            result = sw.m_name;
+            result = sw.name();
             break;
         case Column::Description:
-            result = sw.m_description;
+            result = sw.description();
             break;
         case Column::Year:
-            result = sw.m_year;
+            result = sw.year();
             break;
         case Column::Manufacturer:
-            result = sw.m_publisher;
+            result = sw.publisher();
             break;
         }
     }
+    else if (index.isValid()
+        && index.row() >= 0
+        && index.row() < m_parts.size()
+        && role == Qt::ForegroundRole
+        && !m_parts[index.row()].available())
+    {
+        // software that is not in the ROM paths is dimmed
+        result = QBrush(Qt::gray);
+    }
     return result;
 }
 
 
+//-------------------------------------------------
+//  cellText
+//-------------------------------------------------
+
+QString SoftwareListItemModel::cellText(int row, int column) const
+{
+    const software_list::software &sw = m_parts[row].software();
+    switch ((Column)column)
+    {
+    case Column::Name:
+        return sw.name();
+    case Column::Description:
+        return sw.description();
+    case Column::Year:
+        return sw.year();
+    case Column::Manufacturer:
+        return sw.publisher();
+    default:
+        return QString();
+    }
+}
+
+
+//-------------------------------------------------
+//  findRowByKey
+//-------------------------------------------------
+
+int SoftwareListItemModel::findRowByKey(const QString &key) const
+{
+    auto iter = m_rowsByName.find(key);
+    return iter != m_rowsByName.end() ? iter->second : -1;
+}
+
+
 //-------------------------------------------------
 //  headerData
 //-------------------------------------------------
@@ -200,9 +312,10 @@ QVariant SoftwareListItemModel::headerData(int section, Qt::Orientation orientat
 //  SoftwareAndPart ctor
 //-------------------------------------------------
 
-SoftwareListItemModel::SoftwareAndPart::SoftwareAndPart(const software_list &sl, const software_list::software &sw, const software_list::part *p)
+SoftwareListItemModel::SoftwareAndPart::SoftwareAndPart(const software_list &sl, const software_list::software &sw, std::optional<software_list::part> &&p, bool available)
     : m_softlist(sl)
     , m_software(sw)
-    , m_part(p)
+    , m_part(std::move(p))
+    , m_available(available)
 {
 }
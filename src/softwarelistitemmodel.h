@@ -11,7 +11,14 @@
 
 #include <QAbstractItemModel>
 
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+
 #include "softwarelist.h"
+#include "softwareavailability.h"
+#include "sortfilterproxymodel.h"
+#include "tableviewmanager.h"
 
 
 #define SOFTLIST_VIEW_DESC_NAME "softlist"
@@ -19,7 +26,7 @@
 
 // ======================> SoftwareListItemModel
 
-class SoftwareListItemModel : public QAbstractItemModel
+class SoftwareListItemModel : public QAbstractItemModel, public SortFilterProxyModel::ITextSource, public TableViewManager::IKeySource
 {
 public:
 	enum class Column
@@ -34,11 +41,21 @@ public:
 	SoftwareListItemModel(QObject *parent);
 
 	// methods
-	void load(const software_list_collection &software_col, bool load_parts, const QString &dev_interface = "");
+	void load(const software_list_collection &software_col, bool load_parts, const QString &dev_interface = "", const software_availability::map *availability = nullptr);
 	void reset();
+	void beginLoading(std::uint64_t generation);
+
+	// while loading asynchronously, the model is empty and only accepts the results of the latest request
+	bool isLoading() const { return m_loadingGeneration.has_value(); }
+	bool isAwaiting(std::uint64_t generation) const { return m_loadingGeneration == generation; }
+
+	// availability filtering; availability is determined when loading, so this is cheap
+	bool availableOnly() const { return m_availableOnly; }
+	void setAvailableOnly(bool availableOnly);
 
 	// accessors
 	const software_list::software &getSoftwareByIndex(int index) const { return m_parts[index].software(); }
+	const software_list &getSoftwareListByIndex(int index) const { return m_parts[index].softlist(); }
 
 	// virtuals
 	virtual QModelIndex index(int row, int column, const QModelIndex &parent) const override;
@@ -47,29 +64,38 @@ public:
 	virtual int columnCount(const QModelIndex &parent) const override;
 	virtual QVariant data(const QModelIndex &index, int role) const override;
 	virtual QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+	virtual QString cellText(int row, int column) const override;
+	virtual int findRowByKey(const QString &key) const override;
 
 private:
 	// ======================> SoftwareAndPart
 	class SoftwareAndPart
 	{
 	public:
-		SoftwareAndPart(const software_list &sl, const software_list::software &sw, const software_list::part *p);
+		SoftwareAndPart(const software_list &sl, const software_list::software &sw, std::optional<software_list::part> &&p, bool available);
 
 		const software_list &softlist() const { return m_softlist; }
 		const software_list::software &software() const { return m_software; }
 		const software_list::part &part() const { assert(m_part); return *m_part; }
-		bool has_part() const { return m_part != nullptr; }
+		bool has_part() const { return m_part.has_value(); }
+		bool available() const { return m_available; }
 
 	private:
 		const software_list &m_softlist;
-		const software_list::software &m_software;
-		const software_list::part *m_part;
+		software_list::software m_software;
+		std::optional<software_list::part> m_part;
+		bool m_available;
 	};
 
+	std::vector<SoftwareAndPart>	m_allParts;
 	std::vector<SoftwareAndPart>	m_parts;
+	std::unordered_map<QString, int>	m_rowsByName;	// first row of each software in m_parts
 	std::vector<QString>			m_softlist_names;
+	std::optional<std::uint64_t>	m_loadingGeneration;
+	bool							m_availableOnly;
 
 	void internalReset();
+	void applyFilter();
 };
 
 #endif // SOFTWARELISTITEMMODEL_H
@@ -0,0 +1,142 @@
+/***************************************************************************
+
+	softwarelistloader.cpp
+
+	Background loading of software lists
+
+***************************************************************************/
+
+#include <QCoreApplication>
+
+#include "softwarelistloader.h"
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+QEvent::Type SoftwareListLoadedEvent::s_eventId = (QEvent::Type) QEvent::registerEventType();
+
+
+//-------------------------------------------------
+//  SoftwareListLoadedEvent ctor
+//-------------------------------------------------
+
+SoftwareListLoadedEvent::SoftwareListLoadedEvent(std::uint64_t generation, QString &&machineName, software_list_collection &&softwareListCollection, software_availability::map &&availability)
+	: QEvent(eventId())
+	, m_generation(generation)
+	, m_machineName(std::move(machineName))
+	, m_softwareListCollection(std::move(softwareListCollection))
+	, m_availability(std::move(availability))
+{
+}
+
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+SoftwareListLoader::SoftwareListLoader(QObject &eventHandler)
+	: m_eventHandler(eventHandler)
+	, m_generation(0)
+	, m_exiting(false)
+{
+	m_thread = std::thread([this]() { threadProc(); });
+}
+
+
+//-------------------------------------------------
+//  dtor
+//-------------------------------------------------
+
+SoftwareListLoader::~SoftwareListLoader()
+{
+	// bumping the generation makes any load in flight wind down promptly
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_exiting = true;
+		m_generation++;
+	}
+	m_condition.notify_one();
+	m_thread.join();
+}
+
+
+//-------------------------------------------------
+//  load
+//-------------------------------------------------
+
+std::uint64_t SoftwareListLoader::load(QString &&machineName, QStringList &&hashPaths, QString &&cacheDirectory, QStringList &&romPaths, std::vector<QString> &&softlistNames)
+{
+	std::uint64_t generation;
+	{
+		// only the most recent request matters, so this replaces anything that the
+		// worker has not picked up yet
+		std::unique_lock<std::mutex> lock(m_mutex);
+		generation = ++m_generation;
+		m_pendingRequest = Request { generation, std::move(machineName), std::move(hashPaths), std::move(cacheDirectory), std::move(romPaths), std::move(softlistNames) };
+	}
+	m_condition.notify_one();
+	return generation;
+}
+
+
+//-------------------------------------------------
+//  cancel
+//-------------------------------------------------
+
+void SoftwareListLoader::cancel()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_generation++;
+	m_pendingRequest.reset();
+}
+
+
+//-------------------------------------------------
+//  threadProc
+//-------------------------------------------------
+
+void SoftwareListLoader::threadProc()
+{
+	for (;;)
+	{
+		// wait for something to do
+		Request request;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return m_exiting || m_pendingRequest.has_value(); });
+			if (m_exiting)
+				break;
+			request = std::move(m_pendingRequest.value());
+			m_pendingRequest.reset();
+		}
+
+		// a request is stale as soon as another one comes in
+		auto isCancelled = [this, &request]()
+		{
+			return m_generation != request.m_generation;
+		};
+
+		// load the lists
+		software_list_collection softwareListCollection;
+		softwareListCollection.load(request.m_hashPaths, request.m_cacheDirectory, request.m_softlistNames, isCancelled);
+
+		// check what is actually present in the ROM paths
+		software_availability::map availability;
+		for (const software_list::ptr &softlist : softwareListCollection.software_lists())
+		{
+			if (isCancelled())
+				break;
+			availability.emplace(softlist->name(), software_availability::global().get(request.m_romPaths, softlist->name()));
+		}
+
+		// and post the results if nobody has moved on in the meantime; the receiver is
+		// still responsible for checking the generation, because we can race with load()
+		if (!isCancelled())
+		{
+			auto event = std::make_unique<SoftwareListLoadedEvent>(request.m_generation, std::move(request.m_machineName), std::move(softwareListCollection), std::move(availability));
+			QCoreApplication::postEvent(&m_eventHandler, event.release());
+		}
+	}
+}
@@ -0,0 +1,96 @@
+/***************************************************************************
+
+	softwarelistloader.h
+
+	Background loading of software lists
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef SOFTWARELISTLOADER_H
+#define SOFTWARELISTLOADER_H
+
+#include <QEvent>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "softwarelist.h"
+#include "softwareavailability.h"
+
+
+//**************************************************************************
+//  TYPES
+//**************************************************************************
+
+// ======================> SoftwareListLoadedEvent
+
+class SoftwareListLoadedEvent : public QEvent
+{
+public:
+	// ctor
+	SoftwareListLoadedEvent(std::uint64_t generation, QString &&machineName, software_list_collection &&softwareListCollection, software_availability::map &&availability);
+
+	// accessors
+	static QEvent::Type eventId()								{ return s_eventId; }
+	std::uint64_t generation() const							{ return m_generation; }
+	const QString &machineName() const							{ return m_machineName; }
+	software_list_collection &softwareListCollection()			{ return m_softwareListCollection; }
+	const software_availability::map &availability() const		{ return m_availability; }
+
+private:
+	static QEvent::Type			s_eventId;
+	std::uint64_t				m_generation;
+	QString						m_machineName;
+	software_list_collection	m_softwareListCollection;
+	software_availability::map	m_availability;
+};
+
+
+// ======================> SoftwareListLoader
+
+class SoftwareListLoader
+{
+public:
+	// ctor / dtor
+	SoftwareListLoader(QObject &eventHandler);
+	SoftwareListLoader(const SoftwareListLoader &) = delete;
+	~SoftwareListLoader();
+
+	// starts loading the specified lists and checking which software is present in the ROM paths,
+	// superseding any previous request; the results are posted to the event handler as a
+	// SoftwareListLoadedEvent tagged with the returned generation
+	std::uint64_t load(QString &&machineName, QStringList &&hashPaths, QString &&cacheDirectory, QStringList &&romPaths, std::vector<QString> &&softlistNames);
+
+	// abandons any outstanding request
+	void cancel();
+
+private:
+	struct Request
+	{
+		std::uint64_t			m_generation;
+		QString					m_machineName;
+		QStringList				m_hashPaths;
+		QString					m_cacheDirectory;
+		QStringList				m_romPaths;
+		std::vector<QString>	m_softlistNames;
+	};
+
+	QObject &					m_eventHandler;
+	std::atomic<std::uint64_t>	m_generation;
+	std::mutex					m_mutex;
+	std::condition_variable		m_condition;
+	std::optional<Request>		m_pendingRequest;
+	bool						m_exiting;
+	std::thread					m_thread;
+
+	void threadProc();
+};
+
+
+#endif // SOFTWARELISTLOADER_H
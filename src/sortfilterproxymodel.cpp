@@ -0,0 +1,952 @@
+/***************************************************************************
+
+	sortfilterproxymodel.cpp
+
+	Sorting and filtering of the list views
+
+***************************************************************************/
+
+#include <QCollator>
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <numeric>
+#include <thread>
+
+#include "sortfilterproxymodel.h"
+#include "utility.h"
+
+
+//**************************************************************************
+//  CONSTANTS
+//**************************************************************************
+
+// below this, it is not worth involving other threads
+#define MIN_ROWS_PER_THREAD		4096
+
+
+//**************************************************************************
+//  LOCAL FUNCTIONS
+//**************************************************************************
+
+//-------------------------------------------------
+//  threadCountForRows
+//-------------------------------------------------
+
+static size_t threadCountForRows(size_t rowCount)
+{
+	size_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1U);
+	return std::max(std::min(hardwareThreads, rowCount / MIN_ROWS_PER_THREAD), (size_t)1);
+}
+
+
+//-------------------------------------------------
+//  parallelSort - sorts chunks of the range on
+//	separate threads and then merges them
+//-------------------------------------------------
+
+template<typename TIter, typename TCompare>
+static void parallelSort(TIter begin, TIter end, TCompare compare)
+{
+	size_t count = end - begin;
+	size_t chunkCount = threadCountForRows(count);
+	if (chunkCount <= 1)
+	{
+		std::sort(begin, end, compare);
+		return;
+	}
+
+	// sort the chunks on whatever threads the pool can spare, and this one
+	std::vector<TIter> bounds;
+	for (size_t i = 0; i <= chunkCount; i++)
+		bounds.push_back(begin + count * i / chunkCount);
+	std::atomic<size_t> nextChunk(0);
+	util::run_pooled([&bounds, &compare, &nextChunk, chunkCount]()
+	{
+		size_t i;
+		while ((i = nextChunk++) < chunkCount)
+			std::sort(bounds[i], bounds[i + 1], compare);
+	}, chunkCount - 1);
+
+	// and merge them, pairwise
+	for (size_t width = 1; width < chunkCount; width *= 2)
+	{
+		for (size_t i = 0; i + width < chunkCount; i += width * 2)
+			std::inplace_merge(bounds[i], bounds[i + width], bounds[std::min(i + width * 2, chunkCount)], compare);
+	}
+}
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+SortFilterProxyModel::SortFilterProxyModel(QObject *parent)
+	: QAbstractProxyModel(parent)
+	, m_textSource(nullptr)
+	, m_sourceRowCount(0)
+	, m_columnCount(0)
+	, m_sortColumn(-1)
+	, m_sortOrder(Qt::AscendingOrder)
+	, m_treeMode(false)
+{
+}
+
+
+//-------------------------------------------------
+//  setFilterText
+//-------------------------------------------------
+
+void SortFilterProxyModel::setFilterText(const QString &text)
+{
+	QString filterText = text.toLower();
+	if (filterText == m_filterText)
+		return;
+
+	// typing into the search box usually adds to what was there; anything that matches the new
+	// filter also matched the old filter, so we only need to look at what is showing now
+	std::vector<FilterTerm> filterTerms = compileFilter(SearchQuery(filterText));
+	bool narrowing = !m_filterTerms.empty() && isNarrowerFilter(filterTerms, m_filterTerms);
+	applyFilter(std::move(filterText), std::move(filterTerms), narrowing);
+}
+
+
+//-------------------------------------------------
+//  refilter
+//-------------------------------------------------
+
+void SortFilterProxyModel::refilter()
+{
+	// what the source model's fields match has changed, so every row has to be looked at again
+	applyFilter(QString(m_filterText), compileFilter(SearchQuery(m_filterText)), false);
+}
+
+
+//-------------------------------------------------
+//  applyFilter
+//-------------------------------------------------
+
+void SortFilterProxyModel::applyFilter(QString &&filterText, std::vector<FilterTerm> &&filterTerms, bool narrowing)
+{
+	// this is a layout change rather than a reset, so that views keep what is expanded and selected
+	changeLayout([&]()
+	{
+		m_filterText = std::move(filterText);
+		m_filterTerms = std::move(filterTerms);
+		if (narrowing)
+			narrowRows();
+		else
+			filterRows();
+
+		// parents that are still showing keep their children; the rest have to be fetched again
+		for (int row = 0; row < m_sourceRowCount; row++)
+		{
+			if (m_fetchedRows[row] && m_sourceToProxy[row] < 0)
+				m_fetchedRows[row] = false;
+		}
+	}, QAbstractItemModel::NoLayoutChangeHint);
+}
+
+
+//-------------------------------------------------
+//  setTreeMode
+//-------------------------------------------------
+
+void SortFilterProxyModel::setTreeMode(bool treeMode)
+{
+	if (treeMode == m_treeMode)
+		return;
+
+	beginResetModel();
+	m_treeMode = treeMode;
+	m_fetchedRows.assign(m_sourceRowCount, false);
+	filterRows();
+	endResetModel();
+}
+
+
+//-------------------------------------------------
+//  revealSource - maps a source index, fetching
+//	the children of its parent if need be
+//-------------------------------------------------
+
+QModelIndex SortFilterProxyModel::revealSource(const QModelIndex &sourceIndex)
+{
+	int row = sourceIndex.row();
+	if (m_treeMode && sourceIndex.isValid() && row < (int)m_sourceToProxy.size() && m_sourceToProxy[row] >= 0)
+	{
+		int parentRow = sourceParentRow(row);
+		if (parentRow >= 0 && !m_fetchedRows[parentRow])
+			fetchMore(createIndex(m_sourceToProxy[parentRow], 0));
+	}
+	return mapFromSource(sourceIndex);
+}
+
+
+//-------------------------------------------------
+//  setSourceModel
+//-------------------------------------------------
+
+void SortFilterProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+	beginResetModel();
+	if (this->sourceModel())
+		disconnect(this->sourceModel(), nullptr, this, nullptr);
+	QAbstractProxyModel::setSourceModel(sourceModel);
+	m_textSource = dynamic_cast<const ITextSource *>(sourceModel);
+
+	if (sourceModel)
+	{
+		connect(sourceModel, &QAbstractItemModel::modelAboutToBeReset, this, [this]()
+		{
+			beginResetModel();
+		});
+		connect(sourceModel, &QAbstractItemModel::modelReset, this, [this]()
+		{
+			sourceReset();
+			endResetModel();
+		});
+		connect(sourceModel, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+		{
+			sourceDataChanged(topLeft, bottomRight, roles);
+		});
+
+		// none of our models make finer grained changes than resets, so if we get one of these
+		// just start over
+		auto startOver = [this]()
+		{
+			beginResetModel();
+			sourceReset();
+			endResetModel();
+		};
+		connect(sourceModel, &QAbstractItemModel::rowsInserted, this, startOver);
+		connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, startOver);
+		connect(sourceModel, &QAbstractItemModel::rowsMoved, this, startOver);
+		connect(sourceModel, &QAbstractItemModel::columnsInserted, this, startOver);
+		connect(sourceModel, &QAbstractItemModel::columnsRemoved, this, startOver);
+		connect(sourceModel, &QAbstractItemModel::layoutChanged, this, startOver);
+	}
+
+	sourceReset();
+	endResetModel();
+}
+
+
+//-------------------------------------------------
+//  mapToSource
+//-------------------------------------------------
+
+QModelIndex SortFilterProxyModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+	if (!proxyIndex.isValid())
+		return QModelIndex();
+
+	// children have the row of their parent (plus one) as their internal ID
+	int sourceRow;
+	if (proxyIndex.internalId() == 0)
+	{
+		if (proxyIndex.row() >= (int)m_proxyToSource.size())
+			return QModelIndex();
+		sourceRow = m_proxyToSource[proxyIndex.row()];
+	}
+	else
+	{
+		int parentProxyRow = (int)proxyIndex.internalId() - 1;
+		if (parentProxyRow >= (int)m_proxyToSource.size() || proxyIndex.row() >= childCount(parentProxyRow))
+			return QModelIndex();
+		sourceRow = m_childRows[m_childOffsets[parentProxyRow] + proxyIndex.row()];
+	}
+	return sourceModel()->index(sourceRow, proxyIndex.column());
+}
+
+
+//-------------------------------------------------
+//  mapFromSource
+//-------------------------------------------------
+
+QModelIndex SortFilterProxyModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+	int row = sourceIndex.row();
+	if (!sourceIndex.isValid() || row >= (int)m_sourceToProxy.size() || m_sourceToProxy[row] < 0)
+		return QModelIndex();
+
+	int parentRow = m_treeMode ? sourceParentRow(row) : -1;
+	if (parentRow < 0)
+		return createIndex(m_sourceToProxy[row], sourceIndex.column());
+	return m_fetchedRows[parentRow]
+		? createIndex(m_sourceToProxy[row], sourceIndex.column(), (quintptr)m_sourceToProxy[parentRow] + 1)
+		: QModelIndex();
+}
+
+
+//-------------------------------------------------
+//  index
+//-------------------------------------------------
+
+QModelIndex SortFilterProxyModel::index(int row, int column, const QModelIndex &parent) const
+{
+	if (row < 0 || row >= rowCount(parent) || column < 0 || column >= m_columnCount)
+		return QModelIndex();
+	return !parent.isValid()
+		? createIndex(row, column)
+		: createIndex(row, column, (quintptr)parent.row() + 1);
+}
+
+
+//-------------------------------------------------
+//  parent
+//-------------------------------------------------
+
+QModelIndex SortFilterProxyModel::parent(const QModelIndex &child) const
+{
+	return child.isValid() && child.internalId() != 0
+		? createIndex((int)child.internalId() - 1, 0)
+		: QModelIndex();
+}
+
+
+//-------------------------------------------------
+//  rowCount
+//-------------------------------------------------
+
+int SortFilterProxyModel::rowCount(const QModelIndex &parent) const
+{
+	if (!parent.isValid())
+		return (int)m_proxyToSource.size();
+
+	// children are only there once they have been fetched
+	return parent.internalId() == 0 && m_fetchedRows[m_proxyToSource[parent.row()]]
+		? childCount(parent.row())
+		: 0;
+}
+
+
+//-------------------------------------------------
+//  columnCount
+//-------------------------------------------------
+
+int SortFilterProxyModel::columnCount(const QModelIndex &parent) const
+{
+	return !parent.isValid() || parent.internalId() == 0
+		? m_columnCount
+		: 0;
+}
+
+
+//-------------------------------------------------
+//  hasChildren
+//-------------------------------------------------
+
+bool SortFilterProxyModel::hasChildren(const QModelIndex &parent) const
+{
+	// this is asked before children are fetched, so that views know what they can expand
+	if (!parent.isValid())
+		return !m_proxyToSource.empty();
+	return parent.internalId() == 0 && childCount(parent.row()) > 0;
+}
+
+
+//-------------------------------------------------
+//  canFetchMore
+//-------------------------------------------------
+
+bool SortFilterProxyModel::canFetchMore(const QModelIndex &parent) const
+{
+	return parent.isValid()
+		&& parent.internalId() == 0
+		&& !m_fetchedRows[m_proxyToSource[parent.row()]]
+		&& childCount(parent.row()) > 0;
+}
+
+
+//-------------------------------------------------
+//  fetchMore - makes the children of a row known
+//	to views; they are already worked out, so this
+//	is just a matter of saying that they are there
+//-------------------------------------------------
+
+void SortFilterProxyModel::fetchMore(const QModelIndex &parent)
+{
+	if (!canFetchMore(parent))
+		return;
+
+	beginInsertRows(parent, 0, childCount(parent.row()) - 1);
+	m_fetchedRows[m_proxyToSource[parent.row()]] = true;
+	endInsertRows();
+}
+
+
+//-------------------------------------------------
+//  sort
+//-------------------------------------------------
+
+void SortFilterProxyModel::sort(int column, Qt::SortOrder order)
+{
+	if (column == m_sortColumn && order == m_sortOrder)
+		return;
+
+	// sorting does not change what is filtered, so selections and the like can follow their rows
+	changeLayout([&]()
+	{
+		m_sortColumn = column;
+		m_sortOrder = order;
+		sortRows();
+		filterRows();
+	}, QAbstractItemModel::VerticalSortHint);
+}
+
+
+//-------------------------------------------------
+//  changeLayout - rearranges rows, moving the
+//	persistent indexes (and with them selections
+//	and what views have expanded) to follow their
+//	source rows, or dropping them if filtered out
+//-------------------------------------------------
+
+void SortFilterProxyModel::changeLayout(const std::function<void()> &change, QAbstractItemModel::LayoutChangeHint hint)
+{
+	emit layoutAboutToBeChanged(QList<QPersistentModelIndex>(), hint);
+	QModelIndexList persistentIndexes = persistentIndexList();
+	QModelIndexList sourceIndexes;
+	for (const QModelIndex &index : persistentIndexes)
+		sourceIndexes.push_back(mapToSource(index));
+
+	change();
+
+	QModelIndexList newIndexes;
+	for (const QModelIndex &sourceIndex : sourceIndexes)
+		newIndexes.push_back(mapFromSource(sourceIndex));
+	changePersistentIndexList(persistentIndexes, newIndexes);
+	emit layoutChanged(QList<QPersistentModelIndex>(), hint);
+}
+
+
+//-------------------------------------------------
+//  cellText
+//-------------------------------------------------
+
+QString SortFilterProxyModel::cellText(int row, int column) const
+{
+	return m_textSource
+		? m_textSource->cellText(row, column)
+		: sourceModel()->data(sourceModel()->index(row, column), Qt::DisplayRole).toString();
+}
+
+
+//-------------------------------------------------
+//  sourceParentRow
+//-------------------------------------------------
+
+int SortFilterProxyModel::sourceParentRow(int row) const
+{
+	return m_textSource
+		? m_textSource->parentRow(row)
+		: -1;
+}
+
+
+//-------------------------------------------------
+//  childCount - the number of children of a top
+//	level row, whether fetched or not
+//-------------------------------------------------
+
+int SortFilterProxyModel::childCount(int proxyRow) const
+{
+	return m_treeMode
+		? m_childOffsets[proxyRow + 1] - m_childOffsets[proxyRow]
+		: 0;
+}
+
+
+//-------------------------------------------------
+//  sourceReset - takes the text of the source
+//	model, and sorts and filters it again
+//-------------------------------------------------
+
+void SortFilterProxyModel::sourceReset()
+{
+	m_sourceRowCount = sourceModel() ? sourceModel()->rowCount() : 0;
+	m_columnCount = sourceModel() ? sourceModel()->columnCount() : 0;
+
+	// gather up what we search through
+	m_searchText.clear();
+	m_searchOffsets.resize(m_sourceRowCount + 1);
+	for (int row = 0; row < m_sourceRowCount; row++)
+	{
+		m_searchOffsets[row] = m_searchText.size();
+		for (int column = 0; column < m_columnCount; column++)
+		{
+			m_searchText += cellText(row, column).toLower();
+			m_searchText += '\n';
+		}
+	}
+	m_searchOffsets[m_sourceRowCount] = m_searchText.size();
+	m_searchText.squeeze();
+
+	// collation keys are made when we are sorted by their column
+	m_collationKeys.clear();
+	m_collationKeys.resize(m_columnCount);
+
+	// the columns may have changed, as may whatever the source model compiled the filter into
+	m_filterTerms = compileFilter(SearchQuery(m_filterText));
+	m_fetchedRows.assign(m_sourceRowCount, false);
+
+	sortRows();
+	filterRows();
+}
+
+
+//-------------------------------------------------
+//  sourceDataChanged
+//-------------------------------------------------
+
+void SortFilterProxyModel::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+	// if the text changed, everything we gathered up is stale
+	if (roles.isEmpty() || roles.contains(Qt::DisplayRole) || roles.contains(Qt::EditRole))
+	{
+		beginResetModel();
+		sourceReset();
+		endResetModel();
+		return;
+	}
+
+	// otherwise pass it on; children are scattered among their parents, so they go one at a time
+	if (m_treeMode)
+	{
+		for (int row = topLeft.row(); row <= bottomRight.row() && row < m_sourceRowCount; row++)
+		{
+			QModelIndex index = mapFromSource(sourceModel()->index(row, topLeft.column()));
+			if (index.isValid())
+				emit dataChanged(index, index.sibling(index.row(), bottomRight.column()), roles);
+		}
+		return;
+	}
+
+	// and top level rows are scattered in our order, so coalesce what we can
+	std::vector<int> proxyRows;
+	for (int row = topLeft.row(); row <= bottomRight.row() && row < (int)m_sourceToProxy.size(); row++)
+	{
+		if (m_sourceToProxy[row] >= 0)
+			proxyRows.push_back(m_sourceToProxy[row]);
+	}
+	std::sort(proxyRows.begin(), proxyRows.end());
+	for (auto iter = proxyRows.begin(); iter != proxyRows.end(); )
+	{
+		auto end = iter + 1;
+		while (end != proxyRows.end() && *end == *(end - 1) + 1)
+			end++;
+		emit dataChanged(createIndex(*iter, topLeft.column()), createIndex(*(end - 1), bottomRight.column()), roles);
+		iter = end;
+	}
+}
+
+
+//-------------------------------------------------
+//  compileFilter - works out how each term of the
+//	query is going to be matched
+//-------------------------------------------------
+
+std::vector<SortFilterProxyModel::FilterTerm> SortFilterProxyModel::compileFilter(const SearchQuery &query) const
+{
+	std::vector<FilterTerm> results;
+	results.reserve(query.terms().size());
+	for (const SearchQuery::Term &term : query.terms())
+	{
+		FilterTerm &result = results.emplace_back();
+		result.m_token = term.m_token;
+		result.m_column = -1;
+		result.m_negated = term.m_negated;
+
+		// the source model gets the first say...
+		if (m_textSource)
+			result.m_predicate = m_textSource->compileFilterTerm(term);
+
+		// ...then fields are looked for among the column headers...
+		if (!result.m_predicate && !term.m_field.isEmpty())
+		{
+			for (int column = 0; column < m_columnCount; column++)
+			{
+				if (sourceModel()->headerData(column, Qt::Horizontal, Qt::DisplayRole).toString().toLower() == term.m_field)
+				{
+					result.m_column = column;
+					break;
+				}
+			}
+			if (result.m_column >= 0 && term.m_isRange)
+			{
+				result.m_predicate = [this, term, column{ result.m_column }](int row)
+				{
+					int begin, end;
+					cellRange(row, column, begin, end);
+					return term.matchesRange(QString::fromRawData(m_searchText.constData() + begin, end - begin));
+				};
+			}
+		}
+
+		// ...and anything else is text, including fields that we do not know about
+		if (!result.m_predicate)
+		{
+			QString text = result.m_column < 0 && !term.m_field.isEmpty()
+				? term.m_field + ':' + term.m_text
+				: term.m_text;
+			result.m_matcher = QStringMatcher(text, Qt::CaseSensitive);
+		}
+	}
+	return results;
+}
+
+
+//-------------------------------------------------
+//  isNarrowerFilter - can anything that matches a
+//	filter be assumed to match another one?
+//-------------------------------------------------
+
+bool SortFilterProxyModel::isNarrowerFilter(const std::vector<FilterTerm> &filter, const std::vector<FilterTerm> &thanFilter)
+{
+	// every term of the other filter has to be implied by one of ours; the same term implies itself,
+	// and text implies any text that it contains
+	return std::all_of(thanFilter.begin(), thanFilter.end(), [&filter](const FilterTerm &thanTerm)
+	{
+		return std::any_of(filter.begin(), filter.end(), [&thanTerm](const FilterTerm &term)
+		{
+			if (term.m_negated != thanTerm.m_negated)
+				return false;
+			if (term.m_token == thanTerm.m_token)
+				return true;
+			return !term.m_negated
+				&& !term.m_predicate
+				&& !thanTerm.m_predicate
+				&& term.m_column == thanTerm.m_column
+				&& term.m_matcher.pattern().contains(thanTerm.m_matcher.pattern());
+		});
+	});
+}
+
+
+//-------------------------------------------------
+//  rowMatchesFilter
+//-------------------------------------------------
+
+bool SortFilterProxyModel::rowMatchesFilter(int row) const
+{
+	return std::all_of(m_filterTerms.begin(), m_filterTerms.end(), [this, row](const FilterTerm &term)
+	{
+		return rowMatchesTerm(row, term) != term.m_negated;
+	});
+}
+
+
+//-------------------------------------------------
+//  rowMatchesTerm - does a row match a term,
+//	ignoring whether the term is negated?
+//-------------------------------------------------
+
+bool SortFilterProxyModel::rowMatchesTerm(int row, const FilterTerm &term) const
+{
+	if (term.m_predicate)
+		return term.m_predicate(row);
+
+	int begin, end;
+	if (term.m_column >= 0)
+	{
+		cellRange(row, term.m_column, begin, end);
+	}
+	else
+	{
+		begin = m_searchOffsets[row];
+		end = m_searchOffsets[row + 1];
+	}
+	return term.m_matcher.indexIn(m_searchText.constData() + begin, end - begin, 0) >= 0;
+}
+
+
+//-------------------------------------------------
+//  cellRange - finds where a cell is within
+//	m_searchText
+//-------------------------------------------------
+
+void SortFilterProxyModel::cellRange(int row, int column, int &begin, int &end) const
+{
+	begin = m_searchOffsets[row];
+	for (int i = 0; i < column; i++)
+		begin = m_searchText.indexOf('\n', begin) + 1;
+	end = m_searchText.indexOf('\n', begin);
+}
+
+
+//-------------------------------------------------
+//  collationKeys - gets the collation keys for a
+//	column, making them if we have not already
+//-------------------------------------------------
+
+const std::vector<QCollatorSortKey> &SortFilterProxyModel::collationKeys(int column)
+{
+	std::vector<QCollatorSortKey> &keys = m_collationKeys[column];
+	if (keys.empty() && m_sourceRowCount > 0)
+	{
+		// the source model is only safe to access from this thread, but making the keys is the
+		// expensive part
+		std::vector<QString> texts;
+		texts.reserve(m_sourceRowCount);
+		for (int row = 0; row < m_sourceRowCount; row++)
+			texts.push_back(cellText(row, column));
+
+		// QCollator is not thread safe, so each chunk gets its own
+		size_t chunkCount = threadCountForRows(texts.size());
+		std::vector<std::vector<QCollatorSortKey>> chunks(chunkCount);
+		std::atomic<size_t> nextChunk(0);
+		util::run_pooled([&texts, &chunks, &nextChunk, chunkCount]()
+		{
+			size_t chunk;
+			while ((chunk = nextChunk++) < chunkCount)
+			{
+				QCollator collator;
+				collator.setCaseSensitivity(Qt::CaseInsensitive);
+				size_t begin = texts.size() * chunk / chunkCount;
+				size_t end = texts.size() * (chunk + 1) / chunkCount;
+				chunks[chunk].reserve(end - begin);
+				for (size_t i = begin; i < end; i++)
+					chunks[chunk].push_back(collator.sortKey(texts[i]));
+			}
+		}, chunkCount - 1);
+
+		keys.reserve(m_sourceRowCount);
+		for (std::vector<QCollatorSortKey> &chunk : chunks)
+			std::move(chunk.begin(), chunk.end(), std::back_inserter(keys));
+	}
+	return keys;
+}
+
+
+//-------------------------------------------------
+//  sortRows
+//-------------------------------------------------
+
+void SortFilterProxyModel::sortRows()
+{
+	m_sortedRows.resize(m_sourceRowCount);
+	std::iota(m_sortedRows.begin(), m_sortedRows.end(), 0);
+	if (m_sortColumn < 0 || m_sortColumn >= m_columnCount)
+		return;
+
+	const std::vector<QCollatorSortKey> &keys = collationKeys(m_sortColumn);
+	bool descending = m_sortOrder == Qt::DescendingOrder;
+	parallelSort(m_sortedRows.begin(), m_sortedRows.end(), [&keys, descending](int a, int b)
+	{
+		// ties go by source row, as with QSortFilterProxyModel's stable sort
+		int result = keys[a].compare(keys[b]);
+		if (result != 0)
+			return descending ? result > 0 : result < 0;
+		return a < b;
+	});
+}
+
+
+//-------------------------------------------------
+//  filterRows - works out which rows are showing,
+//	in sort order
+//-------------------------------------------------
+
+void SortFilterProxyModel::filterRows()
+{
+	std::vector<bool> matches;
+	if (!m_filterTerms.empty())
+		findMatches(matches);
+	buildRows(matches);
+}
+
+
+//-------------------------------------------------
+//  buildRows - lays out the rows that match the
+//	filter (all of them if there are no matches),
+//	in sort order
+//-------------------------------------------------
+
+void SortFilterProxyModel::buildRows(const std::vector<bool> &matches)
+{
+	auto isMatch = [&matches](int row)
+	{
+		return matches.empty() || matches[row];
+	};
+
+	m_proxyToSource.clear();
+	m_proxyToSource.reserve(m_sourceRowCount);
+	m_sourceToProxy.assign(m_sourceRowCount, -1);
+	m_childOffsets.clear();
+	m_childRows.clear();
+	if (!m_treeMode)
+	{
+		for (int row : m_sortedRows)
+		{
+			if (isMatch(row))
+			{
+				m_sourceToProxy[row] = (int)m_proxyToSource.size();
+				m_proxyToSource.push_back(row);
+			}
+		}
+		return;
+	}
+
+	// in tree mode parents are showing if they match, or if any of their children do...
+	std::vector<int> childCounts(m_sourceRowCount, 0);
+	for (int row = 0; row < m_sourceRowCount; row++)
+	{
+		int parentRow = sourceParentRow(row);
+		if (parentRow >= 0 && isMatch(row))
+			childCounts[parentRow]++;
+	}
+	for (int row : m_sortedRows)
+	{
+		if (sourceParentRow(row) < 0 && (isMatch(row) || childCounts[row] > 0))
+		{
+			m_sourceToProxy[row] = (int)m_proxyToSource.size();
+			m_proxyToSource.push_back(row);
+		}
+	}
+
+	// ...and the children that match are laid out back to back, so that each parent's are together
+	m_childOffsets.resize(m_proxyToSource.size() + 1);
+	int childRowCount = 0;
+	for (size_t proxyRow = 0; proxyRow < m_proxyToSource.size(); proxyRow++)
+	{
+		m_childOffsets[proxyRow] = childRowCount;
+		childRowCount += childCounts[m_proxyToSource[proxyRow]];
+	}
+	m_childOffsets[m_proxyToSource.size()] = childRowCount;
+	m_childRows.resize(childRowCount);
+
+	std::vector<int> nextChildOffsets(m_childOffsets.begin(), m_childOffsets.end() - 1);
+	for (int row : m_sortedRows)
+	{
+		int parentRow = sourceParentRow(row);
+		if (parentRow >= 0 && isMatch(row))
+		{
+			int parentProxyRow = m_sourceToProxy[parentRow];
+			int &offset = nextChildOffsets[parentProxyRow];
+			m_sourceToProxy[row] = offset - m_childOffsets[parentProxyRow];
+			m_childRows[offset++] = row;
+		}
+	}
+}
+
+
+//-------------------------------------------------
+//  narrowRows - filters the rows that are showing
+//	by a filter that is narrower than the one that
+//	they were filtered by
+//-------------------------------------------------
+
+void SortFilterProxyModel::narrowRows()
+{
+	// in tree mode parents can be showing without matching, so we work out what matches and lay
+	// it out again; either way, only what is showing now can match
+	if (m_treeMode)
+	{
+		std::vector<bool> matches(m_sourceRowCount, false);
+		for (int row : m_proxyToSource)
+			matches[row] = rowMatchesFilter(row);
+		for (int row : m_childRows)
+			matches[row] = rowMatchesFilter(row);
+		buildRows(matches);
+		return;
+	}
+
+	// these are already in sort order
+	std::vector<int> proxyToSource;
+	proxyToSource.reserve(m_proxyToSource.size());
+	for (int row : m_proxyToSource)
+	{
+		m_sourceToProxy[row] = -1;
+		if (rowMatchesFilter(row))
+		{
+			m_sourceToProxy[row] = (int)proxyToSource.size();
+			proxyToSource.push_back(row);
+		}
+	}
+	m_proxyToSource = std::move(proxyToSource);
+}
+
+
+//-------------------------------------------------
+//  findMatches - finds the rows that match the
+//	filter
+//-------------------------------------------------
+
+void SortFilterProxyModel::findMatches(std::vector<bool> &matches) const
+{
+	// text that can be in any column is quickest to find by looking through everything at once, so
+	// we start with that...
+	std::vector<const FilterTerm *> otherTerms;
+	std::vector<bool> textMatches;
+	bool foundText = false;
+	for (const FilterTerm &term : m_filterTerms)
+	{
+		if (!term.m_predicate && term.m_column < 0 && !term.m_negated)
+		{
+			if (!foundText)
+			{
+				findText(term.m_matcher, matches);
+				foundText = true;
+			}
+			else
+			{
+				findText(term.m_matcher, textMatches);
+				for (int row = 0; row < m_sourceRowCount; row++)
+					matches[row] = matches[row] && textMatches[row];
+			}
+		}
+		else
+		{
+			otherTerms.push_back(&term);
+		}
+	}
+	if (!foundText)
+		matches.assign(m_sourceRowCount, true);
+
+	// ...and then go through whatever is left one row at a time
+	if (!otherTerms.empty())
+	{
+		for (int row = 0; row < m_sourceRowCount; row++)
+		{
+			if (matches[row])
+			{
+				matches[row] = std::all_of(otherTerms.begin(), otherTerms.end(), [this, row](const FilterTerm *term)
+				{
+					return rowMatchesTerm(row, *term) != term->m_negated;
+				});
+			}
+		}
+	}
+}
+
+
+//-------------------------------------------------
+//  findText - finds the rows that contain some
+//	text in any column
+//-------------------------------------------------
+
+void SortFilterProxyModel::findText(const QStringMatcher &matcher, std::vector<bool> &matches) const
+{
+	matches.assign(m_sourceRowCount, false);
+
+	// the text has no line breaks, so a match can never straddle two cells
+	const QChar *text = m_searchText.constData();
+	int length = m_searchText.size();
+	int row = 0;
+	for (int position = matcher.indexIn(text, length, 0); position >= 0; )
+	{
+		// matches come in order, so we only ever walk forward to find the row
+		while (m_searchOffsets[row + 1] <= position)
+			row++;
+		matches[row] = true;
+
+		// and there is no need to look at the rest of this row
+		position = matcher.indexIn(text, length, m_searchOffsets[row + 1]);
+	}
+}
@@ -0,0 +1,134 @@
+/***************************************************************************
+
+	sortfilterproxymodel.h
+
+	Sorting and filtering of the list views
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef SORTFILTERPROXYMODEL_H
+#define SORTFILTERPROXYMODEL_H
+
+#include <QAbstractProxyModel>
+#include <QCollatorSortKey>
+#include <QStringMatcher>
+
+#include <functional>
+#include <vector>
+
+#include "searchquery.h"
+
+
+// ======================> SortFilterProxyModel
+
+// QSortFilterProxyModel asks the source model for every cell (as a QVariant) whenever the filter
+// changes, and compares QVariants when sorting; with tens of thousands of machines this makes
+// typing into the search box sluggish.  This proxy instead takes the text of the source model
+// once when it is reset, and keeps lower case copies of each row back to back to search through,
+// and collation keys of each column to sort with
+class SortFilterProxyModel : public QAbstractProxyModel
+{
+public:
+	// source models can implement this to supply the text of their cells without going through
+	// QVariant; otherwise we use the display role
+	class ITextSource
+	{
+	public:
+		virtual ~ITextSource() { }
+		virtual QString cellText(int row, int column) const = 0;
+
+		// source models can also evaluate fields and flags of the filter themselves, by returning
+		// a predicate (which should ignore SearchQuery::Term::m_negated); terms that they do not
+		// know about are matched against the column with that header, or failing that as text
+		virtual std::function<bool(int row)> compileFilterTerm(const SearchQuery::Term &term) const { return { }; }
+
+		// in tree mode, rows are shown under the row returned here (which must itself return -1)
+		virtual int parentRow(int row) const { return -1; }
+	};
+
+	// ctor
+	SortFilterProxyModel(QObject *parent);
+
+	// the filter is a SearchQuery; plain text is a case insensitive substring match against any
+	// column, like QSortFilterProxyModel::setFilterFixedString(), and when the new filter is
+	// narrower than the old one only the rows that are showing are looked at
+	const QString &filterText() const				{ return m_filterText; }
+	void setFilterText(const QString &text);
+
+	// compiles the filter again, for when what the source model's fields match has changed (see
+	// ITextSource::compileFilterTerm())
+	void refilter();
+
+	// in tree mode, rows are shown under their parent rows (see ITextSource::parentRow()), and
+	// parents are showing if any of their children match the filter; children are fetched when
+	// their parent is expanded, so mapFromSource() only finds them after that or revealSource()
+	bool treeMode() const							{ return m_treeMode; }
+	void setTreeMode(bool treeMode);
+	QModelIndex revealSource(const QModelIndex &sourceIndex);
+
+	// virtuals
+	virtual void setSourceModel(QAbstractItemModel *sourceModel) override;
+	virtual QModelIndex mapToSource(const QModelIndex &proxyIndex) const override;
+	virtual QModelIndex mapFromSource(const QModelIndex &sourceIndex) const override;
+	virtual QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+	virtual QModelIndex parent(const QModelIndex &child) const override;
+	virtual int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+	virtual int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+	virtual bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+	virtual bool canFetchMore(const QModelIndex &parent) const override;
+	virtual void fetchMore(const QModelIndex &parent) override;
+	virtual void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+private:
+	struct FilterTerm
+	{
+		QString						m_token;		// as typed, for telling whether one filter is narrower than another
+		QStringMatcher				m_matcher;		// lower case; used if there is no predicate
+		int							m_column;		// -1 to match against any column
+		std::function<bool(int)>	m_predicate;
+		bool						m_negated;
+	};
+
+	const ITextSource *								m_textSource;
+	int												m_sourceRowCount;
+	int												m_columnCount;
+	QString											m_searchText;		// lower case cells, each followed by '\n'
+	std::vector<int>								m_searchOffsets;	// where each row starts in m_searchText
+	std::vector<std::vector<QCollatorSortKey>>		m_collationKeys;	// by column; empty until sorted by
+	QString											m_filterText;		// lower case
+	std::vector<FilterTerm>							m_filterTerms;
+	int												m_sortColumn;
+	Qt::SortOrder									m_sortOrder;
+	bool											m_treeMode;
+	std::vector<int>								m_sortedRows;		// every source row, in sort order
+	std::vector<int>								m_proxyToSource;	// top level rows
+	std::vector<int>								m_sourceToProxy;	// -1 if filtered out; children are numbered within their parent
+	std::vector<int>								m_childOffsets;		// where the children of each top level row start in m_childRows
+	std::vector<int>								m_childRows;		// children of every top level row, in sort order
+	std::vector<bool>								m_fetchedRows;		// by source row
+
+	QString cellText(int row, int column) const;
+	int sourceParentRow(int row) const;
+	int childCount(int proxyRow) const;
+	void sourceReset();
+	void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+	void applyFilter(QString &&filterText, std::vector<FilterTerm> &&filterTerms, bool narrowing);
+	void changeLayout(const std::function<void()> &change, QAbstractItemModel::LayoutChangeHint hint);
+	std::vector<FilterTerm> compileFilter(const SearchQuery &query) const;
+	static bool isNarrowerFilter(const std::vector<FilterTerm> &filter, const std::vector<FilterTerm> &thanFilter);
+	bool rowMatchesFilter(int row) const;
+	bool rowMatchesTerm(int row, const FilterTerm &term) const;
+	void cellRange(int row, int column, int &begin, int &end) const;
+	const std::vector<QCollatorSortKey> &collationKeys(int column);
+	void sortRows();
+	void filterRows();
+	void narrowRows();
+	void buildRows(const std::vector<bool> &matches);
+	void findMatches(std::vector<bool> &matches) const;
+	void findText(const QStringMatcher &matcher, std::vector<bool> &matches) const;
+};
+
+
+#endif // SORTFILTERPROXYMODEL_H
@@ -16,30 +16,95 @@
 //  VARIABLES
 //**************************************************************************
 
-static const util::enum_parser<status::machine_phase> s_machine_phase_parser =
+static constexpr auto s_machine_phase_parser = util::make_static_enum_parser<status::machine_phase>(
 {
 	{ "preinit", status::machine_phase::PREINIT },
 	{ "init", status::machine_phase::INIT },
 	{ "reset", status::machine_phase::RESET },
 	{ "running", status::machine_phase::RUNNING },
 	{ "exit", status::machine_phase::EXIT }
-};
+});
 
-static const util::enum_parser<status::input::input_class> s_input_class_parser =
+static constexpr auto s_input_class_parser = util::make_static_enum_parser<status::input::input_class>(
 {
 	{ "controller", status::input::input_class::CONTROLLER, },
 	{ "misc", status::input::input_class::MISC, },
 	{ "keyboard", status::input::input_class::KEYBOARD, },
 	{ "config", status::input::input_class::CONFIG, },
 	{ "dipswitch", status::input::input_class::DIPSWITCH, },
-};
+});
 
-static const util::enum_parser<status::input_seq::type> s_inputseq_type_parser =
+static constexpr auto s_inputseq_type_parser = util::make_static_enum_parser<status::input_seq::type>(
 {
 	{ "standard", status::input_seq::type::STANDARD },
 	{ "increment", status::input_seq::type::INCREMENT },
 	{ "decrement", status::input_seq::type::DECREMENT }
-};
+});
+
+
+//**************************************************************************
+//  SCHEMAS
+//**************************************************************************
+
+static const auto s_status_schema = XmlParser::Schema(
+	XmlParser::Bind("phase",					&status::update::m_phase, s_machine_phase_parser),
+	XmlParser::Bind("paused",					&status::update::m_paused),
+	XmlParser::Bind("polling_input_seq",		&status::update::m_polling_input_seq),
+	XmlParser::Bind("has_input_using_mouse",	&status::update::m_has_input_using_mouse),
+	XmlParser::Bind("startup_text",				&status::update::m_startup_text),
+	XmlParser::Bind("debugger_present",			&status::update::m_debugger_present));
+
+static const auto s_video_schema = XmlParser::Schema(
+	XmlParser::Bind("speed_percent",			&status::update::m_speed_percent),
+	XmlParser::Bind("frameskip",				&status::update::m_frameskip),
+	XmlParser::Bind("effective_frameskip",		&status::update::m_effective_frameskip),
+	XmlParser::Bind("throttled",				&status::update::m_throttled),
+	XmlParser::Bind("throttle_rate",			&status::update::m_throttle_rate),
+	XmlParser::Bind("is_recording",				&status::update::m_is_recording));
+
+static const auto s_sound_schema = XmlParser::Schema(
+	XmlParser::Bind("attenuation",				&status::update::m_sound_attenuation));
+
+static const auto s_image_schema = XmlParser::Schema(
+	XmlParser::Bind("tag",						&status::image::m_tag),
+	XmlParser::Bind("instance_name",			&status::image::m_instance_name),
+	XmlParser::Bind("is_readable",				&status::image::m_is_readable),
+	XmlParser::Bind("is_writeable",				&status::image::m_is_writeable),
+	XmlParser::Bind("is_creatable",				&status::image::m_is_creatable),
+	XmlParser::Bind("must_be_loaded",			&status::image::m_must_be_loaded),
+	XmlParser::Bind("filename",					&status::image::m_file_name),
+	XmlParser::Bind("display",					&status::image::m_display));
+
+static const auto s_input_schema = XmlParser::Schema(
+	XmlParser::Bind("port_tag",					&status::input::m_port_tag),
+	XmlParser::Bind("name",						&status::input::m_name),
+	XmlParser::Bind("mask",						&status::input::m_mask),
+	XmlParser::Bind("class",					&status::input::m_class, s_input_class_parser),
+	XmlParser::Bind("group",					&status::input::m_group),
+	XmlParser::Bind("player",					&status::input::m_player),
+	XmlParser::Bind("type",						&status::input::m_type),
+	XmlParser::Bind("is_analog",				&status::input::m_is_analog),
+	XmlParser::Bind("first_keyboard_code",		&status::input::m_first_keyboard_code),
+	XmlParser::Bind("value",					&status::input::m_value));
+
+static const auto s_input_seq_schema = XmlParser::Schema(
+	XmlParser::Bind("type",						&status::input_seq::m_type, s_inputseq_type_parser),
+	XmlParser::Bind("tokens",					&status::input_seq::m_tokens));
+
+static const auto s_input_class_schema = XmlParser::Schema(
+	XmlParser::Bind("name",						&status::input_class::m_name),
+	XmlParser::Bind("enabled",					&status::input_class::m_enabled),
+	XmlParser::Bind("multi",					&status::input_class::m_multi));
+
+static const auto s_input_device_schema = XmlParser::Schema(
+	XmlParser::Bind("name",						&status::input_device::m_name),
+	XmlParser::Bind("id",						&status::input_device::m_id),
+	XmlParser::Bind("devindex",					&status::input_device::m_index));
+
+static const auto s_input_device_item_schema = XmlParser::Schema(
+	XmlParser::Bind("name",						&status::input_device_item::m_name),
+	XmlParser::Bind("token",					&status::input_device_item::m_token),
+	XmlParser::Bind("code",						&status::input_device_item::m_code));
 
 
 //**************************************************************************
@@ -176,25 +241,15 @@ status::update status::update::read(QDataStream &input_stream)
 	XmlParser xml;
 	xml.OnElementBegin({ "status" }, [&](const XmlParser::Attributes &attributes)
 	{
-		attributes.Get("phase",					result.m_phase, s_machine_phase_parser);
-		attributes.Get("paused",				result.m_paused);
-		attributes.Get("polling_input_seq",		result.m_polling_input_seq);
-		attributes.Get("has_input_using_mouse",	result.m_has_input_using_mouse);
-		attributes.Get("startup_text",			result.m_startup_text);
-		attributes.Get("debugger_present",		result.m_debugger_present);
+		s_status_schema.Apply(attributes, result);
 	});
 	xml.OnElementBegin({ "status", "video" }, [&](const XmlParser::Attributes &attributes)
 	{
-		attributes.Get("speed_percent",			result.m_speed_percent);
-		attributes.Get("frameskip",				result.m_frameskip);
-		attributes.Get("effective_frameskip",	result.m_effective_frameskip);
-		attributes.Get("throttled",				result.m_throttled);
-		attributes.Get("throttle_rate",			result.m_throttle_rate);
-		attributes.Get("is_recording",			result.m_is_recording);
+		s_video_schema.Apply(attributes, result);
 	});
 	xml.OnElementBegin({ "status", "sound" }, [&](const XmlParser::Attributes &attributes)
 	{
-		attributes.Get("attenuation",		result.m_sound_attenuation);
+		s_sound_schema.Apply(attributes, result);
 	});
 	xml.OnElementBegin({ "status", "images" }, [&](const XmlParser::Attributes &)
 	{
@@ -203,14 +258,7 @@ status::update status::update::read(QDataStream &input_stream)
 	xml.OnElementBegin({ "status", "images", "image" }, [&](const XmlParser::Attributes &attributes)
 	{
 		image &image = result.m_images.value().emplace_back();
-		attributes.Get("tag",				image.m_tag);
-		attributes.Get("instance_name",		image.m_instance_name);
-		attributes.Get("is_readable",		image.m_is_readable, false);
-		attributes.Get("is_writeable",		image.m_is_writeable, false);
-		attributes.Get("is_creatable",		image.m_is_creatable, false);
-		attributes.Get("must_be_loaded",	image.m_must_be_loaded, false);
-		attributes.Get("filename",			image.m_file_name);
-		attributes.Get("display",			image.m_display);
+		s_image_schema.Apply(attributes, image);
 		normalize_tag(image.m_tag);
 	});
 	xml.OnElementBegin({ "status", "inputs" }, [&](const XmlParser::Attributes &)
@@ -220,23 +268,13 @@ status::update status::update::read(QDataStream &input_stream)
 	xml.OnElementBegin({ "status", "inputs", "input" }, [&](const XmlParser::Attributes &attributes)
 	{
 		input &input = result.m_inputs.value().emplace_back();
-		attributes.Get("port_tag",				input.m_port_tag);
-		attributes.Get("name",					input.m_name);
-		attributes.Get("mask",					input.m_mask);
-		attributes.Get("class",					input.m_class, s_input_class_parser);
-		attributes.Get("group",					input.m_group);
-		attributes.Get("player",				input.m_player);
-		attributes.Get("type",					input.m_type);
-		attributes.Get("is_analog",				input.m_is_analog);
-		attributes.Get("first_keyboard_code",	input.m_first_keyboard_code);
-		attributes.Get("value",					input.m_value);
+		s_input_schema.Apply(attributes, input);
 		normalize_tag(input.m_port_tag);
 	});
 	xml.OnElementBegin({ "status", "inputs", "input", "seq" }, [&](const XmlParser::Attributes &attributes)
 	{
 		input_seq &seq = util::last(result.m_inputs.value()).m_seqs.emplace_back();
-		attributes.Get("type",				seq.m_type, s_inputseq_type_parser);
-		attributes.Get("tokens",			seq.m_tokens);
+		s_input_seq_schema.Apply(attributes, seq);
 	});
 	xml.OnElementBegin({ "status", "input_devices" }, [&](const XmlParser::Attributes &)
 	{
@@ -245,23 +283,17 @@ status::update status::update::read(QDataStream &input_stream)
 	xml.OnElementBegin({ "status", "input_devices", "class" }, [&](const XmlParser::Attributes &attributes)
 	{
 		input_class &input_class = result.m_input_classes.value().emplace_back();
-		attributes.Get("name",				input_class.m_name);
-		attributes.Get("enabled",			input_class.m_enabled);
-		attributes.Get("multi",				input_class.m_multi);
+		s_input_class_schema.Apply(attributes, input_class);
 	});
 	xml.OnElementBegin({ "status", "input_devices", "class", "device" }, [&](const XmlParser::Attributes &attributes)
 	{
 		input_device &input_device = result.m_input_classes.value().back().m_devices.emplace_back();
-		attributes.Get("name",				input_device.m_name);
-		attributes.Get("id",				input_device.m_id);
-		attributes.Get("devindex",			input_device.m_index);
+		s_input_device_schema.Apply(attributes, input_device);
 	});
 	xml.OnElementBegin({ "status", "input_devices", "class", "device", "item" }, [&](const XmlParser::Attributes &attributes)
 	{
 		input_device_item &item = result.m_input_classes.value().back().m_devices.back().m_items.emplace_back();
-		attributes.Get("name",				item.m_name);
-		attributes.Get("token",				item.m_token);
-		attributes.Get("code",				item.m_code);
+		s_input_device_item_schema.Apply(attributes, item);
 	});
 
 	// parse the XML
@@ -9,31 +9,30 @@
 #include <QHeaderView>
 #include <QLineEdit>
 #include <QTableView>
-#include <QSortFilterProxyModel>
+#include <QTreeView>
 
 #include "tableviewmanager.h"
 #include "prefs.h"
+#include "sortfilterproxymodel.h"
 
 
 //-------------------------------------------------
 //  ctor
 //-------------------------------------------------
 
-TableViewManager::TableViewManager(QTableView &tableView, QAbstractItemModel &itemModel, QLineEdit *lineEdit, Preferences &prefs, const Description &desc)
-    : QObject((QObject *) &tableView)
+TableViewManager::TableViewManager(QAbstractItemView &view, QAbstractItemModel &itemModel, QLineEdit *lineEdit, Preferences &prefs, const Description &desc)
+    : QObject((QObject *) &view)
     , m_prefs(prefs)
     , m_desc(desc)
+    , m_keySource(dynamic_cast<const IKeySource *>(&itemModel))
     , m_columnCount(-1)
     , m_proxyModel(nullptr)
     , m_currentlyApplyingColumnPrefs(false)
 {
-    // create a proxy model for sorting
-    m_proxyModel = new QSortFilterProxyModel((QObject *)&tableView);
+    // create a proxy model for sorting; it sorts case insensitively by locale, and filters by
+    // whatever query is in the search box
+    m_proxyModel = new SortFilterProxyModel((QObject *)&view);
     m_proxyModel->setSourceModel(&itemModel);
-    m_proxyModel->setSortCaseSensitivity(Qt::CaseSensitivity::CaseInsensitive);
-    m_proxyModel->setSortLocaleAware(true);
-    m_proxyModel->setFilterCaseSensitivity(Qt::CaseSensitivity::CaseInsensitive);
-    m_proxyModel->setFilterKeyColumn(-1);
 
     // do we have a search box?
     if (lineEdit)
@@ -41,18 +40,19 @@ TableViewManager::TableViewManager(QTableView &tableView, QAbstractItemModel &it
         // set the initial text on the search box
         const QString &text = m_prefs.GetSearchBoxText(desc.m_name);
         lineEdit->setText(text);
-        m_proxyModel->setFilterFixedString(text);
+        m_proxyModel->setFilterText(text);
+
+        // the filter is a query, which is not obvious from looking at it
+        lineEdit->setToolTip("Search for text in any column, or in just one (e.g. - \"manufacturer:capcom\" or \"year:1990..1995\"); "
+            "quote text with spaces in it, and put '-' in front of anything that should not match");
 
         // make the search box functional
-        auto callback = [this, lineEdit, &tableView, descName{ desc.m_name }]()
+        auto callback = [this, lineEdit, descName{ desc.m_name }]()
         {
-            // change the filter
+            // change the filter; whatever was selected is shown again when the proxy model resets
             QString text = lineEdit->text();
             m_prefs.SetSearchBoxText(descName, QString(text));
-            m_proxyModel->setFilterFixedString(text);
-
-            // ensure that whatever was selected stays visible
-            applySelectedValue();
+            m_proxyModel->setFilterText(text);
         };
         connect(lineEdit, &QLineEdit::textEdited, this, callback);
     }
@@ -63,13 +63,13 @@ TableViewManager::TableViewManager(QTableView &tableView, QAbstractItemModel &it
         m_columnCount++;
 
     // configure the header
-    tableView.horizontalHeader()->setSectionsMovable(true);
+    header().setSectionsMovable(true);
 
     // set the model
-    tableView.setModel(m_proxyModel);
+    view.setModel(m_proxyModel);
 
     // handle selection
-    connect(tableView.selectionModel(), &QItemSelectionModel::selectionChanged, this, [this, &itemModel](const QItemSelection &newSelection, const QItemSelection &oldSelection)
+    connect(view.selectionModel(), &QItemSelectionModel::selectionChanged, this, [this, &itemModel](const QItemSelection &newSelection, const QItemSelection &oldSelection)
     {
 		QModelIndexList selectedIndexes = newSelection.indexes();
 		if (!selectedIndexes.empty())
@@ -81,28 +81,33 @@ TableViewManager::TableViewManager(QTableView &tableView, QAbstractItemModel &it
 		}
 	});
 
-    // handle refreshing the selection
-    connect(&itemModel, &QAbstractItemModel::modelReset, this, [this]()
+    // handle refreshing the selection; the proxy model resets when the item model does or the tree
+    // mode changes, and changes its layout when the filter or sort order does
+    connect(m_proxyModel, &QAbstractItemModel::modelReset, this, [this]()
+    {
+        applySelectedValue();
+    });
+    connect(m_proxyModel, &QAbstractItemModel::layoutChanged, this, [this]()
     {
         applySelectedValue();
     });
 
     // handle resizing
-	connect(tableView.horizontalHeader(), &QHeaderView::sectionResized, this, [this](int logicalIndex, int oldSize, int newSize)
+	connect(&header(), &QHeaderView::sectionResized, this, [this](int logicalIndex, int oldSize, int newSize)
 	{
         if (!m_currentlyApplyingColumnPrefs)
             persistColumnPrefs();
 	});
 
 	// handle reordering
-    connect(tableView.horizontalHeader(), &QHeaderView::sectionMoved, this, [this](int logicalIndex, int oldVisualIndex, int newVisualIndex)
+    connect(&header(), &QHeaderView::sectionMoved, this, [this](int logicalIndex, int oldVisualIndex, int newVisualIndex)
     {
         if (!m_currentlyApplyingColumnPrefs)
             persistColumnPrefs();
     });
 
     // handle when sort order changes
-    connect(tableView.horizontalHeader(), &QHeaderView::sortIndicatorChanged, this, [this](int logicalIndex, Qt::SortOrder order)
+    connect(&header(), &QHeaderView::sortIndicatorChanged, this, [this](int logicalIndex, Qt::SortOrder order)
     {
         if (!m_currentlyApplyingColumnPrefs)
             persistColumnPrefs();
@@ -114,10 +119,10 @@ TableViewManager::TableViewManager(QTableView &tableView, QAbstractItemModel &it
 //  setup
 //-------------------------------------------------
 
-TableViewManager &TableViewManager::setup(QTableView &tableView, QAbstractItemModel &itemModel, QLineEdit *lineEdit, Preferences &prefs, const Description &desc)
+TableViewManager &TableViewManager::setup(QAbstractItemView &view, QAbstractItemModel &itemModel, QLineEdit *lineEdit, Preferences &prefs, const Description &desc)
 {
     // set up a TableViewManager
-    TableViewManager &manager = *new TableViewManager(tableView, itemModel, lineEdit, prefs, desc);
+    TableViewManager &manager = *new TableViewManager(view, itemModel, lineEdit, prefs, desc);
 
     // and read the prefs
     manager.applyColumnPrefs();
@@ -128,12 +133,27 @@ TableViewManager &TableViewManager::setup(QTableView &tableView, QAbstractItemMo
 
 
 //-------------------------------------------------
-//  parentAsTableView
+//  parentAsView
+//-------------------------------------------------
+
+QAbstractItemView &TableViewManager::parentAsView() const
+{
+    return *dynamic_cast<QAbstractItemView *>(QObject::parent());
+}
+
+
+//-------------------------------------------------
+//  header - tree views only have the one header,
+//  where table views have two
 //-------------------------------------------------
 
-const QTableView &TableViewManager::parentAsTableView() const
+QHeaderView &TableViewManager::header() const
 {
-    return *dynamic_cast<const QTableView *>(QObject::parent());
+    QAbstractItemView &view = parentAsView();
+    QTreeView *treeView = dynamic_cast<QTreeView *>(&view);
+    return treeView
+        ? *treeView->header()
+        : *dynamic_cast<QTableView &>(view).horizontalHeader();
 }
 
 
@@ -146,8 +166,8 @@ void TableViewManager::applyColumnPrefs()
     // we are applying column prefs - we don't want to trample on ourselves
     m_currentlyApplyingColumnPrefs = true;
 
-    // identify the QTableView
-    QTableView &tableView = *dynamic_cast<QTableView *>(parent());
+    // identify the header
+    QHeaderView &headerView = header();
 
     // get the preferences
     const std::unordered_map<std::string, ColumnPrefs> &columnPrefs = m_prefs.GetColumnPrefs(m_desc.m_name);
@@ -172,14 +192,14 @@ void TableViewManager::applyColumnPrefs()
         }
 
         // resize the column
-        tableView.horizontalHeader()->resizeSection(logicalColumn, width);
+        headerView.resizeSection(logicalColumn, width);
 
         // track the order
         logicalColumnOrdering[logicalColumn] = order;
     }
 
     // specify the sort indicator
-    tableView.horizontalHeader()->setSortIndicator(sortLogicalColumn, sortType);
+    headerView.setSortIndicator(sortLogicalColumn, sortType);
 
     // reorder columns appropriately
     for (int column = 0; column < m_columnCount - 1; column++)
@@ -193,7 +213,7 @@ void TableViewManager::applyColumnPrefs()
             if (iter != logicalColumnOrdering.end())
             {
                 // move on the header
-                tableView.horizontalHeader()->moveSection(iter - logicalColumnOrdering.begin(), column);
+                headerView.moveSection(iter - logicalColumnOrdering.begin(), column);
 
                 // update the ordering
                 logicalColumnOrdering.erase(iter);
@@ -213,8 +233,7 @@ void TableViewManager::applyColumnPrefs()
 
 void TableViewManager::persistColumnPrefs()
 {
-	const QTableView &tableView = parentAsTableView();
-    const QHeaderView &headerView = *tableView.horizontalHeader();
+    const QHeaderView &headerView = header();
 
 	// start preparing column prefs
 	std::unordered_map<std::string, ColumnPrefs> col_prefs;
@@ -242,7 +261,7 @@ void TableViewManager::persistColumnPrefs()
 
 void TableViewManager::applySelectedValue()
 {
-    QTableView &tableView = *dynamic_cast<QTableView *>(parent());
+    QAbstractItemView &view = parentAsView();
     QAbstractItemModel &itemModel = *m_proxyModel->sourceModel();
 
     const QString &selectedValue = m_prefs.GetListViewSelection(m_desc.m_name, util::g_empty_string);
@@ -250,28 +269,35 @@ void TableViewManager::applySelectedValue()
 
     if (!selectedValue.isEmpty())
     {
-        QModelIndexList matches = itemModel.match(itemModel.index(0, 0), Qt::DisplayRole, selectedValue, 9999);
-        for (const QModelIndex &match : matches)
+        // this happens on every keystroke in the search box, so we do not want to go through every row
+        QModelIndex sourceIndex;
+        if (m_keySource)
         {
-            if (match.column() == m_desc.m_keyColumnIndex)
-            {
-                selectedIndex = m_proxyModel->mapFromSource(match);
-                break;
-            }
+            int row = m_keySource->findRowByKey(selectedValue);
+            if (row >= 0)
+                sourceIndex = itemModel.index(row, m_desc.m_keyColumnIndex);
+        }
+        else
+        {
+            QModelIndexList matches = itemModel.match(itemModel.index(0, m_desc.m_keyColumnIndex), Qt::DisplayRole, selectedValue, 1, Qt::MatchExactly);
+            if (!matches.isEmpty())
+                sourceIndex = matches[0];
         }
+        // in tree mode this may be a child that has not been fetched yet
+        selectedIndex = m_proxyModel->revealSource(sourceIndex);
     }
 
     // we've figured out what we want to select (if anything), do it!
     if (selectedIndex.isValid())
     {
         // not sure why we have to call scrollTo() twice, but it doesn't
-        // seem to always register without it
-        tableView.scrollTo(selectedIndex);
-        tableView.selectRow(selectedIndex.row());
-        tableView.scrollTo(selectedIndex);
+        // seem to always register without it; tree views expand the parent
+        view.scrollTo(selectedIndex);
+        view.selectionModel()->setCurrentIndex(selectedIndex, QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
+        view.scrollTo(selectedIndex);
     }
     else
     {
-        tableView.clearSelection();
+        view.clearSelection();
     }
 }
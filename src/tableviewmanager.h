@@ -15,12 +15,13 @@
 
 QT_BEGIN_NAMESPACE
 class QAbstractItemModel;
+class QAbstractItemView;
+class QHeaderView;
 class QLineEdit;
-class QSortFilterProxyModel;
-class QTableView;
 QT_END_NAMESPACE
 
 class Preferences;
+class SortFilterProxyModel;
 
 
 // ======================> TableViewManager
@@ -28,6 +29,15 @@ class Preferences;
 class TableViewManager : public QObject
 {
 public:
+    // item models should implement this, so that the selection can be found without looking
+    // through every row; returns -1 if there is no row with this key
+    class IKeySource
+    {
+    public:
+        virtual ~IKeySource() { }
+        virtual int findRowByKey(const QString &key) const = 0;
+    };
+
     struct ColumnDesc
     {
         const char *    m_id;
@@ -41,21 +51,23 @@ public:
         const ColumnDesc *  m_columns;
     };
 
-    // static methods
-    static TableViewManager &setup(QTableView &tableView, QAbstractItemModel &itemModel, QLineEdit *lineEdit, Preferences &prefs, const Description &desc);
+    // static methods; the view can be a QTableView or a QTreeView
+    static TableViewManager &setup(QAbstractItemView &view, QAbstractItemModel &itemModel, QLineEdit *lineEdit, Preferences &prefs, const Description &desc);
 
 private:
     Preferences &           m_prefs;
     const Description &     m_desc;
+    const IKeySource *      m_keySource;
     int                     m_columnCount;
-    QSortFilterProxyModel * m_proxyModel;
+    SortFilterProxyModel *  m_proxyModel;
     bool                    m_currentlyApplyingColumnPrefs;
 
     // ctor
-    TableViewManager(QTableView &tableView, QAbstractItemModel &itemModel, QLineEdit *lineEdit, Preferences &prefs, const Description &desc);
+    TableViewManager(QAbstractItemView &view, QAbstractItemModel &itemModel, QLineEdit *lineEdit, Preferences &prefs, const Description &desc);
 
     // methods
-    const QTableView &parentAsTableView() const;
+    QAbstractItemView &parentAsView() const;
+    QHeaderView &header() const;
     void applyColumnPrefs();
     void persistColumnPrefs();
     void applySelectedValue();
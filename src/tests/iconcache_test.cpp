@@ -0,0 +1,183 @@
+/***************************************************************************
+
+    iconcache_test.cpp
+
+    Unit tests for iconcache.cpp
+
+***************************************************************************/
+
+#include <QTemporaryDir>
+
+#include "iconcache.h"
+#include "test.h"
+
+static const int ICON_SIZE = 16;
+
+class IconCache::test : public QObject
+{
+    Q_OBJECT
+
+private slots:
+	void general();
+	void invalidation();
+	void addedBeforeSave();
+
+private:
+	static QImage makeIcon(QRgb color);
+	static std::vector<IconCache::Source> makeSources(qint64 mtime0, qint64 mtime1);
+};
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  makeIcon
+//-------------------------------------------------
+
+QImage IconCache::test::makeIcon(QRgb color)
+{
+	QImage image(ICON_SIZE, ICON_SIZE, QImage::Format_ARGB32);
+	image.fill(color);
+	image.setPixel(0, 0, qRgba(1, 2, 3, 255));
+	return image;
+}
+
+
+//-------------------------------------------------
+//  makeSources
+//-------------------------------------------------
+
+std::vector<IconCache::Source> IconCache::test::makeSources(qint64 mtime0, qint64 mtime1)
+{
+	return { Source { "/icons", 0, mtime0 }, Source { "/icons.zip", 1234, mtime1 } };
+}
+
+
+//-------------------------------------------------
+//  general
+//-------------------------------------------------
+
+void IconCache::test::general()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	QString fileName = dir.filePath("icons.cache");
+
+	// nothing there to begin with
+	IconCache cache(ICON_SIZE);
+	cache.open(fileName, makeSources(100, 200));
+	QVERIFY(!cache.find("pacman"));
+	cache.add("pacman", 0, makeIcon(qRgb(255, 255, 0)));
+	cache.add("dkong", 1, makeIcon(qRgb(255, 0, 0)));
+	QVERIFY(cache.find("pacman"));
+	QVERIFY(cache.save());
+
+	// what we get back must be what we put in, converted to the format we want
+	cache.open(fileName, makeSources(100, 200));
+	std::optional<QImage> pacman = cache.find("pacman");
+	std::optional<QImage> dkong = cache.find("dkong");
+	QVERIFY(pacman && dkong);
+	QVERIFY(pacman->copy() == makeIcon(qRgb(255, 255, 0)).convertToFormat(pacman->format()));
+	QVERIFY(dkong->copy() == makeIcon(qRgb(255, 0, 0)).convertToFormat(dkong->format()));
+	QVERIFY(!cache.find("galaga"));
+
+	// adding more keeps what was there
+	cache.add("galaga", 1, makeIcon(qRgb(0, 0, 255)));
+	QVERIFY(cache.save());
+	cache.open(fileName, makeSources(100, 200));
+	QVERIFY(cache.find("pacman"));
+	QVERIFY(cache.find("dkong"));
+	QVERIFY(cache.find("galaga"));
+
+	// icons of the wrong size do not go in, and a cache for another size ignores the file
+	cache.add("mspacman", 0, QImage(ICON_SIZE * 2, ICON_SIZE * 2, QImage::Format_ARGB32));
+	QVERIFY(cache.save());
+	cache.open(fileName, makeSources(100, 200));
+	QVERIFY(!cache.find("mspacman"));
+	IconCache largeCache(ICON_SIZE * 2);
+	largeCache.open(fileName, makeSources(100, 200));
+	QVERIFY(!largeCache.find("pacman"));
+}
+
+
+//-------------------------------------------------
+//  invalidation
+//-------------------------------------------------
+
+void IconCache::test::invalidation()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	QString fileName = dir.filePath("icons.cache");
+
+	IconCache cache(ICON_SIZE);
+	cache.open(fileName, makeSources(100, 200));
+	cache.add("pacman", 0, makeIcon(qRgb(255, 255, 0)));
+	cache.add("dkong", 1, makeIcon(qRgb(255, 0, 0)));
+	QVERIFY(cache.save());
+
+	// a change to a later source only affects icons from it
+	cache.open(fileName, makeSources(100, 201));
+	QVERIFY(cache.find("pacman"));
+	QVERIFY(!cache.find("dkong"));
+
+	// but a change to an earlier source affects everything after, because it may now have
+	// icons that take precedence
+	cache.open(fileName, makeSources(101, 200));
+	QVERIFY(!cache.find("pacman"));
+	QVERIFY(!cache.find("dkong"));
+
+	// a garbled file is ignored
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::WriteOnly));
+	file.write("garbage");
+	file.close();
+	cache.open(fileName, makeSources(100, 200));
+	QVERIFY(!cache.find("pacman"));
+}
+
+
+//-------------------------------------------------
+//  addedBeforeSave - the icon loader evicts icons
+//	from memory, and gets them back from here;
+//	that has to work for icons decoded this session
+//	before they are ever saved
+//-------------------------------------------------
+
+void IconCache::test::addedBeforeSave()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	QString fileName = dir.filePath("icons.cache");
+
+	IconCache cache(ICON_SIZE);
+	cache.open(fileName, makeSources(100, 200));
+	cache.add("galaga", 0, makeIcon(qRgb(0, 0, 255)));
+	QVERIFY(cache.save());
+
+	// decoded, and then evicted
+	cache.add("pacman", 0, makeIcon(qRgb(255, 255, 0)));
+	std::optional<QImage> pacman = cache.find("pacman");
+	QVERIFY(pacman);
+	QVERIFY(pacman->copy() == makeIcon(qRgb(255, 255, 0)).convertToFormat(pacman->format()));
+
+	// icons decoded again supersede what was saved
+	cache.add("galaga", 1, makeIcon(qRgb(255, 0, 0)));
+	std::optional<QImage> galaga = cache.find("galaga");
+	QVERIFY(galaga);
+	QVERIFY(galaga->copy() == makeIcon(qRgb(255, 0, 0)).convertToFormat(galaga->format()));
+
+	// and saving does not change what we get back
+	QVERIFY(cache.save());
+	pacman = cache.find("pacman");
+	galaga = cache.find("galaga");
+	QVERIFY(pacman && galaga);
+	QVERIFY(pacman->copy() == makeIcon(qRgb(255, 255, 0)).convertToFormat(pacman->format()));
+	QVERIFY(galaga->copy() == makeIcon(qRgb(255, 0, 0)).convertToFormat(galaga->format()));
+}
+
+
+static TestFixture<IconCache::test> fixture;
+#include "iconcache_test.moc"
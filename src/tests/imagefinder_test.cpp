@@ -0,0 +1,101 @@
+/***************************************************************************
+
+    imagefinder_test.cpp
+
+    Unit tests for imagefinder.cpp
+
+***************************************************************************/
+
+#include <QDir>
+#include <QTemporaryDir>
+
+#include "imagefinder.h"
+#include "quazip/quazipfile.h"
+#include "test.h"
+
+namespace
+{
+    class Test : public QObject
+    {
+        Q_OBJECT
+
+    private slots:
+		void directory();
+		void zip();
+	};
+}
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  directory
+//-------------------------------------------------
+
+void Test::directory()
+{
+	// snapshots come in both flat and per-machine layouts, and software is in per-list directories
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	QVERIFY(QDir(dir.path()).mkpath("PacMan"));
+	QVERIFY(QDir(dir.path()).mkpath("nes"));
+	for (const char *fileName : { "galaga.png", "PacMan/0000.png", "nes/SMB.png" })
+	{
+		QFile file(dir.filePath(fileName));
+		QVERIFY(file.open(QIODevice::WriteOnly));
+		file.write(fileName);
+	}
+
+	std::unique_ptr<ImageFinder> finder = ImageFinder::create(dir.path());
+	QVERIFY(finder);
+	QVERIFY(finder->readFile("galaga.png") == "galaga.png");
+	QVERIFY(finder->readFile("pacman/0000.png") == "PacMan/0000.png");
+	QVERIFY(finder->readFile("NES/smb.png") == "nes/SMB.png");
+	QVERIFY(!finder->readFile("digdug.png"));
+	QVERIFY(!finder->readFile("digdug/0000.png"));
+
+	// directories are listed once, so misses do not go to the file system
+	std::uint64_t probeCount = finder->probeCount();
+	QVERIFY(!finder->readFile("nes/zelda.png"));
+	QVERIFY(!finder->readFile("digdug/0000.png"));
+	QVERIFY(finder->probeCount() == probeCount);
+}
+
+
+//-------------------------------------------------
+//  zip
+//-------------------------------------------------
+
+void Test::zip()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	QString zipPath = dir.filePath("snap.zip");
+	{
+		QuaZip zip(zipPath);
+		QVERIFY(zip.open(QuaZip::Mode::mdCreate));
+		for (const char *fileName : { "galaga.png", "nes/SMB.png" })
+		{
+			QuaZipFile file(&zip);
+			QVERIFY(file.open(QIODevice::WriteOnly, QuaZipNewInfo(fileName)));
+			file.write(fileName);
+			file.close();
+		}
+		zip.close();
+	}
+
+	std::unique_ptr<ImageFinder> finder = ImageFinder::create(zipPath);
+	QVERIFY(finder);
+	QVERIFY(finder->readFile("GALAGA.png") == "galaga.png");
+	QVERIFY(finder->readFile("nes/smb.png") == "nes/SMB.png");
+	QVERIFY(!finder->readFile("smb.png"));
+
+	// neither a directory nor an archive
+	QVERIFY(!ImageFinder::create(dir.filePath("nonexistant")));
+}
+
+
+static TestFixture<Test> fixture;
+#include "imagefinder_test.moc"
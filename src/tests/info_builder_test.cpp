@@ -19,6 +19,9 @@ namespace
 
     private slots:
         void general();
+		void parallel();
+		void parallelError();
+		void findMachine();
 
 	private:
 		void readSampleListXml(QDataStream &output);
@@ -118,5 +121,117 @@ void Test::general()
 }
 
 
+//-------------------------------------------------
+//  parallel
+//-------------------------------------------------
+
+void Test::parallel()
+{
+	// build the sample database serially
+	QByteArray serialByteArray;
+	{
+		QBuffer buffer(&serialByteArray);
+		buffer.open(QIODevice::WriteOnly);
+		QDataStream bufferStream(&buffer);
+		readSampleListXml(bufferStream);
+	}
+
+	// get the test asset
+	QFile testAsset(":/resources/listxml.xml");
+	QVERIFY(testAsset.open(QFile::ReadOnly));
+	QByteArray listXml = testAsset.readAll();
+
+	// build it in parallel with a number of different chunk counts; the results should
+	// be identical to the serial build
+	for (int chunkCount : { 1, 2, 3, 7, 200 })
+	{
+		info::database_builder builder;
+		QString error_message;
+		bool success = builder.process_xml_parallel(listXml.constData(), listXml.size(), error_message, chunkCount);
+		QVERIFY(success && error_message.isEmpty());
+
+		QByteArray parallelByteArray;
+		{
+			QBuffer buffer(&parallelByteArray);
+			buffer.open(QIODevice::WriteOnly);
+			QDataStream bufferStream(&buffer);
+			builder.emit_info(bufferStream);
+		}
+		QVERIFY(parallelByteArray == serialByteArray);
+	}
+}
+
+
+//-------------------------------------------------
+//  parallelError
+//-------------------------------------------------
+
+void Test::parallelError()
+{
+	// get the test asset, and break the last machine
+	QFile testAsset(":/resources/listxml.xml");
+	QVERIFY(testAsset.open(QFile::ReadOnly));
+	QByteArray listXml = testAsset.readAll();
+	int position = listXml.lastIndexOf("</machine>");
+	QVERIFY(position > 0);
+	listXml.replace(position, 10, "</mechine>");
+
+	// parse it serially
+	QString serialErrorMessage;
+	{
+		info::database_builder builder;
+		QDataStream input(listXml);
+		QVERIFY(!builder.process_xml(input, serialErrorMessage));
+	}
+	QVERIFY(serialErrorMessage.contains("(line "));
+
+	// and in parallel; the error is in the last chunk, but should be reported at the same line
+	for (int chunkCount : { 2, 3, 7 })
+	{
+		info::database_builder builder;
+		QString error_message;
+		QVERIFY(!builder.process_xml_parallel(listXml.constData(), listXml.size(), error_message, chunkCount));
+		QVERIFY(error_message == serialErrorMessage);
+	}
+}
+
+
+//-------------------------------------------------
+//  findMachine
+//-------------------------------------------------
+
+void Test::findMachine()
+{
+	QByteArray byteArray;
+	{
+		QBuffer buffer(&byteArray);
+		buffer.open(QIODevice::WriteOnly);
+		QDataStream bufferStream(&buffer);
+		readSampleListXml(bufferStream);
+	}
+	QDataStream input(byteArray);
+	info::database db;
+	QVERIFY(db.load(input));
+
+	// every machine can be found by name
+	for (std::uint32_t i = 0; i < db.machines().size(); i++)
+	{
+		const QString &name = db.machines()[i].name();
+		QVERIFY(db.find_machine_index(name) == i);
+		QVERIFY(db.find_machine(name)->name() == name);
+	}
+
+	// names have to match exactly
+	QVERIFY(!db.find_machine_index("coc"));
+	QVERIFY(!db.find_machine_index("COCO"));
+	QVERIFY(!db.find_machine_index("zzzzzz"));
+	QVERIFY(!db.find_machine_index(""));
+
+	// and nothing can be found once the database is reset
+	db.reset();
+	QVERIFY(!db.find_machine("coco"));
+}
+
+
 static TestFixture<Test> fixture;
 #include "info_builder_test.moc"
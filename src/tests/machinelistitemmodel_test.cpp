@@ -0,0 +1,215 @@
+/***************************************************************************
+
+    machinelistitemmodel_test.cpp
+
+    Unit tests for machinelistitemmodel.cpp
+
+***************************************************************************/
+
+#include <QBuffer>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "iconloader.h"
+#include "info_builder.h"
+#include "machinelistitemmodel.h"
+#include "prefs.h"
+#include "test.h"
+
+namespace
+{
+    class Test : public QObject
+    {
+        Q_OBJECT
+
+    private slots:
+		void initTestCase();
+		void flags();
+		void machineNames();
+		void years();
+		void textFields();
+		void software();
+
+	private:
+		info::database	m_infoDb;
+
+		QStringList filter(const QString &filterText, software_index::ptr &&softwareIndex = { });
+	};
+}
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  initTestCase
+//-------------------------------------------------
+
+void Test::initTestCase()
+{
+	// process the sample -listxml output
+	QFile testAsset(":/resources/listxml.xml");
+	QVERIFY(testAsset.open(QFile::ReadOnly));
+	QDataStream input(&testAsset);
+	info::database_builder builder;
+	QString error_message;
+	QVERIFY(builder.process_xml(input, error_message));
+
+	// and load it into the database
+	QByteArray byteArray;
+	{
+		QBuffer buffer(&byteArray);
+		QVERIFY(buffer.open(QIODevice::WriteOnly));
+		QDataStream output(&buffer);
+		builder.emit_info(output);
+	}
+	QBuffer buffer(&byteArray);
+	QVERIFY(buffer.open(QIODevice::ReadOnly));
+	QDataStream stream(&buffer);
+	QVERIFY(m_infoDb.load(stream));
+}
+
+
+//-------------------------------------------------
+//  filter - returns the (sorted) names of the
+//	machines that the filter text lets through
+//-------------------------------------------------
+
+QStringList Test::filter(const QString &filterText, software_index::ptr &&softwareIndex)
+{
+	Preferences prefs;
+	IconLoader iconLoader(prefs);
+	MachineListItemModel model(nullptr, m_infoDb, iconLoader);
+	if (softwareIndex)
+		model.setSoftwareIndex(std::move(softwareIndex));
+
+	SortFilterProxyModel proxy(nullptr);
+	proxy.setSourceModel(&model);
+	proxy.setFilterText(filterText);
+
+	QStringList result;
+	for (int row = 0; row < proxy.rowCount(); row++)
+		result << proxy.data(proxy.index(row, (int)MachineListItemModel::Column::Machine)).toString();
+	result.sort();
+	return result;
+}
+
+
+//-------------------------------------------------
+//  flags
+//-------------------------------------------------
+
+void Test::flags()
+{
+	QVERIFY(filter("is:clone cocoloco") == QStringList({ "cocolocoa", "cocolocob" }));
+	QVERIFY(filter("-is:clone year:1980..1981") == QStringList({ "coco", "cocoloco" }));
+
+	// without the field, "clone" is just text, and nothing here is described as one
+	QVERIFY(filter("clone").isEmpty());
+	QVERIFY(filter("is:xyzzy").isEmpty());
+}
+
+
+//-------------------------------------------------
+//  machineNames
+//-------------------------------------------------
+
+void Test::machineNames()
+{
+	QStringList cocoClones = { "coco2", "coco2b", "coco2bh", "coco2h", "coco3", "coco3dw1", "coco3h", "coco3p", "cocoe", "cocoeh", "cocoh" };
+	QVERIFY(filter("cloneof:coco") == cocoClones);
+	QVERIFY(filter("cloneof:COCO") == cocoClones);
+	QVERIFY(filter("romof:cocoloco") == QStringList({ "cocolocoa", "cocolocob" }));
+
+	// these are exact, so prefixes and machines that do not exist match nothing
+	QVERIFY(filter("cloneof:coc").isEmpty());
+	QVERIFY(filter("cloneof:xyzzy").isEmpty());
+	QVERIFY(filter("-cloneof:coco cocoh").isEmpty());
+}
+
+
+//-------------------------------------------------
+//  years
+//-------------------------------------------------
+
+void Test::years()
+{
+	QVERIFY(filter("year:1986") == QStringList({ "coco3", "coco3p" }));
+	QVERIFY(filter("year:1981 cocoloco") == QStringList({ "cocoloco", "cocolocoa", "cocolocob" }));
+
+	// "19??" could be anything in range, but "1985?" is only ever 1985
+	QVERIFY(filter("year:1983..1985") == QStringList({ "coco2", "coco2b", "coco2bh", "coco2h", "coco3dw1", "coco3h", "cocoeh", "cocoh" }));
+	QVERIFY(filter("year:1984..1984 coco2") == QStringList({ "coco2bh", "coco2h" }));
+	QVERIFY(filter("year:..1980") == QStringList({ "coco", "coco2bh", "coco2h", "coco3dw1", "coco3h", "cocoeh", "cocoh" }));
+}
+
+
+//-------------------------------------------------
+//  textFields
+//-------------------------------------------------
+
+void Test::textFields()
+{
+	QVERIFY(filter("manufacturer:petaco") == QStringList({ "cocoloco", "cocolocob" }));
+	QVERIFY(filter("manufacturer:\"recel s.a.\"") == QStringList({ "cocolocoa" }));
+	QVERIFY(filter("-manufacturer:tandy cocoloco") == QStringList({ "cocoloco", "cocolocoa", "cocolocob" }));
+
+	// results are remembered per string, so evaluating each row twice (and rows that share a
+	// manufacturer) has to give the same answers as matching the text every time
+	Preferences prefs;
+	IconLoader iconLoader(prefs);
+	MachineListItemModel model(nullptr, m_infoDb, iconLoader);
+	SearchQuery query("manufacturer:s.a.");
+	QVERIFY(query.terms().size() == 1);
+	std::function<bool(int row)> predicate = model.compileFilterTerm(query.terms()[0]);
+	QVERIFY(predicate);
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (int row = 0; row < (int)m_infoDb.machines().size(); row++)
+		{
+			bool expected = m_infoDb.machines()[row].manufacturer().contains("s.a.", Qt::CaseInsensitive);
+			QVERIFY(predicate(row) == expected);
+		}
+	}
+
+	// fields that the model does not know about are left to the proxy
+	QVERIFY(!model.compileFilterTerm(SearchQuery("xyzzy:coco").terms()[0]));
+	QVERIFY(!model.compileFilterTerm(SearchQuery("coco").terms()[0]));
+}
+
+
+//-------------------------------------------------
+//  software
+//-------------------------------------------------
+
+void Test::software()
+{
+	// until the index is built, nothing matches
+	QVERIFY(filter("software:amazing").isEmpty());
+
+	// the sample software list is the CoCo's cartridges
+	QTemporaryDir hashDir;
+	QVERIFY(hashDir.isValid());
+	QVERIFY(QFile::copy(":/resources/softlist.xml", hashDir.filePath("coco_cart.xml")));
+	auto softwareIndex = std::make_shared<const software_index>(software_index::build({ hashDir.path() }, QString()));
+
+	QVERIFY(filter("software:amazing -is:clone", software_index::ptr(softwareIndex)) == QStringList({ "coco" }));
+
+	// the index usually arrives after the filter was compiled, which then has to be done again
+	Preferences prefs;
+	IconLoader iconLoader(prefs);
+	MachineListItemModel model(nullptr, m_infoDb, iconLoader);
+	SortFilterProxyModel proxy(nullptr);
+	proxy.setSourceModel(&model);
+	proxy.setFilterText("software:amazing -is:clone");
+	QVERIFY(proxy.rowCount() == 0);
+	model.setSoftwareIndex(std::move(softwareIndex));
+	QVERIFY(proxy.rowCount() == 0);
+	proxy.refilter();
+	QVERIFY(proxy.rowCount() == 1);
+}
+
+
+static TestFixture<Test> fixture;
+#include "machinelistitemmodel_test.moc"
@@ -38,7 +38,7 @@ private:
 void Preferences::Test::general()
 {
 	const char *xml =
-		"<preferences menu_bar_shown=\"1\">"
+		"<preferences menu_bar_shown=\"1\" group_clones=\"1\">"
 		"<path type=\"emu\">C:\\mame64.exe</path>"
 		"<path type=\"roms\">C:\\roms</path>"
 		"<path type=\"samples\">C:\\samples</path>"
@@ -46,6 +46,7 @@ void Preferences::Test::general()
 		"<path type=\"nvram\">C:\\nvram</path>"
 
 		"<size width=\"1230\" height=\"765\"/>"
+		"<softwarelistcache size=\"128\"/>"
 		"<selectedmachine>nes</selectedmachine>"
 		"<column id=\"name\" width=\"84\" order=\"0\" />"
 		"<column id=\"description\" width=\"165\" order=\"1\" />"
@@ -65,6 +66,8 @@ void Preferences::Test::general()
 	QVERIFY(prefs.GetGlobalPath(Preferences::global_path_type::SAMPLES) == "C:\\samples\\");
 	QVERIFY(prefs.GetGlobalPath(Preferences::global_path_type::CONFIG) == "C:\\cfg\\");
 	QVERIFY(prefs.GetGlobalPath(Preferences::global_path_type::NVRAM) == "C:\\nvram\\");
+	QVERIFY(prefs.GetSoftwareListCacheSize() == 128);
+	QVERIFY(prefs.GetGroupClones());
 
 	QVERIFY(prefs.GetMachinePath("echo", Preferences::machine_path_type::WORKING_DIRECTORY) == "C:\\MyEchoGames\\");
 	QVERIFY(prefs.GetMachinePath("echo", Preferences::machine_path_type::LAST_SAVE_STATE) == "C:\\MyLastState.sta");
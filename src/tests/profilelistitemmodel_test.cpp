@@ -0,0 +1,79 @@
+/***************************************************************************
+
+    profilelistitemmodel_test.cpp
+
+    Unit tests for profilelistitemmodel.cpp
+
+***************************************************************************/
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "iconloader.h"
+#include "prefs.h"
+#include "profilelistitemmodel.h"
+#include "test.h"
+
+namespace
+{
+    class Test : public QObject
+    {
+        Q_OBJECT
+
+    private slots:
+		void findRowByKey();
+
+	private:
+		static void writeProfile(const QTemporaryDir &dir, const QString &name);
+	};
+}
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  writeProfile
+//-------------------------------------------------
+
+void Test::writeProfile(const QTemporaryDir &dir, const QString &name)
+{
+	QFile file(dir.filePath(name + ".bletchmameprofile"));
+	QVERIFY(file.open(QIODevice::WriteOnly));
+	file.write("<profile machine=\"coco\"/>");
+}
+
+
+//-------------------------------------------------
+//  findRowByKey
+//-------------------------------------------------
+
+void Test::findRowByKey()
+{
+	QTemporaryDir profilesDir;
+	QVERIFY(profilesDir.isValid());
+	writeProfile(profilesDir, "alpha");
+	writeProfile(profilesDir, "bravo");
+
+	Preferences prefs;
+	prefs.SetGlobalPath(Preferences::global_path_type::PROFILES, profilesDir.path());
+	info::database infoDb;
+	IconLoader iconLoader(prefs);
+	ProfileListItemModel model(nullptr, prefs, infoDb, iconLoader);
+	model.refresh(true, false);
+	QVERIFY(model.rowCount(QModelIndex()) == 2);
+
+	// keys are the paths as they are shown, which is with native separators
+	for (int row = 0; row < 2; row++)
+	{
+		QString key = QDir::toNativeSeparators(model.getProfileByIndex(row).path());
+		QVERIFY(model.findRowByKey(key) == row);
+	}
+	QVERIFY(model.findRowByKey(QDir::toNativeSeparators(profilesDir.filePath("charlie.bletchmameprofile"))) == -1);
+}
+
+
+static TestFixture<Test> fixture;
+#include "profilelistitemmodel_test.moc"
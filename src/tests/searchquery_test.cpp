@@ -0,0 +1,137 @@
+/***************************************************************************
+
+    searchquery_test.cpp
+
+    Unit tests for searchquery.cpp
+
+***************************************************************************/
+
+#include "searchquery.h"
+#include "test.h"
+
+namespace
+{
+    class Test : public QObject
+    {
+        Q_OBJECT
+
+    private slots:
+		void parse();
+		void parseQuoted();
+		void parseRange();
+		void matchesRange();
+	};
+}
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  parse
+//-------------------------------------------------
+
+void Test::parse()
+{
+	SearchQuery query("Manufacturer:Capcom  pac-man -clone - http://x");
+	const std::vector<SearchQuery::Term> &terms = query.terms();
+	QVERIFY(terms.size() == 5);
+
+	QVERIFY(terms[0].m_field == "manufacturer");
+	QVERIFY(terms[0].m_text == "capcom");
+	QVERIFY(terms[0].m_token == "manufacturer:capcom");
+	QVERIFY(!terms[0].m_negated);
+	QVERIFY(!terms[0].m_isRange);
+
+	// a leading '-' negates a term, but one in the middle of a word is just text...
+	QVERIFY(terms[1].m_field.isEmpty());
+	QVERIFY(terms[1].m_text == "pac-man");
+	QVERIFY(!terms[1].m_negated);
+	QVERIFY(terms[2].m_text == "clone");
+	QVERIFY(terms[2].m_token == "clone");
+	QVERIFY(terms[2].m_negated);
+
+	// ...as is one on its own...
+	QVERIFY(terms[3].m_text == "-");
+	QVERIFY(!terms[3].m_negated);
+
+	// ...and anything that looks like a field is one; whoever evaluates the query decides what
+	// to do with fields that it does not know about
+	QVERIFY(terms[4].m_field == "http");
+	QVERIFY(terms[4].m_text == "//x");
+
+	QVERIFY(SearchQuery("   ").isEmpty());
+	QVERIFY(SearchQuery("year:").terms()[0].m_field.isEmpty());
+}
+
+
+//-------------------------------------------------
+//  parseQuoted
+//-------------------------------------------------
+
+void Test::parseQuoted()
+{
+	SearchQuery query("-description:\"Pac-Man (Midway)\" \"ms. pac\" \"\" \"unterminated");
+	const std::vector<SearchQuery::Term> &terms = query.terms();
+	QVERIFY(terms.size() == 3);
+	QVERIFY(terms[0].m_field == "description");
+	QVERIFY(terms[0].m_text == "pac-man (midway)");
+	QVERIFY(terms[0].m_negated);
+	QVERIFY(terms[1].m_field.isEmpty());
+	QVERIFY(terms[1].m_text == "ms. pac");
+	QVERIFY(terms[2].m_text == "unterminated");
+}
+
+
+//-------------------------------------------------
+//  parseRange
+//-------------------------------------------------
+
+void Test::parseRange()
+{
+	SearchQuery query("year:1990..1995 year:..1985 year:2000.. 1990..1995 year:.. year:abc..def");
+	const std::vector<SearchQuery::Term> &terms = query.terms();
+	QVERIFY(terms.size() == 6);
+	QVERIFY(terms[0].m_isRange && terms[0].m_rangeMin == 1990 && terms[0].m_rangeMax == 1995);
+	QVERIFY(terms[1].m_isRange && terms[1].m_rangeMax == 1985);
+	QVERIFY(terms[2].m_isRange && terms[2].m_rangeMin == 2000);
+
+	// ranges need a field, and at least one end that is a number
+	QVERIFY(!terms[3].m_isRange);
+	QVERIFY(!terms[4].m_isRange);
+	QVERIFY(!terms[5].m_isRange);
+}
+
+
+//-------------------------------------------------
+//  matchesRange
+//-------------------------------------------------
+
+void Test::matchesRange()
+{
+	SearchQuery::Term term = SearchQuery("year:1990..1995").terms()[0];
+	QVERIFY(term.matches("1990"));
+	QVERIFY(term.matches("1995"));
+	QVERIFY(!term.matches("1989"));
+	QVERIFY(!term.matches("1996"));
+
+	// unknown digits match if they could be in range
+	QVERIFY(term.matches("199?"));
+	QVERIFY(term.matches("19??"));
+	QVERIFY(!term.matches("198?"));
+	QVERIFY(term.matches("????"));
+	QVERIFY(term.matches("1993?"));
+	QVERIFY(!term.matches("1989?"));
+	QVERIFY(!term.matches(""));
+	QVERIFY(!term.matches("unknown"));
+
+	// and anything that is not a range is text
+	term = SearchQuery("year:199").terms()[0];
+	QVERIFY(term.matches("1991"));
+	QVERIFY(!term.matches("2001"));
+}
+
+
+static TestFixture<Test> fixture;
+#include "searchquery_test.moc"
@@ -0,0 +1,100 @@
+/***************************************************************************
+
+    softwareavailability_test.cpp
+
+    Unit tests for softwareavailability.cpp
+
+***************************************************************************/
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "softwareavailability.h"
+#include "test.h"
+
+namespace
+{
+	class Test : public QObject
+	{
+		Q_OBJECT
+
+	private slots:
+		void general();
+		void multiplePaths();
+
+	private:
+		static void touch(const QString &path);
+	};
+};
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  touch
+//-------------------------------------------------
+
+void Test::touch(const QString &path)
+{
+	QFile file(path);
+	QVERIFY(file.open(QIODevice::WriteOnly));
+}
+
+
+//-------------------------------------------------
+//  general
+//-------------------------------------------------
+
+void Test::general()
+{
+	QTemporaryDir rom_dir;
+	QVERIFY(rom_dir.isValid());
+	QVERIFY(QDir(rom_dir.path()).mkpath("coco_cart/androne"));
+	touch(rom_dir.filePath("coco_cart/amazing.zip"));
+	touch(rom_dir.filePath("coco_cart/applianc.7Z"));
+	touch(rom_dir.filePath("coco_cart/readme.txt"));
+
+	software_availability availability;
+	software_availability::set_ptr available = availability.get({ rom_dir.path() }, "coco_cart");
+	QVERIFY(available);
+	QVERIFY(available->size() == 3);
+	QVERIFY(available->count("amazing") == 1);
+	QVERIFY(available->count("applianc") == 1);
+	QVERIFY(available->count("androne") == 1);
+
+	// unchanged directories are not scanned again
+	QVERIFY(availability.get({ rom_dir.path() }, "coco_cart") == available);
+
+	// and lists without a directory have nothing
+	software_availability::set_ptr missing = availability.get({ rom_dir.path() }, "megadriv");
+	QVERIFY(!missing || missing->empty());
+}
+
+
+//-------------------------------------------------
+//  multiplePaths
+//-------------------------------------------------
+
+void Test::multiplePaths()
+{
+	QTemporaryDir rom_dir1, rom_dir2;
+	QVERIFY(rom_dir1.isValid() && rom_dir2.isValid());
+	QVERIFY(QDir(rom_dir1.path()).mkpath("coco_cart"));
+	QVERIFY(QDir(rom_dir2.path()).mkpath("coco_cart"));
+	touch(rom_dir1.filePath("coco_cart/amazing.zip"));
+	touch(rom_dir2.filePath("coco_cart/androne.zip"));
+
+	software_availability availability;
+	software_availability::set_ptr available = availability.get({ rom_dir1.path(), rom_dir2.path() }, "coco_cart");
+	QVERIFY(available);
+	QVERIFY(available->size() == 2);
+	QVERIFY(available->count("amazing") == 1);
+	QVERIFY(available->count("androne") == 1);
+}
+
+
+static TestFixture<Test> fixture;
+#include "softwareavailability_test.moc"
@@ -0,0 +1,155 @@
+/***************************************************************************
+
+    softwareindex_test.cpp
+
+    Unit tests for softwareindex.cpp
+
+***************************************************************************/
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "softwareindex.h"
+#include "test.h"
+
+class software_index::test : public QObject
+{
+    Q_OBJECT
+
+private slots:
+	void search();
+	void manifest();
+	void buildAsync();
+
+private:
+	static void writeHashFile(const QTemporaryDir &dir, const QString &name);
+};
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  writeHashFile
+//-------------------------------------------------
+
+void software_index::test::writeHashFile(const QTemporaryDir &dir, const QString &name)
+{
+	QFile testAsset(":/resources/softlist.xml");
+	QVERIFY(testAsset.open(QFile::ReadOnly));
+	QByteArray xml = testAsset.readAll();
+
+	QFile file(dir.filePath(name + ".xml"));
+	QVERIFY(file.open(QIODevice::WriteOnly));
+	file.write(xml.replace("name=\"coco_cart\"", ("name=\"" + name + "\"").toUtf8()));
+}
+
+
+//-------------------------------------------------
+//  search
+//-------------------------------------------------
+
+void software_index::test::search()
+{
+	QTemporaryDir hash_dir;
+	QVERIFY(hash_dir.isValid());
+	writeHashFile(hash_dir, "alpha");
+	writeHashFile(hash_dir, "bravo");
+
+	software_index index = software_index::build({ hash_dir.path() }, QString());
+	QVERIFY(index.entries().size() > 0);
+	QVERIFY(index.entries().front().m_list_name == "alpha");
+	QVERIFY(index.entries().back().m_list_name == "bravo");
+
+	// prefix search on the name
+	std::vector<const entry *> results = index.search("amaz");
+	QVERIFY(results.size() == 4);
+	QVERIFY(results[0]->m_list_name == "alpha" && results[0]->m_name == "amazing");
+	QVERIFY(results[1]->m_list_name == "alpha" && results[1]->m_name == "amazing1");
+	QVERIFY(results[2]->m_list_name == "bravo" && results[2]->m_name == "amazing");
+	QVERIFY(results[3]->m_list_name == "bravo" && results[3]->m_name == "amazing1");
+
+	// every word has to match something, in any field and any case
+	QVERIFY(index.search("MAZING world").size() == 4);
+	QVERIFY(index.search("mazing 1987 tandy").size() == 4);
+	QVERIFY(index.search("mazing alt").size() == 2);
+	QVERIFY(index.search("mazing 1983").empty());
+	QVERIFY(index.search("xyzzy").empty());
+	QVERIFY(index.search("").empty());
+
+	// and the results can be limited
+	QVERIFY(index.search("tandy", 3).size() == 3);
+}
+
+
+//-------------------------------------------------
+//  manifest
+//-------------------------------------------------
+
+void software_index::test::manifest()
+{
+	QTemporaryDir hash_dir;
+	QTemporaryDir cache_dir;
+	QVERIFY(hash_dir.isValid() && cache_dir.isValid());
+	writeHashFile(hash_dir, "alpha");
+	writeHashFile(hash_dir, "bravo");
+
+	// the first build persists the index
+	software_index first = software_index::build({ hash_dir.path() }, cache_dir.path());
+	QVERIFY(first.m_sources.size() == 2);
+	QVERIFY(QFile::exists(cache_dir.filePath("software.swlindex")));
+
+	// a second build comes from the manifest
+	software_index second;
+	QVERIFY(second.load_manifest(cache_dir.filePath("software.swlindex")));
+	QVERIFY(second.m_entries.size() == first.m_entries.size());
+	second = software_index::build({ hash_dir.path() }, cache_dir.path());
+	QVERIFY(second.m_entries.size() == first.m_entries.size());
+	QVERIFY(second.search("amaz").size() == 4);
+
+	// removed lists drop out
+	QVERIFY(QFile::remove(hash_dir.filePath("bravo.xml")));
+	software_index third = software_index::build({ hash_dir.path() }, cache_dir.path());
+	QVERIFY(third.m_sources.size() == 1);
+	QVERIFY(third.search("amaz").size() == 2);
+
+	// and a cancelled build gives us nothing
+	software_index cancelled = software_index::build({ hash_dir.path() }, QString(), []() { return true; });
+	QVERIFY(cancelled.entries().empty());
+}
+
+
+//-------------------------------------------------
+//  buildAsync
+//-------------------------------------------------
+
+void software_index::test::buildAsync()
+{
+	QTemporaryDir hash_dir;
+	QVERIFY(hash_dir.isValid());
+	writeHashFile(hash_dir, "alpha");
+
+	// the result is handed to the callback as well as the future
+	software_index::ptr built;
+	std::future<ptr> future = software_index::build_async({ hash_dir.path() }, QString(), { }, [&built](const ptr &index)
+	{
+		built = index;
+	});
+	software_index::ptr result = future.get();
+	QVERIFY(result && result == built);
+	QVERIFY(result->search("amaz").size() == 2);
+
+	// but cancelled builds do not call back
+	bool called = false;
+	future = software_index::build_async({ hash_dir.path() }, QString(), []() { return true; }, [&called](const ptr &)
+	{
+		called = true;
+	});
+	QVERIFY(!future.get());
+	QVERIFY(!called);
+}
+
+
+static TestFixture<software_index::test> fixture;
+#include "softwareindex_test.moc"
@@ -7,9 +7,15 @@
 ***************************************************************************/
 
 #include <QDataStream>
+#include <QTemporaryDir>
+
+#include <mutex>
+#include <type_traits>
 
 #include "softwarelist.h"
 #include "test.h"
+#include "quazip/quazip.h"
+#include "quazip/quazipfile.h"
 
 class software_list::test : public QObject
 {
@@ -17,6 +23,12 @@ class software_list::test : public QObject
 
 private slots:
 	void general();
+	void cache();
+	void collection();
+	void cancellation();
+	void shared_cache();
+	void find_software();
+	void archive();
 };
 
 
@@ -46,12 +58,307 @@ void software_list::test::general()
 
 	for (const software_list::software &sw : softlist.get_software())
 	{
-		for (const software_list::part &part : sw.m_parts)
+		for (const software_list::part &part : sw.parts())
 		{
-			if (part.m_interface.isEmpty() || part.m_name.isEmpty())
+			if (part.interface_name().isEmpty() || part.name().isEmpty())
 				throw false;
 		}
 	}
+
+	// repeated strings are interned, and moving the list must not invalidate anything
+	static_assert(!std::is_copy_constructible<software_list>::value, "software lists cannot be copied");
+	software_list moved(std::move(softlist));
+	std::optional<software_list::software> amazing = moved.find_software("amazing");
+	std::optional<software_list::software> amazing1 = moved.find_software("amazing1");
+	QVERIFY(amazing && amazing1);
+	QVERIFY(amazing->year() == "1987");
+	QVERIFY(&amazing->year() == &amazing1->year());
+	QVERIFY(&amazing->publisher() == &amazing1->publisher());
+	QVERIFY(&amazing->parts()[0].interface_name() == &amazing1->parts()[0].interface_name());
+
+	// the parts of each software follow one another in a single table
+	size_t part_index = 0;
+	for (const software_list::software &sw : moved.get_software())
+	{
+		for (const software_list::part &part : sw.parts())
+		{
+			QVERIFY(part_index < moved.parts().size());
+			QVERIFY(&part.name() == &moved.parts()[part_index].name());
+			QVERIFY(&part.interface_name() == &moved.parts()[part_index].interface_name());
+			part_index++;
+		}
+	}
+	QVERIFY(part_index == moved.parts().size());
+}
+
+
+//-------------------------------------------------
+//  cache
+//-------------------------------------------------
+
+void software_list::test::cache()
+{
+	// set up a hash directory with our test asset, and a cache directory
+	QTemporaryDir hash_dir;
+	QTemporaryDir cache_dir;
+	QVERIFY(hash_dir.isValid() && cache_dir.isValid());
+	QString xml_path = hash_dir.filePath("coco_cart.xml");
+	QVERIFY(QFile::copy(":/resources/softlist.xml", xml_path));
+
+	// the first load parses the XML and compiles it
+	std::optional<software_list> parsed = software_list::try_load({ hash_dir.path() }, "coco_cart", cache_dir.path());
+	QVERIFY(parsed.has_value());
+	QString cache_path = cache_dir.filePath("coco_cart.swlcache");
+	QVERIFY(QFileInfo(cache_path).isFile());
+
+	// the compiled copy must be an exact match
+	software_list cached;
+	QVERIFY(cached.load_cache(cache_path, QFileInfo(xml_path)));
+	QVERIFY(cached.m_name == parsed->m_name);
+	QVERIFY(cached.m_description == parsed->m_description);
+	QVERIFY(cached.get_software().size() == parsed->get_software().size());
+	for (size_t i = 0; i < cached.get_software().size(); i++)
+	{
+		software x = cached.get_software()[i];
+		software y = parsed->get_software()[i];
+		QVERIFY(x.name() == y.name());
+		QVERIFY(x.description() == y.description());
+		QVERIFY(x.year() == y.year());
+		QVERIFY(x.publisher() == y.publisher());
+		QVERIFY(x.parts().size() == y.parts().size());
+		for (size_t j = 0; j < x.parts().size(); j++)
+		{
+			QVERIFY(x.parts()[j].name() == y.parts()[j].name());
+			QVERIFY(x.parts()[j].interface_name() == y.parts()[j].interface_name());
+		}
+	}
+
+	// the compiled copy is used where it is mapped, which has to survive moving the list
+	software_list moved(std::move(cached));
+	QVERIFY(moved.get_software().size() == parsed->get_software().size());
+	QVERIFY(moved.find_software("amazing").has_value());
+
+	// changing the XML invalidates the compiled copy
+	QFile xml_file(xml_path);
+	QVERIFY(xml_file.setPermissions(xml_file.permissions() | QFileDevice::WriteOwner));
+	QVERIFY(xml_file.open(QIODevice::Append));
+	xml_file.write("\n");
+	xml_file.close();
+	software_list stale;
+	QVERIFY(!stale.load_cache(cache_path, QFileInfo(xml_path)));
+}
+
+
+//-------------------------------------------------
+//  collection
+//-------------------------------------------------
+
+void software_list::test::collection()
+{
+	// set up a hash directory with a few differently named copies of our test asset
+	QTemporaryDir hash_dir;
+	QVERIFY(hash_dir.isValid());
+	QFile testAsset(":/resources/softlist.xml");
+	QVERIFY(testAsset.open(QFile::ReadOnly));
+	QByteArray xml = testAsset.readAll();
+	const std::vector<QString> names = { "alpha", "bravo", "charlie", "delta", "echo" };
+	for (const QString &name : names)
+	{
+		QFile file(hash_dir.filePath(name + ".xml"));
+		QVERIFY(file.open(QIODevice::WriteOnly));
+		file.write(QByteArray(xml).replace("name=\"coco_cart\"", ("name=\"" + name + "\"").toUtf8()));
+	}
+
+	// load them in a different order, with a missing list in the middle
+	software_list_collection collection;
+	std::mutex mutex;
+	std::vector<QString> loaded;
+	collection.set_on_list_loaded([&](const QString &softlist_name, bool success, std::chrono::nanoseconds)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (success)
+			loaded.push_back(softlist_name);
+	});
+	collection.load({ hash_dir.path() }, QString(), { "echo", "charlie", "missing", "alpha", "delta", "bravo" });
+
+	// the lists must come back in the declared order
+	const std::vector<QString> expected = { "echo", "charlie", "alpha", "delta", "bravo" };
+	QVERIFY(collection.software_lists().size() == expected.size());
+	for (size_t i = 0; i < expected.size(); i++)
+		QVERIFY(collection.software_lists()[i]->name() == expected[i]);
+	QVERIFY(loaded.size() == expected.size());
+}
+
+
+//-------------------------------------------------
+//  cancellation
+//-------------------------------------------------
+
+void software_list::test::cancellation()
+{
+	QTemporaryDir hash_dir;
+	QVERIFY(hash_dir.isValid());
+	QVERIFY(QFile::copy(":/resources/softlist.xml", hash_dir.filePath("coco_cart.xml")));
+
+	// a load that is cancelled before it starts loads nothing
+	software_list_collection collection;
+	collection.load({ hash_dir.path() }, QString(), { "coco_cart", "coco_cart" }, []() { return true; });
+	QVERIFY(collection.software_lists().empty());
+
+	// one that is never cancelled loads everything
+	collection.load({ hash_dir.path() }, QString(), { "coco_cart", "coco_cart" }, []() { return false; });
+	QVERIFY(collection.software_lists().size() == 2);
+}
+
+
+//-------------------------------------------------
+//  shared_cache
+//-------------------------------------------------
+
+void software_list::test::shared_cache()
+{
+	QTemporaryDir hash_dir;
+	QVERIFY(hash_dir.isValid());
+	QFile testAsset(":/resources/softlist.xml");
+	QVERIFY(testAsset.open(QFile::ReadOnly));
+	QByteArray xml = testAsset.readAll();
+	for (const char *name : { "alpha", "bravo" })
+	{
+		QFile file(hash_dir.filePath(QString(name) + ".xml"));
+		QVERIFY(file.open(QIODevice::WriteOnly));
+		file.write(xml);
+	}
+
+	// repeated requests share the same list
+	software_list_cache cache;
+	software_list::ptr alpha = cache.get({ hash_dir.path() }, "alpha");
+	QVERIFY(alpha);
+	QVERIFY(cache.get({ hash_dir.path() }, "alpha") == alpha);
+	QVERIFY(!cache.get({ hash_dir.path() }, "missing"));
+	QVERIFY(cache.resident_count() == 1);
+	QVERIFY(cache.resident_size() == alpha->estimated_size());
+
+	// a budget too small for both lists evicts the least recently used one, but lists
+	// that are still referenced stay valid
+	cache.set_budget(alpha->estimated_size());
+	software_list::ptr bravo = cache.get({ hash_dir.path() }, "bravo");
+	QVERIFY(bravo && bravo != alpha);
+	QVERIFY(cache.resident_count() == 1);
+	QVERIFY(!alpha->get_software().empty());
+	software_list::ptr alpha2 = cache.get({ hash_dir.path() }, "alpha");
+	QVERIFY(alpha2 && alpha2 != alpha);
+
+	// changing the hash file invalidates the resident copy
+	cache.set_budget(software_list_cache::DEFAULT_BUDGET);
+	QVERIFY(cache.get({ hash_dir.path() }, "bravo") == cache.get({ hash_dir.path() }, "bravo"));
+	software_list::ptr bravo2 = cache.get({ hash_dir.path() }, "bravo");
+	{
+		QFile file(hash_dir.filePath("bravo.xml"));
+		QVERIFY(file.open(QIODevice::Append));
+		file.write("\n");
+	}
+	QVERIFY(cache.get({ hash_dir.path() }, "bravo") != bravo2);
+
+	// a hash file that cannot be loaded falls back to the next hash path, like try_load()
+	QTemporaryDir broken_dir;
+	QVERIFY(broken_dir.isValid());
+	{
+		QFile file(broken_dir.filePath("alpha.xml"));
+		QVERIFY(file.open(QIODevice::WriteOnly));
+		file.write("this is not a software list");
+	}
+	software_list::ptr fallback = cache.get({ broken_dir.path(), hash_dir.path() }, "alpha");
+	QVERIFY(fallback && !fallback->get_software().empty());
+	QVERIFY(cache.get({ hash_dir.path() }, "alpha") == fallback);
+}
+
+
+
+//-------------------------------------------------
+//  find_software
+//-------------------------------------------------
+
+void software_list::test::find_software()
+{
+	QTemporaryDir hash_dir;
+	QVERIFY(hash_dir.isValid());
+	QVERIFY(QFile::copy(":/resources/softlist.xml", hash_dir.filePath("coco_cart.xml")));
+	software_list_collection collection;
+	collection.load({ hash_dir.path() }, QString(), { "coco_cart" });
+	QVERIFY(collection.software_lists().size() == 1);
+	const software_list &softlist = *collection.software_lists()[0];
+
+	// every entry must be found through the index
+	for (const software_list::software &sw : softlist.get_software())
+	{
+		std::optional<software_list::software> found = softlist.find_software(sw.name());
+		QVERIFY(found && &found->name() == &sw.name());
+		found = collection.find_software_by_name(sw.name(), QString());
+		QVERIFY(found && &found->name() == &sw.name());
+		found = collection.find_software_by_name(sw.name(), sw.parts()[0].interface_name());
+		QVERIFY(found && &found->name() == &sw.name());
+	}
+
+	// and misses must miss
+	QVERIFY(!softlist.find_software("doesnotexist"));
+	QVERIFY(!collection.find_software_by_name("alphazoo", "nosuchinterface"));
+	QVERIFY(!collection.find_software_by_name("alpha.zoo", QString()));
+}
+
+
+//-------------------------------------------------
+//  archive
+//-------------------------------------------------
+
+void software_list::test::archive()
+{
+	// build a zipped hash archive with the list in a subdirectory, as in MAME's own distribution
+	QTemporaryDir hash_dir;
+	QTemporaryDir cache_dir;
+	QVERIFY(hash_dir.isValid() && cache_dir.isValid());
+	QFile asset(":/resources/softlist.xml");
+	QVERIFY(asset.open(QIODevice::ReadOnly));
+	QByteArray xml = asset.readAll();
+	QString archive_path = hash_dir.filePath("hash.zip");
+	{
+		QuaZip zip(archive_path);
+		QVERIFY(zip.open(QuaZip::Mode::mdCreate));
+		for (const char *member_name : { "hash/readme.txt", "hash/coco_cart.xml" })
+		{
+			QuaZipFile member(&zip);
+			QVERIFY(member.open(QIODevice::WriteOnly, QuaZipNewInfo(member_name)));
+			QVERIFY(member.write(xml) == xml.size());
+			member.close();
+		}
+		zip.close();
+	}
+	QVERIFY(software_list::find_hash_archive(archive_path).has_value());
+	QVERIFY(software_list::find_hash_archive(hash_dir.filePath("hash")).has_value());
+	QVERIFY(!software_list::find_hash_archive(hash_dir.path()).has_value());
+	QVERIFY(software_list::hash_archive_list_names(QFileInfo(archive_path)) == QStringList({ "coco_cart" }));
+
+	// loading from the archive must match loading the plain file
+	QTemporaryDir plain_dir;
+	QVERIFY(plain_dir.isValid());
+	QVERIFY(QFile::copy(":/resources/softlist.xml", plain_dir.filePath("coco_cart.xml")));
+	std::optional<software_list> plain = software_list::try_load({ plain_dir.path() }, "coco_cart");
+	std::optional<software_list> zipped = software_list::try_load({ archive_path }, "coco_cart", cache_dir.path());
+	QVERIFY(plain.has_value() && zipped.has_value());
+	QVERIFY(zipped->get_software().size() == plain->get_software().size());
+	for (size_t i = 0; i < zipped->get_software().size(); i++)
+		QVERIFY(zipped->get_software()[i].name() == plain->get_software()[i].name());
+
+	// the compiled copy is keyed on the archive
+	software_list cached;
+	QVERIFY(cached.load_cache(cache_dir.filePath("coco_cart.swlcache"), QFileInfo(archive_path)));
+	QVERIFY(cached.get_software().size() == plain->get_software().size());
+
+	// lists not in the archive fall through to later paths
+	QVERIFY(!software_list::try_load({ archive_path }, "readme").has_value());
+	QVERIFY(software_list::try_load({ archive_path, plain_dir.path() }, "coco_cart").has_value());
+
+	// and the archive can be referred to the same way MAME would
+	QVERIFY(software_list::try_load({ hash_dir.filePath("hash") }, "coco_cart").has_value());
 }
 
 
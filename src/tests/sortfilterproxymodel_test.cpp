@@ -0,0 +1,422 @@
+/***************************************************************************
+
+    sortfilterproxymodel_test.cpp
+
+    Unit tests for sortfilterproxymodel.cpp
+
+***************************************************************************/
+
+#include <QStandardItemModel>
+
+#include <algorithm>
+#include <random>
+
+#include "sortfilterproxymodel.h"
+#include "test.h"
+
+namespace
+{
+	// a source model with parent rows, like the machine list in tree mode
+	class TreeSourceModel : public QStandardItemModel, public SortFilterProxyModel::ITextSource
+	{
+	public:
+		void addRow(const char *name, int parentRow)
+		{
+			m_parentRows.push_back(parentRow);
+			appendRow(new QStandardItem(name));
+		}
+
+		virtual QString cellText(int row, int column) const override	{ return item(row, column)->text(); }
+		virtual int parentRow(int row) const override					{ return m_parentRows[row]; }
+
+	private:
+		std::vector<int>	m_parentRows;
+	};
+
+    class Test : public QObject
+    {
+        Q_OBJECT
+
+    private slots:
+		void filter();
+		void filterBenchmark();
+		void fielded();
+		void narrowing();
+		void sort();
+		void sortLarge();
+		void sourceReset();
+		void tree();
+
+	private:
+		static void addRow(QStandardItemModel &model, const char *name, const char *description);
+		static QStringList column(const QAbstractItemModel &model, int column, const QModelIndex &parent = QModelIndex());
+	};
+}
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  addRow
+//-------------------------------------------------
+
+void Test::addRow(QStandardItemModel &model, const char *name, const char *description)
+{
+	model.appendRow({ new QStandardItem(name), new QStandardItem(description) });
+}
+
+
+//-------------------------------------------------
+//  column
+//-------------------------------------------------
+
+QStringList Test::column(const QAbstractItemModel &model, int column, const QModelIndex &parent)
+{
+	QStringList result;
+	for (int row = 0; row < model.rowCount(parent); row++)
+		result << model.data(model.index(row, column, parent)).toString();
+	return result;
+}
+
+
+//-------------------------------------------------
+//  filter
+//-------------------------------------------------
+
+void Test::filter()
+{
+	QStandardItemModel model;
+	addRow(model, "pacman", "Pac-Man (Midway)");
+	addRow(model, "galaga", "Galaga (Namco rev. B)");
+	addRow(model, "mspacman", "Ms. Pac-Man");
+	SortFilterProxyModel proxy(nullptr);
+	proxy.setSourceModel(&model);
+	QVERIFY(proxy.rowCount() == 3);
+
+	// matches are case insensitive and against any column
+	proxy.setFilterText("PAC");
+	QVERIFY(column(proxy, 0) == QStringList({ "pacman", "mspacman" }));
+	proxy.setFilterText("namco");
+	QVERIFY(column(proxy, 0) == QStringList({ "galaga" }));
+
+	proxy.setFilterText("galaga (midway)");
+	QVERIFY(proxy.rowCount() == 0);
+	proxy.setFilterText("galaga");
+	QVERIFY(proxy.rowCount() == 1);
+
+	// mapping goes both ways
+	QModelIndex sourceIndex = proxy.mapToSource(proxy.index(0, 1));
+	QVERIFY(sourceIndex.row() == 1 && sourceIndex.column() == 1);
+	QVERIFY(proxy.mapFromSource(sourceIndex) == proxy.index(0, 1));
+	QVERIFY(!proxy.mapFromSource(model.index(0, 0)).isValid());
+
+	proxy.setFilterText(QString());
+	QVERIFY(proxy.rowCount() == 3);
+}
+
+
+//-------------------------------------------------
+//  filterBenchmark - about as many rows as the
+//	machine list has
+//-------------------------------------------------
+
+void Test::filterBenchmark()
+{
+	QStandardItemModel model;
+	for (int i = 0; i < 40000; i++)
+	{
+		QByteArray name = QString("machine%1").arg(i).toLatin1();
+		QByteArray description = QString("Machine #%1 (%2)").arg(i).arg(i % 2 ? "Namco" : "Midway").toLatin1();
+		addRow(model, name.constData(), description.constData());
+	}
+	SortFilterProxyModel proxy(nullptr);
+	proxy.setSourceModel(&model);
+	proxy.sort(1, Qt::AscendingOrder);
+	QVERIFY(proxy.rowCount() == 40000);
+
+	proxy.setFilterText("namco 1");
+	int expectedRowCount = proxy.rowCount();
+	QVERIFY(expectedRowCount > 0 && expectedRowCount < 20000);
+
+	QBENCHMARK
+	{
+		proxy.setFilterText(QString());
+		proxy.setFilterText("namco 1");
+	}
+	QVERIFY(proxy.rowCount() == expectedRowCount);
+}
+
+
+//-------------------------------------------------
+//  fielded
+//-------------------------------------------------
+
+void Test::fielded()
+{
+	QStandardItemModel model;
+	model.setHorizontalHeaderLabels({ "Name", "Description", "Year" });
+	model.appendRow({ new QStandardItem("pacman"), new QStandardItem("Pac-Man (Midway)"), new QStandardItem("1980") });
+	model.appendRow({ new QStandardItem("galaga"), new QStandardItem("Galaga (Namco rev. B)"), new QStandardItem("1981") });
+	model.appendRow({ new QStandardItem("mspacman"), new QStandardItem("Ms. Pac-Man"), new QStandardItem("1981") });
+	model.appendRow({ new QStandardItem("pacland"), new QStandardItem("Pac-Land (World)"), new QStandardItem("198?") });
+	SortFilterProxyModel proxy(nullptr);
+	proxy.setSourceModel(&model);
+
+	// fields are matched against the column with that header
+	proxy.setFilterText("Name:man");
+	QVERIFY(column(proxy, 0) == QStringList({ "pacman", "mspacman" }));
+	proxy.setFilterText("description:mspacman");
+	QVERIFY(proxy.rowCount() == 0);
+
+	// ranges
+	proxy.setFilterText("year:1981..");
+	QVERIFY(column(proxy, 0) == QStringList({ "galaga", "mspacman", "pacland" }));
+	proxy.setFilterText("year:..1980");
+	QVERIFY(column(proxy, 0) == QStringList({ "pacman", "pacland" }));
+
+	// every term has to match, and negated terms must not
+	proxy.setFilterText("pac -name:ms");
+	QVERIFY(column(proxy, 0) == QStringList({ "pacman", "pacland" }));
+	proxy.setFilterText("pac -\"(midway)\" year:1981..1981");
+	QVERIFY(column(proxy, 0) == QStringList({ "mspacman", "pacland" }));
+
+	// fields that we do not know about are text
+	proxy.setFilterText("land:world");
+	QVERIFY(proxy.rowCount() == 0);
+
+	// typing a query in one character at a time must give the same results as filtering from scratch
+	QString text;
+	for (QChar ch : QString("name:pac -description:midway \"(w"))
+	{
+		text += ch;
+		proxy.setFilterText(text);
+		SortFilterProxyModel scratch(nullptr);
+		scratch.setSourceModel(&model);
+		scratch.setFilterText(text);
+		QVERIFY(column(proxy, 0) == column(scratch, 0));
+	}
+	QVERIFY(column(proxy, 0) == QStringList({ "pacland" }));
+}
+
+
+//-------------------------------------------------
+//  narrowing - typing into the search box one
+//	character at a time must give the same results
+//	as filtering from scratch
+//-------------------------------------------------
+
+void Test::narrowing()
+{
+	QStandardItemModel model;
+	addRow(model, "pacman", "Pac-Man (Midway)");
+	addRow(model, "galaga", "Galaga (Namco rev. B)");
+	addRow(model, "mspacman", "Ms. Pac-Man");
+	addRow(model, "pacland", "Pac-Land (World)");
+	SortFilterProxyModel proxy(nullptr);
+	proxy.setSourceModel(&model);
+	proxy.sort(1, Qt::DescendingOrder);
+
+	auto verifyAgainstScratch = [&model, &proxy]()
+	{
+		SortFilterProxyModel scratch(nullptr);
+		scratch.setSourceModel(&model);
+		scratch.sort(1, Qt::DescendingOrder);
+		scratch.setFilterText(proxy.filterText());
+		QVERIFY(column(proxy, 0) == column(scratch, 0));
+		for (int row = 0; row < model.rowCount(); row++)
+			QVERIFY(proxy.mapFromSource(model.index(row, 0)) == proxy.index(scratch.mapFromSource(model.index(row, 0)).row(), 0));
+	};
+
+	// narrowing down...
+	QString text;
+	for (QChar ch : QString("pac-man"))
+	{
+		text += ch;
+		proxy.setFilterText(text);
+		verifyAgainstScratch();
+	}
+	QVERIFY(column(proxy, 0) == QStringList({ "mspacman", "pacman" }));
+
+	// ...in the middle...
+	proxy.setFilterText("pac-man (");
+	verifyAgainstScratch();
+	proxy.setFilterText("ms. pac-man (");
+	verifyAgainstScratch();
+
+	// ...and back out again
+	while (!text.isEmpty())
+	{
+		text.chop(1);
+		proxy.setFilterText(text);
+		verifyAgainstScratch();
+	}
+	QVERIFY(proxy.rowCount() == 4);
+}
+
+
+//-------------------------------------------------
+//  sort
+//-------------------------------------------------
+
+void Test::sort()
+{
+	QStandardItemModel model;
+	addRow(model, "b", "same");
+	addRow(model, "C", "same");
+	addRow(model, "a", "same");
+	SortFilterProxyModel proxy(nullptr);
+	proxy.setSourceModel(&model);
+
+	// sorting is case insensitive
+	proxy.sort(0, Qt::AscendingOrder);
+	QVERIFY(column(proxy, 0) == QStringList({ "a", "b", "C" }));
+	proxy.sort(0, Qt::DescendingOrder);
+	QVERIFY(column(proxy, 0) == QStringList({ "C", "b", "a" }));
+
+	// ties keep the source order either way
+	proxy.sort(1, Qt::AscendingOrder);
+	QVERIFY(column(proxy, 0) == QStringList({ "b", "C", "a" }));
+	proxy.sort(1, Qt::DescendingOrder);
+	QVERIFY(column(proxy, 0) == QStringList({ "b", "C", "a" }));
+
+	// and filtering keeps the sort
+	proxy.sort(0, Qt::DescendingOrder);
+	proxy.setFilterText("c");
+	QVERIFY(column(proxy, 0) == QStringList({ "C" }));
+	proxy.setFilterText("same");
+	QVERIFY(column(proxy, 0) == QStringList({ "C", "b", "a" }));
+}
+
+
+//-------------------------------------------------
+//  sortLarge - enough rows to be sorted on
+//	several threads
+//-------------------------------------------------
+
+void Test::sortLarge()
+{
+	QStringList names;
+	for (int i = 0; i < 50000; i++)
+		names << QString("row%1").arg(i, 6, 10, QChar('0'));
+	QStringList shuffledNames = names;
+	std::shuffle(shuffledNames.begin(), shuffledNames.end(), std::mt19937(1234));
+
+	QStandardItemModel model;
+	for (const QString &name : shuffledNames)
+		model.appendRow(new QStandardItem(name));
+	SortFilterProxyModel proxy(nullptr);
+	proxy.setSourceModel(&model);
+
+	proxy.sort(0, Qt::AscendingOrder);
+	QVERIFY(column(proxy, 0) == names);
+	proxy.sort(0, Qt::DescendingOrder);
+	std::reverse(names.begin(), names.end());
+	QVERIFY(column(proxy, 0) == names);
+}
+
+
+//-------------------------------------------------
+//  sourceReset
+//-------------------------------------------------
+
+void Test::sourceReset()
+{
+	QStandardItemModel model;
+	addRow(model, "pacman", "Pac-Man");
+	SortFilterProxyModel proxy(nullptr);
+	proxy.setSourceModel(&model);
+	proxy.sort(0, Qt::AscendingOrder);
+	proxy.setFilterText("man");
+
+	// the sort and filter carry over
+	addRow(model, "galaga", "Galaga");
+	addRow(model, "digdug", "Dig Dug");
+	addRow(model, "mspacman", "Ms. Pac-Man");
+	QVERIFY(column(proxy, 0) == QStringList({ "mspacman", "pacman" }));
+
+	// as do changes to the text
+	model.item(1, 0)->setText("galagaman");
+	QVERIFY(column(proxy, 0) == QStringList({ "galagaman", "mspacman", "pacman" }));
+}
+
+
+//-------------------------------------------------
+//  tree
+//-------------------------------------------------
+
+void Test::tree()
+{
+	TreeSourceModel model;
+	model.addRow("puckman", -1);
+	model.addRow("pacman", 0);
+	model.addRow("galaga", -1);
+	model.addRow("galagao", 2);
+	model.addRow("mspacman", -1);
+	model.addRow("pacplus", 0);
+	SortFilterProxyModel proxy(nullptr);
+	proxy.setSourceModel(&model);
+	proxy.sort(0, Qt::AscendingOrder);
+	proxy.setTreeMode(true);
+
+	// children are under their parents, but only once they are fetched
+	QVERIFY(column(proxy, 0) == QStringList({ "galaga", "mspacman", "puckman" }));
+	QModelIndex puckman = proxy.index(2, 0);
+	QVERIFY(proxy.hasChildren(puckman));
+	QVERIFY(!proxy.hasChildren(proxy.index(1, 0)));
+	QVERIFY(proxy.rowCount(puckman) == 0);
+	QVERIFY(proxy.canFetchMore(puckman));
+	QVERIFY(!proxy.mapFromSource(model.index(1, 0)).isValid());
+	proxy.fetchMore(puckman);
+	QVERIFY(!proxy.canFetchMore(puckman));
+	QVERIFY(column(proxy, 0, puckman) == QStringList({ "pacman", "pacplus" }));
+
+	// mapping goes both ways
+	QModelIndex pacplus = proxy.index(1, 0, puckman);
+	QVERIFY(proxy.parent(pacplus) == puckman);
+	QVERIFY(proxy.mapToSource(pacplus).row() == 5);
+	QVERIFY(proxy.mapFromSource(model.index(5, 0)) == pacplus);
+
+	// sorting sorts the children too, and keeps what has been fetched
+	proxy.sort(0, Qt::DescendingOrder);
+	puckman = proxy.index(0, 0);
+	QVERIFY(column(proxy, 0) == QStringList({ "puckman", "mspacman", "galaga" }));
+	QVERIFY(column(proxy, 0, puckman) == QStringList({ "pacplus", "pacman" }));
+
+	// parents are showing if any of their children match, but only the children that match are;
+	// parents that are still showing stay fetched, and persistent indexes follow their rows
+	QPersistentModelIndex persistentPacplus = proxy.index(0, 0, puckman);
+	QPersistentModelIndex persistentPacman = proxy.index(1, 0, puckman);
+	proxy.setFilterText("plus");
+	QVERIFY(column(proxy, 0) == QStringList({ "puckman" }));
+	QVERIFY(column(proxy, 0, proxy.index(0, 0)) == QStringList({ "pacplus" }));
+	QVERIFY(persistentPacplus == proxy.index(0, 0, proxy.index(0, 0)));
+	QVERIFY(!persistentPacman.isValid());
+	QVERIFY(!proxy.revealSource(model.index(1, 0)).isValid());
+
+	// which holds when narrowing down
+	proxy.setFilterText("galaga");
+	QVERIFY(column(proxy, 0) == QStringList({ "galaga" }));
+	proxy.setFilterText("galagao");
+	QVERIFY(column(proxy, 0) == QStringList({ "galaga" }));
+	QVERIFY(proxy.rowCount(proxy.index(0, 0)) == 0);
+	QModelIndex revealed = proxy.revealSource(model.index(3, 0));
+	QVERIFY(revealed.isValid() && revealed.parent() == proxy.index(0, 0));
+	QVERIFY(column(proxy, 0, proxy.index(0, 0)) == QStringList({ "galagao" }));
+
+	// parents that were filtered out have to be fetched again when they come back
+	proxy.setFilterText("pac");
+	QVERIFY(column(proxy, 0) == QStringList({ "puckman", "mspacman" }));
+	QVERIFY(proxy.canFetchMore(proxy.index(0, 0)));
+	proxy.setFilterText("galagao");
+
+	// and back to a flat list
+	proxy.setTreeMode(false);
+	QVERIFY(column(proxy, 0) == QStringList({ "galagao" }));
+	QVERIFY(!proxy.hasChildren(proxy.index(0, 0)));
+}
+
+
+static TestFixture<Test> fixture;
+#include "sortfilterproxymodel_test.moc"
@@ -21,8 +21,13 @@ namespace
 
 		void enum_parser();
 		void return_value_substitutor();
+		void from_utf8();
+		void from_utf8_benchmark_listxml() { from_utf8_benchmark(":/resources/listxml.xml"); }
+		void from_utf8_benchmark_softlist() { from_utf8_benchmark(":/resources/softlist.xml"); }
 
 	private:
+		void from_utf8_benchmark(const char *resourceName);
+
 		template<typename TStr>
 		void string_split()
 		{
@@ -104,5 +109,60 @@ void Test::return_value_substitutor()
 	QVERIFY(func_called);
 }
 
+
+//-------------------------------------------------
+//  from_utf8
+//-------------------------------------------------
+
+void Test::from_utf8()
+{
+	const char *samples[] =
+	{
+		"",
+		"a",
+		"Alpha Bravo Charlie",
+		"0123456789012345678901234567890123456789012345678901234567890123456789",
+		u8"Pok\u00E9mon",
+		u8"\u60AA\u6B7B",
+		u8"0123456789012345678901234567890\u00E9012345678901234567890123456789\u00E9",
+		u8"\u00E9\u00E9\u00E9 0123456789012345678901234567890123456789 \U0001F600 abc"
+	};
+
+	for (const char *sample : samples)
+	{
+		QString expected = QString::fromUtf8(sample);
+		QString actual = util::from_utf8(sample);
+		QVERIFY(actual == expected);
+	}
+}
+
+
+//-------------------------------------------------
+//  from_utf8_benchmark
+//-------------------------------------------------
+
+void Test::from_utf8_benchmark(const char *resourceName)
+{
+	// get the test asset
+	QFile testAsset(resourceName);
+	QVERIFY(testAsset.open(QFile::ReadOnly));
+	QByteArray byteArray = testAsset.readAll();
+
+	// break it into lines, which approximates the lengths of strings we typically see
+	QList<QByteArray> lines = byteArray.split('\n');
+
+	// sanity check against Qt's implementation
+	for (const QByteArray &line : lines)
+		QVERIFY(util::from_utf8(line.constData(), line.size()) == QString::fromUtf8(line));
+
+	// and benchmark
+	QBENCHMARK
+	{
+		for (const QByteArray &line : lines)
+			util::from_utf8(line.constData(), line.size());
+	}
+}
+
+
 static TestFixture<Test> fixture;
 #include "utility_test.moc"
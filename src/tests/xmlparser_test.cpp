@@ -18,6 +18,7 @@ private slots:
 	void unicode();
 	void skipping();
 	void multiple();
+	void schema();
 };
 
 
@@ -180,5 +181,65 @@ void XmlParser::Test::multiple()
 }
 
 
+//-------------------------------------------------
+//  schema
+//-------------------------------------------------
+
+void XmlParser::Test::schema()
+{
+	enum class phonetic
+	{
+		UNKNOWN,
+		ALPHA,
+		BRAVO
+	};
+	static constexpr auto phonetic_parser = util::make_static_enum_parser<phonetic>(
+	{
+		{ "alpha", phonetic::ALPHA },
+		{ "bravo", phonetic::BRAVO }
+	});
+
+	struct record
+	{
+		QString					m_name;
+		int						m_value = 42;
+		std::optional<bool>		m_flag;
+		phonetic				m_phonetic = phonetic::ALPHA;
+	};
+
+	const auto schema = XmlParser::Schema(
+		XmlParser::Bind("name",		&record::m_name),
+		XmlParser::Bind("value",	&record::m_value),
+		XmlParser::Bind("flag",		&record::m_flag),
+		XmlParser::Bind("phonetic",	&record::m_phonetic, phonetic_parser));
+
+	XmlParser xml;
+	std::vector<record> records;
+	xml.OnElementBegin({ "alpha", "record" }, [&](const XmlParser::Attributes &attributes)
+	{
+		schema.Apply(attributes, records.emplace_back());
+	});
+
+	const char *xml_text =
+		"<alpha>"
+		"<record phonetic=\"bravo\" value=\"7\" flag=\"yes\" name=\"first\"/>"
+		"<record name=\"second\" phonetic=\"charlie\"/>"
+		"</alpha>";
+	bool result = xml.ParseBytes(xml_text, strlen(xml_text));
+	QVERIFY(result);
+	QVERIFY(records.size() == 2);
+	QVERIFY(records[0].m_name == "first");
+	QVERIFY(records[0].m_value == 7);
+	QVERIFY(records[0].m_flag == true);
+	QVERIFY(records[0].m_phonetic == phonetic::BRAVO);
+
+	// missing or unparseable attributes reset their fields, like Attributes::Get()
+	QVERIFY(records[1].m_name == "second");
+	QVERIFY(records[1].m_value == 0);
+	QVERIFY(!records[1].m_flag.has_value());
+	QVERIFY(records[1].m_phonetic == phonetic::UNKNOWN);
+}
+
+
 static TestFixture<XmlParser::Test> fixture;
 #include "xmlparser_test.moc"
@@ -8,9 +8,168 @@
 
 #include <sstream>
 #include <QDir>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
 
 #include "utility.h"
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define UTILITY_X86		1
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif // _MSC_VER
+#include <immintrin.h>
+#else
+#define UTILITY_X86		0
+#endif
+
+
+//**************************************************************************
+//  ASCII WIDENING
+//**************************************************************************
+
+// GCC and Clang need to be told that individual functions may use AVX2; MSVC
+// lets us use the intrinsics unconditionally
+#if UTILITY_X86 && (defined(__GNUC__) || defined(__clang__))
+#define TARGET_AVX2		__attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+typedef size_t (*widen_ascii_func)(const char *src, size_t length, char16_t *dest);
+
+
+//-------------------------------------------------
+//  widen_ascii_scalar - copies the ASCII prefix of
+//	'src' into 'dest', returning its length
+//-------------------------------------------------
+
+static size_t widen_ascii_scalar(const char *src, size_t length, char16_t *dest)
+{
+	size_t i;
+	for (i = 0; i < length && (unsigned char)src[i] < 0x80; i++)
+		dest[i] = (char16_t)src[i];
+	return i;
+}
+
+
+#if UTILITY_X86
+
+//-------------------------------------------------
+//  widen_ascii_sse2
+//-------------------------------------------------
+
+static size_t widen_ascii_sse2(const char *src, size_t length, char16_t *dest)
+{
+	const __m128i zero = _mm_setzero_si128();
+	size_t i = 0;
+	for (; i + 16 <= length; i += 16)
+	{
+		__m128i bytes = _mm_loadu_si128((const __m128i *)&src[i]);
+		if (_mm_movemask_epi8(bytes) != 0)
+			break;
+		_mm_storeu_si128((__m128i *)&dest[i + 0], _mm_unpacklo_epi8(bytes, zero));
+		_mm_storeu_si128((__m128i *)&dest[i + 8], _mm_unpackhi_epi8(bytes, zero));
+	}
+	return i + widen_ascii_scalar(&src[i], length - i, &dest[i]);
+}
+
+
+//-------------------------------------------------
+//  widen_ascii_avx2
+//-------------------------------------------------
+
+TARGET_AVX2 static size_t widen_ascii_avx2(const char *src, size_t length, char16_t *dest)
+{
+	size_t i = 0;
+	for (; i + 32 <= length; i += 32)
+	{
+		__m256i bytes = _mm256_loadu_si256((const __m256i *)&src[i]);
+		if (_mm256_movemask_epi8(bytes) != 0)
+			break;
+		_mm256_storeu_si256((__m256i *)&dest[i + 0], _mm256_cvtepu8_epi16(_mm256_castsi256_si128(bytes)));
+		_mm256_storeu_si256((__m256i *)&dest[i + 16], _mm256_cvtepu8_epi16(_mm256_extracti128_si256(bytes, 1)));
+	}
+	return i + widen_ascii_sse2(&src[i], length - i, &dest[i]);
+}
+
+
+//-------------------------------------------------
+//  cpu_has_avx2
+//-------------------------------------------------
+
+static bool cpu_has_avx2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+
+	// AVX2 requires OS support for saving YMM registers
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	if (!osxsave || (_xgetbv(0) & 0x6) != 0x6)
+		return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // UTILITY_X86
+
+
+//-------------------------------------------------
+//  choose_widen_ascii - runtime dispatch based on
+//	CPU features
+//-------------------------------------------------
+
+static widen_ascii_func choose_widen_ascii()
+{
+#if UTILITY_X86
+	return cpu_has_avx2()
+		? widen_ascii_avx2
+		: widen_ascii_sse2;
+#else
+	return widen_ascii_scalar;
+#endif
+}
+
+
+//**************************************************************************
+//  THREADING
+//**************************************************************************
+
+namespace
+{
+	// ======================> pooled_worker
+	// runs a worker on the global thread pool, releasing a semaphore when done
+	class pooled_worker : public QRunnable
+	{
+	public:
+		pooled_worker(const std::function<void()> &worker, QSemaphore &finished)
+			: m_worker(worker)
+			, m_finished(finished)
+		{
+		}
+
+		virtual void run() override
+		{
+			m_worker();
+			m_finished.release();
+		}
+
+	private:
+		const std::function<void()> &	m_worker;
+		QSemaphore &					m_finished;
+	};
+}
+
 
 //**************************************************************************
 //  IMPLEMENTATION
@@ -19,6 +178,72 @@
 const QString util::g_empty_string;
 
 
+//-------------------------------------------------
+//  util::from_utf8
+//-------------------------------------------------
+
+QString util::from_utf8(const char *str, size_t length)
+{
+	static const widen_ascii_func s_widen_ascii = choose_widen_ascii();
+
+	// UTF-16 never needs more code units than UTF-8 needs bytes, so we can transcode
+	// directly into a buffer of 'length' characters and truncate afterwards
+	QString result(safe_static_cast<int>(length), Qt::Uninitialized);
+	char16_t *dest = reinterpret_cast<char16_t *>(result.data());
+	size_t src_pos = 0, dest_pos = 0;
+
+	while (src_pos < length)
+	{
+		// widen the ASCII run (usually the whole string)
+		size_t ascii_length = s_widen_ascii(&str[src_pos], length - src_pos, &dest[dest_pos]);
+		src_pos += ascii_length;
+		dest_pos += ascii_length;
+
+		// any bytes left are the start of a non-ASCII run; find its end (any byte below
+		// 0x80 begins a new character) and hand it to Qt's scalar routine
+		if (src_pos < length)
+		{
+			size_t run_end = src_pos + 1;
+			while (run_end < length && (unsigned char)str[run_end] >= 0x80)
+				run_end++;
+
+			QString run = QString::fromUtf8(&str[src_pos], safe_static_cast<int>(run_end - src_pos));
+			memcpy(&dest[dest_pos], run.utf16(), run.size() * sizeof(dest[0]));
+			src_pos = run_end;
+			dest_pos += run.size();
+		}
+	}
+
+	result.truncate(safe_static_cast<int>(dest_pos));
+	return result;
+}
+
+
+//-------------------------------------------------
+//  util::run_pooled
+//-------------------------------------------------
+
+void util::run_pooled(const std::function<void()> &worker, size_t max_helpers)
+{
+	// helpers are only taken if the pool has threads to spare right now, rather than queued
+	// up; the calling thread participates too, so the work gets done even if none are (and
+	// this is safe to call from the pool's own threads)
+	QThreadPool &pool = *QThreadPool::globalInstance();
+	QSemaphore finished;
+	int helper_count = 0;
+	while ((size_t)helper_count < max_helpers)
+	{
+		std::unique_ptr<pooled_worker> runnable = std::make_unique<pooled_worker>(worker, finished);
+		if (!pool.tryStart(runnable.get()))
+			break;
+		runnable.release();
+		helper_count++;
+	}
+	worker();
+	finished.acquire(helper_count);
+}
+
+
 //-------------------------------------------------
 //  wxFileName::IsPathSeparator
 //-------------------------------------------------
@@ -11,6 +11,7 @@
 #ifndef UTILITY_H
 #define UTILITY_H
 
+#include <array>
 #include <unordered_map>
 #include <optional>
 #include <functional>
@@ -51,6 +52,18 @@ namespace util
 			result = ((result << 5) + result) + s[i];
 		return result;
 	}
+
+	// FNV-1a; usable at compile time
+	constexpr std::uint32_t constexpr_string_hash(const char *s, std::uint32_t seed = 0)
+	{
+		std::uint32_t result = 2166136261u ^ seed;
+		for (std::size_t i = 0; s[i]; i++)
+		{
+			result ^= (std::uint8_t)s[i];
+			result *= 16777619u;
+		}
+		return result;
+	}
 };
 
 
@@ -157,6 +170,91 @@ private:
 };
 
 
+// ======================> static_enum_parser
+// enum parser built at compile time around a perfect hash; the table is searched
+// for a seed such that every string lands in its own slot, so a lookup is one hash
+// and one string compare
+template<typename T, std::size_t N>
+class static_enum_parser
+{
+public:
+	constexpr static_enum_parser(const std::pair<const char *, T>(&values)[N])
+		: m_names()
+		, m_values()
+		, m_slots()
+		, m_seed(0)
+	{
+		for (std::size_t i = 0; i < N; i++)
+		{
+			m_names[i] = values[i].first;
+			m_values[i] = values[i].second;
+		}
+
+		// find a seed without collisions
+		bool collision = true;
+		while (collision)
+		{
+			collision = false;
+			for (std::size_t slot = 0; slot < TABLE_SIZE; slot++)
+				m_slots[slot] = N;
+			for (std::size_t i = 0; !collision && i < N; i++)
+			{
+				std::size_t slot = constexpr_string_hash(m_names[i], m_seed) & (TABLE_SIZE - 1);
+				collision = m_slots[slot] != N;
+				m_slots[slot] = i;
+			}
+			if (collision)
+				m_seed++;
+		}
+	}
+
+	bool operator()(const char *text, T &value) const
+	{
+		std::size_t index = m_slots[constexpr_string_hash(text, m_seed) & (TABLE_SIZE - 1)];
+		bool success = index < N && !strcmp(m_names[index], text);
+		value = success ? m_values[index] : T();
+		return success;
+	}
+
+	bool operator()(const char *text, std::optional<T> &value) const
+	{
+		T inner_value;
+		bool success = (*this)(text, inner_value);
+		value = success ? inner_value : std::optional<T>();
+		return success;
+	}
+
+	template<typename TValue>
+	bool operator()(const std::string &text, TValue &value) const
+	{
+		return (*this)(text.c_str(), value);
+	}
+
+private:
+	static constexpr std::size_t table_size()
+	{
+		std::size_t result = 1;
+		while (result < N * 2)
+			result *= 2;
+		return result;
+	}
+
+	static constexpr std::size_t TABLE_SIZE = table_size();
+
+	std::array<const char *, N>				m_names;
+	std::array<T, N>						m_values;
+	std::array<std::size_t, TABLE_SIZE>		m_slots;
+	std::uint32_t							m_seed;
+};
+
+
+template<typename T, std::size_t N>
+constexpr static_enum_parser<T, N> make_static_enum_parser(const std::pair<const char *, T>(&values)[N])
+{
+	return static_enum_parser<T, N>(values);
+}
+
+
 // ======================> enum_parser_bidirectional
 template<typename T>
 class enum_parser_bidirectional : public enum_parser<T>
@@ -338,6 +436,19 @@ inline std::string to_utf8_string(const QString &str)
 }
 
 
+//-------------------------------------------------
+//  from_utf8 - UTF-8 to QString transcoding with
+//	a vectorized fast path for ASCII runs
+//-------------------------------------------------
+
+QString from_utf8(const char *str, size_t length);
+
+inline QString from_utf8(const char *str)
+{
+	return from_utf8(str, strlen(str));
+}
+
+
 //-------------------------------------------------
 //  safe_static_cast
 //-------------------------------------------------
@@ -351,6 +462,21 @@ template<class T> T safe_static_cast(size_t sz)
 }
 
 
+//**************************************************************************
+//  THREADING
+//**************************************************************************
+
+//-------------------------------------------------
+//  run_pooled - runs a worker on the calling
+//	thread, and on up to max_helpers threads from
+//	the global thread pool if it has them to spare;
+//	the worker pulls its own work, and this returns
+//	when every copy of it has
+//-------------------------------------------------
+
+void run_pooled(const std::function<void()> &worker, size_t max_helpers);
+
+
 //**************************************************************************
 //  COMMAND LINE
 //**************************************************************************
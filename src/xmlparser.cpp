@@ -37,12 +37,17 @@ namespace
 		{
 		}
 
-		bool operator()(const std::string &text, T &value) const
+		bool operator()(const char *text, T &value) const
 		{
-			int rc = sscanf(text.c_str(), m_format, &value);
+			int rc = sscanf(text, m_format, &value);
 			return rc > 0;
 		}
 
+		bool operator()(const std::string &text, T &value) const
+		{
+			return (*this)(text.c_str(), value);
+		}
+
 	private:
 		const char *m_format;
 	};
@@ -58,7 +63,7 @@ static const scanf_parser<int> s_int_parser("%d");
 static const scanf_parser<unsigned int> s_uint_parser("%u");
 static const scanf_parser<float> s_float_parser("%f");
 
-static const util::enum_parser<bool> s_bool_parser =
+static constexpr auto s_bool_parser = util::make_static_enum_parser<bool>(
 {
 	{ "0", false },
 	{ "off", false },
@@ -68,7 +73,7 @@ static const util::enum_parser<bool> s_bool_parser =
 	{ "on", true },
 	{ "true", true },
 	{ "yes", true }
-};
+});
 
 
 //**************************************************************************
@@ -106,11 +111,24 @@ XmlParser::~XmlParser()
 //-------------------------------------------------
 
 bool XmlParser::Parse(QDataStream &input)
+{
+	return Parse({ &input });
+}
+
+
+//-------------------------------------------------
+//  Parse - parses several inputs back to back as
+//	a single document
+//-------------------------------------------------
+
+bool XmlParser::Parse(const std::initializer_list<QDataStream *> &inputs)
 {
 	m_current_node = m_root;
 	m_skipping_depth = 0;
 
-	bool success = internalParse(input);
+	bool success = true;
+	for (auto iter = inputs.begin(); success && iter != inputs.end(); iter++)
+		success = internalParse(**iter, iter + 1 == inputs.end());
 
 	m_current_node = nullptr;
 	m_skipping_depth = 0;
@@ -147,7 +165,7 @@ bool XmlParser::ParseBytes(const void *ptr, size_t sz)
 //  internalParse
 //-------------------------------------------------
 
-bool XmlParser::internalParse(QDataStream &input)
+bool XmlParser::internalParse(QDataStream &input, bool is_final)
 {
 	bool done = false;
 	bool success = true;
@@ -172,6 +190,10 @@ bool XmlParser::internalParse(QDataStream &input)
 		// without returning '0'
 		done = lastRead <= 0;
 
+		// if there is more input to come, expat should not see the end of the document yet
+		if (done && !is_final)
+			break;
+
 		// and feed this into expat
 		if (!XML_Parse(m_parser, buffer, done ? 0 : lastRead, done))
 		{
@@ -199,6 +221,16 @@ QString XmlParser::ErrorMessage() const
 }
 
 
+//-------------------------------------------------
+//  ErrorLineNumber
+//-------------------------------------------------
+
+int XmlParser::ErrorLineNumber() const
+{
+	return (int)XML_GetCurrentLineNumber(m_parser);
+}
+
+
 //-------------------------------------------------
 //  getNode
 //-------------------------------------------------
@@ -315,7 +347,7 @@ void XmlParser::endElement(const char *)
 
 void XmlParser::characterData(const char *s, int len)
 {
-	QString text = QString::fromUtf8(s, len);
+	QString text = util::from_utf8(s, len);
 	m_current_content.append(std::move(text));
 }
 
@@ -353,6 +385,77 @@ std::string XmlParser::Escape(const QString &str)
 }
 
 
+//-------------------------------------------------
+//  ConvertAttribute
+//-------------------------------------------------
+
+bool XmlParser::ConvertAttribute(const char *text, int &value)
+{
+	bool result = s_int_parser(text, value);
+	if (!result)
+		value = 0;
+	return result;
+}
+
+
+//-------------------------------------------------
+//  ConvertAttribute
+//-------------------------------------------------
+
+bool XmlParser::ConvertAttribute(const char *text, std::uint32_t &value)
+{
+	bool result = s_uint_parser(text, value);
+	if (!result)
+		value = 0;
+	return result;
+}
+
+
+//-------------------------------------------------
+//  ConvertAttribute
+//-------------------------------------------------
+
+bool XmlParser::ConvertAttribute(const char *text, bool &value)
+{
+	return s_bool_parser(text, value);
+}
+
+
+//-------------------------------------------------
+//  ConvertAttribute
+//-------------------------------------------------
+
+bool XmlParser::ConvertAttribute(const char *text, float &value)
+{
+	bool result = s_float_parser(text, value);
+	if (!result)
+		value = 0.0f;
+	return result;
+}
+
+
+//-------------------------------------------------
+//  ConvertAttribute
+//-------------------------------------------------
+
+bool XmlParser::ConvertAttribute(const char *text, QString &value)
+{
+	value = util::from_utf8(text);
+	return true;
+}
+
+
+//-------------------------------------------------
+//  ConvertAttribute
+//-------------------------------------------------
+
+bool XmlParser::ConvertAttribute(const char *text, std::string &value)
+{
+	value = text;
+	return true;
+}
+
+
 //**************************************************************************
 //  TRAMPOLINES
 //**************************************************************************
@@ -442,7 +545,7 @@ bool XmlParser::Attributes::Get(const char *attribute, QString &value) const
 {
 	const char *s = InternalGet(attribute, true);
 	if (s)
-		value = QString::fromUtf8(s);
+		value = util::from_utf8(s);
 	else
 		value.clear();
 	return s != nullptr;
@@ -464,6 +567,32 @@ bool XmlParser::Attributes::Get(const char *attribute, std::string &value) const
 }
 
 
+//-------------------------------------------------
+//  Attributes::Lookup
+//-------------------------------------------------
+
+void XmlParser::Attributes::Lookup(const char *const *names, const std::uint32_t *hashes, const char **values, size_t count) const
+{
+	const char **actual_attribute = reinterpret_cast<const char **>(const_cast<Attributes *>(this));
+
+	for (size_t i = 0; i < count; i++)
+		values[i] = nullptr;
+
+	for (size_t i = 0; actual_attribute[i]; i += 2)
+	{
+		std::uint32_t hash = util::constexpr_string_hash(actual_attribute[i + 0]);
+		for (size_t j = 0; j < count; j++)
+		{
+			if (hashes[j] == hash && !strcmp(names[j], actual_attribute[i + 0]))
+			{
+				values[j] = actual_attribute[i + 1];
+				break;
+			}
+		}
+	}
+}
+
+
 //-------------------------------------------------
 //  Attributes::InternalGet
 //-------------------------------------------------
@@ -11,8 +11,10 @@
 #ifndef XMLPARSER_H
 #define XMLPARSER_H
 
+#include <array>
 #include <initializer_list>
 #include <memory>
+#include <tuple>
 #include <type_traits>
 #include <optional>
 
@@ -79,10 +81,87 @@ public:
 				: std::optional<T>();
 		}
 
+		// looks up several attributes in a single pass over the element; names and hashes are
+		// parallel arrays and values receive nullptr for attributes not present
+		void Lookup(const char *const *names, const std::uint32_t *hashes, const char **values, size_t count) const;
+
 	private:
 		const char *InternalGet(const char *attribute, bool return_null = false) const;
 	};
 
+	// ======================> AttributeBinding
+	// binds an attribute name to a field; the converter is called as converter(text, field)
+	// and absent or malformed attributes reset the field, matching Attributes::Get()
+	template<typename TObj, typename TField, typename TConverter>
+	class AttributeBinding
+	{
+	public:
+		typedef TObj object_type;
+
+		AttributeBinding(const char *name, TField TObj::*field, TConverter &&converter)
+			: m_name(name)
+			, m_field(field)
+			, m_converter(std::move(converter))
+		{
+		}
+
+		const char *Name() const { return m_name; }
+
+		void Store(TObj &obj, const char *text) const
+		{
+			TField &field = obj.*m_field;
+			if (!text || !m_converter(text, field))
+				field = TField();
+		}
+
+	private:
+		const char *	m_name;
+		TField TObj::*	m_field;
+		TConverter		m_converter;
+	};
+
+	// ======================> AttributeSchema
+	// the set of attributes read off an element, declared once; applying a schema resolves
+	// every attribute with one pass over the element and stores straight into the fields
+	template<typename TObj, typename... TBindings>
+	class AttributeSchema
+	{
+	public:
+		AttributeSchema(TBindings &&...bindings)
+			: m_names({ bindings.Name()... })
+			, m_hashes({ util::constexpr_string_hash(bindings.Name())... })
+			, m_bindings(std::move(bindings)...)
+		{
+		}
+
+		void Apply(const Attributes &attributes, TObj &obj) const
+		{
+			const char *values[sizeof...(TBindings)];
+			attributes.Lookup(m_names.data(), m_hashes.data(), values, sizeof...(TBindings));
+			store(obj, values, std::index_sequence_for<TBindings...>());
+		}
+
+	private:
+		std::array<const char *, sizeof...(TBindings)>		m_names;
+		std::array<std::uint32_t, sizeof...(TBindings)>		m_hashes;
+		std::tuple<TBindings...>							m_bindings;
+
+		template<std::size_t... Indexes>
+		void store(TObj &obj, const char **values, std::index_sequence<Indexes...>) const
+		{
+			(std::get<Indexes>(m_bindings).Store(obj, values[Indexes]), ...);
+		}
+	};
+
+	struct DefaultConverter
+	{
+		template<typename T>
+		bool operator()(const char *text, T &value) const
+		{
+			return ConvertAttribute(text, value);
+		}
+	};
+
 	// ctor/dtor
 	XmlParser();
 	~XmlParser();
@@ -132,12 +211,52 @@ public:
 	}
 
 	bool Parse(QDataStream &input);
+	bool Parse(const std::initializer_list<QDataStream *> &inputs);
 	bool Parse(const QString &file_name);
 	bool ParseBytes(const void *ptr, size_t sz);
 	QString ErrorMessage() const;
+	int ErrorLineNumber() const;
 
 	static std::string Escape(const QString &str);
 
+	// attribute text conversions, shared by Attributes::Get() and DefaultConverter
+	static bool ConvertAttribute(const char *text, int &value);
+	static bool ConvertAttribute(const char *text, std::uint32_t &value);
+	static bool ConvertAttribute(const char *text, bool &value);
+	static bool ConvertAttribute(const char *text, float &value);
+	static bool ConvertAttribute(const char *text, QString &value);
+	static bool ConvertAttribute(const char *text, std::string &value);
+
+	template<typename T>
+	static bool ConvertAttribute(const char *text, std::optional<T> &value)
+	{
+		T temp_value;
+		bool result = ConvertAttribute(text, temp_value);
+		value = result
+			? std::move(temp_value)
+			: std::optional<T>();
+		return result;
+	}
+
+	// schema construction
+	template<typename TObj, typename TField>
+	static AttributeBinding<TObj, TField, DefaultConverter> Bind(const char *name, TField TObj::*field)
+	{
+		return AttributeBinding<TObj, TField, DefaultConverter>(name, field, DefaultConverter());
+	}
+
+	template<typename TObj, typename TField, typename TConverter>
+	static AttributeBinding<TObj, TField, std::decay_t<TConverter>> Bind(const char *name, TField TObj::*field, TConverter &&converter)
+	{
+		return AttributeBinding<TObj, TField, std::decay_t<TConverter>>(name, field, std::decay_t<TConverter>(std::forward<TConverter>(converter)));
+	}
+
+	template<typename TBinding, typename... TBindings>
+	static AttributeSchema<typename TBinding::object_type, TBinding, TBindings...> Schema(TBinding &&binding, TBindings &&...bindings)
+	{
+		return AttributeSchema<typename TBinding::object_type, TBinding, TBindings...>(std::move(binding), std::move(bindings)...);
+	}
+
 private:
 	struct Node
 	{
@@ -157,7 +276,7 @@ private:
 	int							m_skipping_depth;
 	QString						m_current_content;
 
-	bool internalParse(QDataStream &input);
+	bool internalParse(QDataStream &input, bool is_final);
 	void startElement(const char *name, const char **attributes);
 	void endElement(const char *name);
 	void characterData(const char *s, int len);